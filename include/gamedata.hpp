@@ -27,6 +27,13 @@
 #define MAX_GAMEDATA_ENGINE_SECTION_MESSAGE_LENGTH (MAX_GAMEDATA_SECTION_MESSAGE_LENGTH + MAX_GAMEDATA_ENGINE_ADDRESSES_SECTION_MESSAGE_LENGTH)
 #define MAX_GAMEDATA_MESSAGE_LENGTH (MAX_GAMEDATA_SECTION_MESSAGE_LENGTH + MAX_GAMEDATA_ENGINE_SECTION_MESSAGE_LENGTH + MAX_GAMEDATA_ENGINE_ADDRESSES_SECTION_MESSAGE_LENGTH)
 
+#include <gamedata/byteprofile.hpp>
+#include <gamedata/fingerprint.hpp>
+#include <gamedata/image.hpp>
+#include <gamedata/patcher.hpp>
+#include <gamedata/pattern.hpp>
+#include <gamedata/schemaindex.hpp>
+
 #include <dynlibutils/module.hpp>
 #include <dynlibutils/memaddr.hpp>
 
@@ -34,6 +41,9 @@
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <tier0/platform.h>
 
@@ -57,6 +67,9 @@ class IGameData
 {
 public:
 	virtual const DynLibUtils::CModule *FindLibrary(const char *pszName) const = 0;
+
+	// Roots without live modules (files on disk, other processes) provide the image only.
+	virtual const GameData::ModuleImage *FindLibraryImage(const char *pszName) const;
 }; // IGameData
 
 namespace GameData
@@ -115,6 +128,31 @@ namespace GameData
 		GAME_MAX
 	}; // GameData::Game
 
+	// Value types of struct layout fields ("type" of a field).
+	enum FieldType : int
+	{
+		FIELD_UNKNOWN = -1,
+		FIELD_FIRST = 0,
+
+		FIELD_BOOL = 0,
+		FIELD_INT8,
+		FIELD_UINT8,
+		FIELD_INT16,
+		FIELD_UINT16,
+		FIELD_INT32,
+		FIELD_UINT32,
+		FIELD_INT64,
+		FIELD_UINT64,
+		FIELD_FLOAT32,
+		FIELD_FLOAT64,
+		FIELD_POINTER,
+		FIELD_VECTOR,
+		FIELD_QANGLE,
+		FIELD_HANDLE,
+
+		FIELD_MAX
+	}; // GameData::FieldType
+
 	inline static Platform GetCurrentPlatform();
 	inline static const CKV3MemberName &GetCurrentPlatformMemberName();
 	inline static const CKV3MemberName &GetPlatformMemberName(Platform eElm);
@@ -376,6 +414,15 @@ namespace GameData
 				return IS_VALID_GAMEDATA_INDEX(m_mapValues, iFound) ? map.Element(iFound) : aDefaultValue;
 			}
 
+			const V *Find(const K &aKey) const
+			{
+				auto &map = m_mapValues;
+
+				auto iFound = map.Find(aKey);
+
+				return IS_VALID_GAMEDATA_INDEX(m_mapValues, iFound) ? &map.Element(iFound) : nullptr;
+			}
+
 			void TriggerCallbacks()
 			{
 				for(auto const &[aKey, aVal] : m_mapValues)
@@ -457,55 +504,218 @@ namespace GameData
 			CUtlVector<IListener *> m_vecListeners;
 		}; // GameData::Config::Storage
 
+	public:
+		// An address as (module id, RVA): the module id is the "library" name, so it survives ASLR and other processes.
+		struct RelativeAddress_t
+		{
+			CUtlSymbolLarge m_sModule;
+			uintp m_nRVA = 0;
+
+			bool IsValid() const
+			{
+				return m_sModule.IsValid();
+			}
+		}; // GameData::Config::RelativeAddress_t
+
+		// Fields of a struct in declaration order, so one lookup serves every field read per object.
+		struct Layout_t
+		{
+			struct Field_t
+			{
+				CUtlSymbolLarge m_sName;
+				ptrdiff_t m_nOffset;
+				uint32 m_nSize;
+				FieldType m_eType;
+			}; // GameData::Config::Layout_t::Field_t
+
+			std::vector<Field_t> m_vecFields;
+			size_t m_nExtent = 0; // The end of the last field.
+
+			const Field_t *Find(const CUtlSymbolLarge &sName) const
+			{
+				for(const auto &it : m_vecFields)
+				{
+					if(it.m_sName == sName)
+					{
+						return &it;
+					}
+				}
+
+				return nullptr;
+			}
+		}; // GameData::Config::Layout_t
+
 	public:
 		using Addresses = Storage<CUtlSymbolLarge, DynLibUtils::CMemory>;
+		using RelativeAddresses = Storage<CUtlSymbolLarge, RelativeAddress_t>;
 		using Keys = Storage<CUtlSymbolLarge, CUtlString>;
 		using Offsets = Storage<CUtlSymbolLarge, ptrdiff_t>;
 
+		// The scan anchor picked for each signature from its module's byte profile, for diagnostics.
+		using Anchors = Storage<CUtlSymbolLarge, ByteProfile::Anchor_t>;
+
+		// Offsets entries with "fields".
+		using Layouts = Storage<CUtlSymbolLarge, Layout_t>;
+
 	public:
-		Config() = default;
+		Config();
 		explicit Config(const Addresses &aInitAddressStorage, const Keys &aInitKeysStorage, const Offsets &aInitOffsetsStorage);
 
 	public:
 		bool Load(IGameData *pRoot, KeyValues3 *pGameConfig, CBufferStringVector &vecMessages);
 		void ClearValues();
 
+	public:
+		// { "modules": { "<library>": "<fingerprint>" }, "addresses": { "<name>": { "module": "<library>", "rva": <number> } } }
+		bool ExportRelativeAddresses(KeyValues3 *pData, CBufferStringVector &vecMessages) const;
+		bool ImportRelativeAddresses(IGameData *pRoot, KeyValues3 *pData, CBufferStringVector &vecMessages);
+
 	public:
 		Addresses &GetAddresses();
+		RelativeAddresses &GetRelativeAddresses();
 		Keys &GetKeys();
 		Offsets &GetOffsets();
+		Anchors &GetAnchors();
+		Layouts &GetLayouts();
+
+	public:
+		// The platform key entries are read by; the build's own unless loading for another one offline.
+		Platform GetPlatform() const;
+		void SetPlatform(Platform eValue);
+
+		// Opt-in: a signature which no longer matches is looked up again allowing nMaxDistance
+		// mismatching literal bytes. The closest match is reported with a replacement pattern,
+		// and is used for the session with bUseRecovered, unless it is ambiguous.
+		void SetSignatureRecovery(size_t nMaxDistance, bool bUseRecovered = false);
+
+		// The SchemaSystem dump (JSON) offsets of the "schema" form are looked up in, read on first use.
+		// Either { "<module>": { "classes": { "<class>": { "parent": "<class>", "fields": { "<field>": <offset> } } } } }
+		// or { "<class>": { "<field>": <offset> } }.
+		void SetSchemaDump(const char *pszPath);
+
+		// Writes back what the "Patches" sections applied so far overwrote, for unload.
+		// Load() does it too, before applying the patches again.
+		bool RevertPatches(CBufferStringVector &vecMessages);
 
 	protected:
 		bool LoadEngine(IGameData *pRoot, KeyValues3 *pEngineValues, CBufferStringVector &vecMessages);
 
 		bool LoadEngineSignatures(IGameData *pRoot, KeyValues3 *pSignaturesValues, CBufferStringVector &vecMessages);
+		bool RecoverSignature(const char *pszSigName, const ModuleImage *pImage, const Pattern &aPattern, uintptr_t &nRVA, CBufferStringVector &vecMessages);
+
+		// The iReference-th instruction (in RVA order) referencing the string literal.
+		bool FindStringReference(const char *pszSigName, const ModuleImage *pImage, const char *pszText, int iReference, uintptr_t &nRVA, CBufferStringVector &vecMessages);
+
+		// The parsed image of the "library" of a section entry.
+		const ModuleImage *LoadEngineLibraryImage(IGameData *pRoot, const char *pszEntryName, KeyValues3 *pEntryValues, CUtlSymbolLarge &sLibrary, CBufferStringVector &vecMessages);
+
+		// Vtables by class name through the RTTI of a module, stored as addresses.
+		bool LoadEngineVtables(IGameData *pRoot, KeyValues3 *pVtablesValues, CBufferStringVector &vecMessages);
+
+		// Interfaces by version string through the CreateInterface registry of a module.
+		bool LoadEngineInterfaces(IGameData *pRoot, KeyValues3 *pInterfacesValues, CBufferStringVector &vecMessages);
 		bool LoadEngineKeys(IGameData *pRoot, KeyValues3 *pKeysValues, CBufferStringVector &vecMessages);
 		bool LoadEngineOffsets(IGameData *pRoot, KeyValues3 *pOffsetsValues, CBufferStringVector &vecMessages);
+		bool LoadEngineLayout(const char *pszLayoutName, KeyValues3 *pLayoutValues, CBufferStringVector &vecMessages);
+		bool LoadSchemaDump(CBufferStringVector &vecMessages);
+
+		// Folds an expression (see EvaluateExpression()) over the Offsets and the numeric Keys loaded so far.
+		// An empty one is 0.
+		bool ReadExpression(const char *pszText, ptrdiff_t &nResult, std::string &sError, bool *pUnresolved = nullptr);
+
+		// The value of a numeric address action: a number, or an expression string.
+		bool ReadActionValue(const char *pszAddressName, const char *pszName, KeyValues3 *pAction, ptrdiff_t &nResult, CBufferStringVector &vecMessages);
+		void LoadSchemaClass(const char *pszClassName, KeyValues3 *pClassValues);
 
 		// Step #2 - addresses.
 		bool LoadEngineAddresses(IGameData *pRoot, KeyValues3 *pAddressesValues, CBufferStringVector &vecMessages);
+
+		// Step #3 - byte patches at addresses, applied in one batch.
+		bool LoadEnginePatches(IGameData *pRoot, KeyValues3 *pPatchesValues, CBufferStringVector &vecMessages);
 		bool LoadEngineAddressActions(IGameData *pRoot, const char *pszAddressSection, uintptr_t &pAddrCur, KeyValues3 *pActionValues,  CBufferStringVector &vecMessages);
 
+		// "callers_of" and "nth_call": follows call edges of the module pAddrCur is in.
+		bool LoadEngineXrefAction(const char *pszAddressName, const char *pszName, ptrdiff_t nIndex, uintptr_t &pAddrCur, CBufferStringVector &vecMessages);
+
+		// "scan": a pattern within "max" bytes of pAddrCur, forward or "backward".
+		bool LoadEngineScanAction(const char *pszAddressName, const char *pszName, KeyValues3 *pAction, uintptr_t &pAddrCur, CBufferStringVector &vecMessages);
+
+		// "function_start" and "scan_in_function": bounded by the unwind-table extent of the function pAddrCur is in.
+		bool LoadEngineFunctionAction(const char *pszAddressName, const char *pszName, KeyValues3 *pAction, uintptr_t &pAddrCur, CBufferStringVector &vecMessages);
+
 	public:
 		CUtlSymbolLarge GetSymbol(const char *pszText);
 		CUtlSymbolLarge FindSymbol(const char *pszText) const;
 
 	public:
 		const DynLibUtils::CMemory &GetAddress(const CUtlSymbolLarge &sName) const;
+		const RelativeAddress_t &GetRelativeAddress(const CUtlSymbolLarge &sName) const;
 		const CUtlString &GetKey(const CUtlSymbolLarge &sName) const;
 		const ptrdiff_t &GetOffset(const CUtlSymbolLarge &sName) const;
+		const ByteProfile::Anchor_t &GetAnchor(const CUtlSymbolLarge &sName) const;
+
+		// Null if there is no such layout; stays valid until it is loaded again.
+		const Layout_t *GetLayout(const CUtlSymbolLarge &sName) const;
 
 	protected:
 		void SetAddress(const CUtlSymbolLarge &sName, const DynLibUtils::CMemory &aMemory);
+		void SetRelativeAddress(const CUtlSymbolLarge &sName, const RelativeAddress_t &aRelative);
 		void SetKey(const CUtlSymbolLarge &sName, const CUtlString &sValue);
 		void SetOffset(const CUtlSymbolLarge &sName, const ptrdiff_t &nValue);
+		void SetAnchor(const CUtlSymbolLarge &sName, const ByteProfile::Anchor_t &aAnchor);
+		void SetLayout(const CUtlSymbolLarge &sName, const Layout_t &aLayout);
+
+	protected:
+		struct Library_t
+		{
+			const DynLibUtils::CModule *m_pModule;
+			const ModuleImage *m_pImage;
+
+			bool IsValid() const
+			{
+				return m_pModule || m_pImage;
+			}
+		}; // GameData::Config::Library_t
+
+		// Resolves each distinct library name once per load.
+		const Library_t *FindLibrary(IGameData *pRoot, const CUtlSymbolLarge &sLibrary);
+
+	protected:
+		void AddModuleImage(const CUtlSymbolLarge &sModule, const ModuleImage *pImage);
+		const ModuleImage *FindModuleImage(const CUtlSymbolLarge &sModule) const;
+		bool FindModuleByAddress(uintptr_t pAddress, RelativeAddress_t &aResult) const;
+
+		// An address of the target process (a pointer read out of a remote copy) to the local copy of its module.
+		uintptr_t ToLocalAddress(uintptr_t pAddress) const;
+
+		// Bounds-checked against the module images once any of them is not live.
+		bool ReadMemory(uintptr_t pAddress, void *pOutput, size_t nSize) const;
 
 	private:
 		CUtlSymbolTableLarge_CI m_aSymbolTable;
 
 		Addresses m_aAddressStorage;
+		RelativeAddresses m_aRelativeAddressStorage;
 		Keys m_aKeysStorage;
 		Offsets m_aOffsetStorage;
+		Anchors m_aAnchorStorage;
+		Layouts m_aLayoutStorage;
+
+		Platform m_ePlatform;
+
+		size_t m_nRecoveryDistance;
+		bool m_bUseRecovered;
+
+		CUtlString m_sSchemaDump;
+		bool m_bSchemaLoaded;
+		SchemaIndex m_aSchema;
+
+		Patcher m_aPatcher;
+		std::unordered_set<const char *> m_setLoadedAddresses; // Set by the current Load(), by the symbol string.
+		std::unordered_set<const char *> m_setPendingOffsets; // Offset expressions not folded yet, their stored values are stale.
+
+		CUtlMap<CUtlSymbolLarge, const ModuleImage *> m_mapModuleImages;
+		std::unordered_map<const char *, Library_t> m_mapLibraries;
 	}; // GameData::Config
 }; // GameData
 
@@ -0,0 +1,58 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_BUFFERIMAGE_HPP_
+#define _INCLUDE_GAMEDATA_BUFFERIMAGE_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace GameData
+{
+	// A module image over a private copy of the module, laid out by a subclass.
+	class BufferModuleImage : public ModuleImage
+	{
+	public:
+		BufferModuleImage();
+		~BufferModuleImage() override;
+
+	protected:
+		bool Allocate(size_t nSize);
+		void Release();
+
+		uint8_t *GetMemory() const;
+		size_t GetMemorySize() const;
+
+	protected:
+		// Rebases the relative relocations onto the copy. nAppliedBias is what the source
+		// had applied already: zero for a file, the load bias for a loaded module.
+		void RelocateELF(uint64_t nAppliedBias = 0);
+		void RelocatePE(uint32_t nDirectoryRVA, uint32_t nDirectorySize, uint64_t nAppliedBase);
+
+	protected:
+		uint8_t *m_pMemory;
+		size_t m_nMemorySize;
+	}; // GameData::BufferModuleImage
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_BUFFERIMAGE_HPP_
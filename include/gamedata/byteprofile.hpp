@@ -0,0 +1,67 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_BYTEPROFILE_HPP_
+#define _INCLUDE_GAMEDATA_BYTEPROFILE_HPP_
+
+#include <gamedata/image.hpp>
+#include <gamedata/pattern.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace GameData
+{
+	// Byte and bigram frequencies of the code segments of a module. x86 code is far from
+	// uniform (0x48, 0x8B, 0x00 are everywhere), so the anchor a scan looks for matters.
+	class ByteProfile
+	{
+	public:
+		struct Anchor_t
+		{
+			size_t m_nOffset = 0;
+			size_t m_nCompanion = 0; // The neighbouring literal checked next; the offset itself when none.
+			size_t m_nExpected = 0; // Positions of the module passing the anchor (and companion) check.
+			double m_flSelectivity = 1.0; // m_nExpected over the profiled bytes.
+		}; // GameData::ByteProfile::Anchor_t
+
+	public:
+		explicit ByteProfile(const ModuleImage &aImage);
+
+	public:
+		size_t GetTotal() const;
+		size_t GetByteCount(uint8_t nByte) const;
+		size_t GetPairCount(uint8_t nFirst, uint8_t nSecond) const;
+
+		// The rarest literal byte of the pattern, paired with its rarer literal neighbour.
+		Anchor_t SelectAnchor(const Pattern &aPattern) const;
+
+	private:
+		size_t m_nTotal;
+
+		std::vector<uint32_t> m_vecBytes;
+		std::vector<uint32_t> m_vecPairs;
+	}; // GameData::ByteProfile
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_BYTEPROFILE_HPP_
@@ -0,0 +1,43 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_EXPRESSION_HPP_
+#define _INCLUDE_GAMEDATA_EXPRESSION_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+
+namespace GameData
+{
+	// Looks up the value of a name an expression refers to; false if there is none (yet).
+	using ExpressionResolver_t = std::function<bool (const std::string &sName, int64_t &nValue)>;
+
+	// Folds an integer expression to its value: decimal, 0x hex and 0 octal literals, names
+	// ([A-Za-z_][A-Za-z0-9_:.]*), parentheses, unary + - ~ and the binary operators of C
+	// from * / % down to |, with C precedence. On failure, sError tells what and where;
+	// bUnresolved is set when an unknown name is the cause.
+	bool EvaluateExpression(const char *pszText, const ExpressionResolver_t &funcResolve, int64_t &nResult, std::string &sError, bool *pUnresolved = nullptr);
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_EXPRESSION_HPP_
@@ -0,0 +1,94 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_FILEGAMEDATA_HPP_
+#define _INCLUDE_GAMEDATA_FILEGAMEDATA_HPP_
+
+#include <gamedata.hpp>
+#include <gamedata/bufferimage.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GameData
+{
+	// A module read from disk (ELF, PE or Mach-O) and laid out as the loader would map it
+	// at its own address. Relative relocations of ELF and base relocations of PE are applied,
+	// so pointers inside the image are followable; symbol-bound slots keep their on-disk values.
+	class FileModuleImage : public BufferModuleImage
+	{
+	public:
+		bool Load(const char *pszPath, std::string &sError);
+
+		const std::string &GetPath() const;
+
+	protected:
+		bool LayoutELF(const uint8_t *pFile, size_t nFileSize, std::string &sError);
+		bool LayoutPE(const uint8_t *pFile, size_t nFileSize, std::string &sError);
+
+		// Universal binaries are narrowed down to their x86-64 slice first.
+		bool LayoutMachO(const uint8_t *pFile, size_t nFileSize, std::string &sError);
+
+	private:
+		std::string m_sPath;
+	}; // GameData::FileModuleImage
+
+	// Resolves gamedata against binaries on disk, with no engine process.
+	class FileGameData : public IGameData
+	{
+	public:
+		FileGameData();
+
+	public: // IGameData
+		const DynLibUtils::CModule *FindLibrary(const char *pszName) const override;
+		const ModuleImage *FindLibraryImage(const char *pszName) const override;
+
+	public:
+		// Directories to look up library names in, tried in order of addition.
+		void AddSearchPath(const char *pszPath);
+
+		// An explicit file for a library name, bypassing the search paths.
+		void AddLibrary(const char *pszName, const char *pszPath);
+
+		std::string GetLastError() const;
+
+	protected:
+		void GetCandidates(const char *pszName, std::vector<std::string> &vecPaths) const;
+
+	private:
+		mutable std::mutex m_mtxLibraries;
+
+		std::vector<std::string> m_vecSearchPaths;
+		std::unordered_map<std::string, std::string> m_mapPaths;
+
+		// Failed loads are kept as nullptr, so a missing file is looked up once.
+		mutable std::unordered_map<std::string, std::unique_ptr<FileModuleImage>> m_mapImages;
+		mutable std::string m_sLastError;
+	}; // GameData::FileGameData
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_FILEGAMEDATA_HPP_
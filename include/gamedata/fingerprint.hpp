@@ -0,0 +1,82 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_FINGERPRINT_HPP_
+#define _INCLUDE_GAMEDATA_FINGERPRINT_HPP_
+
+#define MAX_GAMEDATA_FINGERPRINT_LENGTH MAX_GAMEDATA_IMAGE_BUILD_ID_LENGTH
+#define MAX_GAMEDATA_FINGERPRINT_STRING_LENGTH (2 + 1 + MAX_GAMEDATA_FINGERPRINT_LENGTH * 2 + 1)
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace GameData
+{
+	class Fingerprint
+	{
+	public:
+		enum Source : int
+		{
+			SOURCE_UNKNOWN = -1,
+			SOURCE_FIRST = 0,
+
+			SOURCE_BUILD_ID = 0, // ELF GNU build-id, PE CodeView GUID + age, Mach-O LC_UUID.
+			SOURCE_CONTENT_HASH, // Headers + sampled pages of the read-only segments.
+
+			SOURCE_MAX
+		}; // GameData::Fingerprint::Source
+
+		Fingerprint();
+		explicit Fingerprint(const ModuleImage &aImage);
+
+	public:
+		bool IsValid() const;
+
+		Source GetSource() const;
+		const uint8_t *GetData() const;
+		size_t GetLength() const;
+
+		bool operator==(const Fingerprint &aOther) const;
+		bool operator!=(const Fingerprint &aOther) const;
+
+	public:
+		// "<source>:<hex>", e.g. "id:8f3c..." or "ch:12ab...".
+		const char *ToString(char *pszBuffer, size_t nMaxLength) const;
+		bool FromString(const char *pszValue);
+
+	protected:
+		void ComputeContentHash(const ModuleImage &aImage);
+
+	private:
+		Source m_eSource;
+
+		uint8_t m_aData[MAX_GAMEDATA_FINGERPRINT_LENGTH];
+		size_t m_nLength;
+	}; // GameData::Fingerprint
+
+	// Computed once per module, memoized for the process lifetime.
+	const Fingerprint &GetModuleFingerprint(const ModuleImage *pImage);
+	const Fingerprint &GetModuleFingerprint(const DynLibUtils::CModule *pModule);
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_FINGERPRINT_HPP_
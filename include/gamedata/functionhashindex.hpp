@@ -0,0 +1,57 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_FUNCTIONHASHINDEX_HPP_
+#define _INCLUDE_GAMEDATA_FUNCTIONHASHINDEX_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+
+namespace GameData
+{
+	// Functions of a module by a hash of their instruction stream with displacements and
+	// immediates masked out, so moving a function or changing its constants keeps the hash.
+	// Function bounds come from FunctionIndex.
+	class FunctionHashIndex
+	{
+	public:
+		explicit FunctionHashIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+
+		// Fails for a hash shared by several functions (trivial bodies mostly).
+		bool Find(uint64_t nHash, uintptr_t &nRVA) const;
+
+	public:
+		// The hash of the code in [nStart, nEnd); fails if an instruction does not decode.
+		static bool Compute(const ModuleImage &aImage, uintptr_t nStart, uintptr_t nEnd, uint64_t &nHash);
+
+	private:
+		std::unordered_map<uint64_t, uint32_t> m_mapFunctions; // Ambiguous ones map to UINT32_MAX.
+	}; // GameData::FunctionHashIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_FUNCTIONHASHINDEX_HPP_
@@ -0,0 +1,69 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_FUNCTIONINDEX_HPP_
+#define _INCLUDE_GAMEDATA_FUNCTIONINDEX_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace GameData
+{
+	// Function bounds of a module, from its unwind tables: the FDEs listed by .eh_frame_hdr
+	// on ELF, .pdata on PE. Hot/cold split parts have an entry each, as their own functions.
+	class FunctionIndex
+	{
+	public:
+		struct Function_t
+		{
+			uint32_t m_nStart;
+			uint32_t m_nEnd;
+
+			bool operator<(const Function_t &aOther) const
+			{
+				return m_nStart < aOther.m_nStart;
+			}
+		}; // GameData::FunctionIndex::Function_t
+
+	public:
+		explicit FunctionIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+		const std::vector<Function_t> &GetFunctions() const;
+
+		// The function (or function part) containing nRVA.
+		bool Find(uintptr_t nRVA, Function_t &aResult) const;
+
+	protected:
+		void InitELF(const ModuleImage &aImage);
+		void InitPE(const ModuleImage &aImage);
+
+	private:
+		std::vector<Function_t> m_vecFunctions; // By start.
+	}; // GameData::FunctionIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_FUNCTIONINDEX_HPP_
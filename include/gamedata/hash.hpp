@@ -0,0 +1,54 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_HASH_HPP_
+#define _INCLUDE_GAMEDATA_HASH_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace GameData
+{
+	// XXH64-compatible streaming hash. Four independent lanes per 32-byte stripe keep the multipliers pipelined.
+	class Hash64
+	{
+	public:
+		explicit Hash64(uint64_t nSeed = 0);
+
+	public:
+		void Reset(uint64_t nSeed = 0);
+		void Update(const void *pData, size_t nLength);
+		uint64_t Digest() const;
+
+	public:
+		static uint64_t Compute(const void *pData, size_t nLength, uint64_t nSeed = 0);
+
+	private:
+		uint64_t m_aLanes[4];
+		uint64_t m_nSeed;
+		uint64_t m_nTotalLength;
+
+		uint8_t m_aStripe[32];
+		size_t m_nStripeLength;
+	}; // GameData::Hash64
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_HASH_HPP_
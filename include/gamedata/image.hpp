@@ -0,0 +1,203 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_IMAGE_HPP_
+#define _INCLUDE_GAMEDATA_IMAGE_HPP_
+
+#define MAX_GAMEDATA_IMAGE_SEGMENT_NAME_LENGTH 16
+#define MAX_GAMEDATA_IMAGE_BUILD_ID_LENGTH 32
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace DynLibUtils
+{
+	class CModule;
+}; // DynLibUtils
+
+namespace GameData
+{
+	enum ImageFormat : int
+	{
+		IMAGE_FORMAT_UNKNOWN = -1,
+		IMAGE_FORMAT_FIRST = 0,
+
+		IMAGE_FORMAT_ELF = 0,
+		IMAGE_FORMAT_PE,
+		IMAGE_FORMAT_MACHO,
+
+		IMAGE_FORMAT_MAX
+	}; // GameData::ImageFormat
+
+	enum ImageSegmentFlags : int
+	{
+		IMAGE_SEGMENT_NONE = 0,
+
+		IMAGE_SEGMENT_READ = (1 << 0),
+		IMAGE_SEGMENT_WRITE = (1 << 1),
+		IMAGE_SEGMENT_EXECUTE = (1 << 2),
+	}; // GameData::ImageSegmentFlags
+
+	// A module laid out as the loader maps it: RVA 0 is the first byte of the headers.
+	class ModuleImage
+	{
+	public:
+		struct Segment_t
+		{
+			char m_szName[MAX_GAMEDATA_IMAGE_SEGMENT_NAME_LENGTH];
+
+			uintptr_t m_nRVA;
+			size_t m_nSize;
+			int m_nFlags;
+
+			bool IsCode() const
+			{
+				return m_nFlags & IMAGE_SEGMENT_EXECUTE;
+			}
+
+			bool IsReadOnly() const
+			{
+				return !(m_nFlags & IMAGE_SEGMENT_WRITE);
+			}
+
+			bool Contains(uintptr_t nRVA) const
+			{
+				return nRVA - m_nRVA < m_nSize;
+			}
+		}; // GameData::ModuleImage::Segment_t
+
+		ModuleImage();
+		virtual ~ModuleImage();
+
+		ModuleImage(const ModuleImage &) = delete;
+		ModuleImage &operator=(const ModuleImage &) = delete;
+
+	public:
+		// nLimit = 0 trusts the headers (a module mapped by the loader).
+		bool Init(const void *pBase, size_t nLimit = 0, bool bLive = true);
+
+	public:
+		ImageFormat GetFormat() const;
+		bool IsLive() const;
+
+		const uint8_t *GetBase() const;
+		uintptr_t GetRuntimeBase() const;
+		uintptr_t GetVirtualBase() const;
+		size_t GetSize() const;
+
+		const std::vector<Segment_t> &GetSegments() const;
+		const Segment_t *FindSegment(uintptr_t nRVA) const;
+		const Segment_t *FindSegment(const char *pszName) const;
+
+		const uint8_t *GetBuildId(size_t &nLength) const;
+
+	public:
+		bool Contains(uintptr_t pAddress) const;
+		bool ContainsRVA(uintptr_t nRVA, size_t nLength = 1) const;
+
+		uintptr_t ToRVA(uintptr_t pAddress) const;
+		uintptr_t FromRVA(uintptr_t nRVA) const;
+
+		template<typename T = uint8_t>
+		const T *GetPointer(uintptr_t nRVA) const
+		{
+			return reinterpret_cast<const T *>(m_pBase + nRVA);
+		}
+
+	public:
+		// Lazily built per-module data (T is constructed from the image once, then shared).
+		template<typename T>
+		const T &GetIndex() const
+		{
+			IndexSlot_t *pSlot;
+
+			{
+				std::lock_guard<std::mutex> aLock(m_mtxIndexes);
+
+				auto &pFoundSlot = m_mapIndexes[std::type_index(typeid(T))];
+
+				if(!pFoundSlot)
+				{
+					pFoundSlot = std::make_unique<IndexSlot_t>();
+				}
+
+				pSlot = pFoundSlot.get();
+			}
+
+			std::call_once(pSlot->m_aOnce, [this, pSlot]()
+			{
+				pSlot->m_pIndex = std::make_shared<T>(*this);
+			});
+
+			return *static_cast<const T *>(pSlot->m_pIndex.get());
+		}
+
+	protected:
+		bool InitELF();
+		bool InitPE();
+		bool InitMachO();
+
+		void AddSegment(const char *pszName, uintptr_t nRVA, size_t nSize, int nFlags);
+		void SetBuildId(const void *pData, size_t nLength);
+
+		bool IsReadable(uintptr_t nRVA, size_t nLength) const;
+
+	protected:
+		ImageFormat m_eFormat;
+		bool m_bLive;
+
+		const uint8_t *m_pBase;
+		size_t m_nLimit;
+
+		uintptr_t m_nRuntimeBase;
+		uintptr_t m_nVirtualBase;
+		size_t m_nSize;
+
+		std::vector<Segment_t> m_vecSegments;
+
+		uint8_t m_aBuildId[MAX_GAMEDATA_IMAGE_BUILD_ID_LENGTH];
+		size_t m_nBuildIdLength;
+
+	private:
+		struct IndexSlot_t
+		{
+			std::once_flag m_aOnce;
+			std::shared_ptr<void> m_pIndex;
+		}; // GameData::ModuleImage::IndexSlot_t
+
+		mutable std::mutex m_mtxIndexes;
+		mutable std::unordered_map<std::type_index, std::unique_ptr<IndexSlot_t>> m_mapIndexes;
+	}; // GameData::ModuleImage
+
+	// Memoized by the module base until the module is unloaded and forgotten.
+	const ModuleImage *GetModuleImage(const DynLibUtils::CModule *pModule);
+
+	// Drops the memoized image of an unloaded module, so a library mapped at its base later gets a fresh one.
+	void ForgetModuleImage(uintptr_t pBase);
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_IMAGE_HPP_
@@ -0,0 +1,58 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_IMPORTTABLE_HPP_
+#define _INCLUDE_GAMEDATA_IMPORTTABLE_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace GameData
+{
+	// The slots a module imports its functions and data through, by symbol name: the GOT
+	// entries the dynamic relocations (.rela.plt, then .rela.dyn) bind on ELF, the import
+	// address table on PE. Hooking one slot redirects every use of the import in the module.
+	class ImportTable
+	{
+	public:
+		explicit ImportTable(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+
+		// A function imported both ways has its PLT slot taken: that is what calls go through.
+		bool Find(const char *pszName, uintptr_t &nRVA) const;
+
+	protected:
+		void InitELF(const ModuleImage &aImage);
+		void InitPE(const ModuleImage &aImage);
+
+	private:
+		std::unordered_map<std::string, uint32_t> m_mapSlots;
+	}; // GameData::ImportTable
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_IMPORTTABLE_HPP_
@@ -0,0 +1,95 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_INSTRUCTION_HPP_
+#define _INCLUDE_GAMEDATA_INSTRUCTION_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace GameData
+{
+	enum InstructionFlags : int
+	{
+		INSTRUCTION_NONE = 0,
+
+		INSTRUCTION_MODRM = (1 << 0),
+		INSTRUCTION_RIP_RELATIVE = (1 << 1), // The displacement is relative to the next instruction.
+		INSTRUCTION_RELATIVE = (1 << 2), // The immediate is a branch displacement.
+		INSTRUCTION_CALL = (1 << 3),
+		INSTRUCTION_JUMP = (1 << 4),
+		INSTRUCTION_CONDITIONAL = (1 << 5),
+		INSTRUCTION_RETURN = (1 << 6),
+		INSTRUCTION_INDIRECT = (1 << 7), // call/jmp through a register or memory.
+	}; // GameData::InstructionFlags
+
+	// An x86-64 instruction, decoded as far as lengths and operand positions go.
+	struct Instruction_t
+	{
+		uint8_t m_nLength;
+
+		uint8_t m_nOpcodeOffset; // After legacy, REX, VEX and EVEX prefixes.
+		uint8_t m_nMap; // 0 = one-byte, 1 = 0F, 2 = 0F 38, 3 = 0F 3A.
+		uint8_t m_nOpcode;
+		uint8_t m_nModRM;
+
+		uint8_t m_nDisplacementOffset;
+		uint8_t m_nDisplacementSize;
+		uint8_t m_nImmediateOffset;
+		uint8_t m_nImmediateSize;
+
+		int m_nFlags;
+
+		int64_t m_nDisplacement;
+		int64_t m_nImmediate;
+
+		bool IsBranch() const
+		{
+			return m_nFlags & (INSTRUCTION_CALL | INSTRUCTION_JUMP);
+		}
+
+		// The address a RIP-relative operand or a relative branch points to.
+		bool GetTarget(uintptr_t nAddress, uintptr_t &nTarget) const
+		{
+			if(m_nFlags & INSTRUCTION_RIP_RELATIVE)
+			{
+				nTarget = nAddress + m_nLength + static_cast<uintptr_t>(m_nDisplacement);
+
+				return true;
+			}
+
+			if(m_nFlags & INSTRUCTION_RELATIVE)
+			{
+				nTarget = nAddress + m_nLength + static_cast<uintptr_t>(m_nImmediate);
+
+				return true;
+			}
+
+			return false;
+		}
+	}; // GameData::Instruction_t
+
+	// Decodes one instruction of 64-bit code from at most nAvailable bytes.
+	// Fails on opcodes invalid in long mode and on truncated input.
+	bool DecodeInstruction(const uint8_t *pData, size_t nAvailable, Instruction_t &aResult);
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_INSTRUCTION_HPP_
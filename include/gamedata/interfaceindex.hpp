@@ -0,0 +1,79 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_INTERFACEINDEX_HPP_
+#define _INCLUDE_GAMEDATA_INTERFACEINDEX_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace GameData
+{
+	// The interfaces a module registers, by version string: the InterfaceReg list its
+	// exported CreateInterface walks, walked once. The list is linked up by static
+	// constructors, so an image read from disk has it empty.
+	class InterfaceIndex
+	{
+	public:
+		struct Interface_t
+		{
+			uint32_t m_nCreate; // InstantiateInterfaceFn
+			uint32_t m_nInstance; // When the function only returns a static object (lea rax, [rip + X]; ret), or 0.
+		}; // GameData::InterfaceIndex::Interface_t
+
+	public:
+		explicit InterfaceIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+
+		const Interface_t *Find(const char *pszVersion) const;
+
+		// Calls the InstantiateInterfaceFn of a loaded module once, later calls get the same object.
+		void *Instantiate(const ModuleImage &aImage, const Interface_t &aInterface) const;
+
+	protected:
+		struct InterfaceReg_t
+		{
+			uint64_t m_pCreateFn;
+			uint64_t m_pName;
+			uint64_t m_pNext;
+		}; // GameData::InterfaceIndex::InterfaceReg_t
+
+		static uint32_t FindStaticInstance(const ModuleImage &aImage, uintptr_t nFunction);
+
+		bool Walk(const ModuleImage &aImage, uintptr_t nHead);
+
+	private:
+		std::unordered_map<std::string, Interface_t> m_mapInterfaces;
+
+		mutable std::mutex m_mtxInstances;
+		mutable std::unordered_map<uint32_t, void *> m_mapInstances; // By m_nCreate.
+	}; // GameData::InterfaceIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_INTERFACEINDEX_HPP_
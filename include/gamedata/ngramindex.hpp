@@ -0,0 +1,86 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_NGRAMINDEX_HPP_
+#define _INCLUDE_GAMEDATA_NGRAMINDEX_HPP_
+
+#define GAMEDATA_NGRAM_LENGTH 4
+
+#include <gamedata/image.hpp>
+#include <gamedata/pattern.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace GameData
+{
+	// Posting lists of the 4-byte grams in the code segments of a module, hashed into buckets.
+	// A pattern is looked up through its rarest grams: only positions they all agree on
+	// are verified, instead of streaming the whole image.
+	class NGramIndex
+	{
+	public:
+		explicit NGramIndex(const ModuleImage &aImage);
+
+	public:
+		// Where built indexes are kept between runs, named by the module fingerprint.
+		// Empty (the default) keeps them in memory only.
+		static void SetCacheDirectory(const char *pszPath);
+		static std::string GetCacheDirectory();
+
+	public:
+		bool IsValid() const;
+		bool IsCached() const; // Loaded from the cache directory instead of built.
+
+		size_t GetPositionCount() const;
+
+		// A pattern needs a literal run of GAMEDATA_NGRAM_LENGTH bytes to be looked up.
+		bool CanFind(const Pattern &aPattern) const;
+
+		// The lowest matching RVA, which is what a scan of the code segments finds first.
+		bool Find(const Pattern &aPattern, uintptr_t &nRVA) const;
+
+	protected:
+		void Build();
+
+		bool Load(const std::string &sPath);
+		bool Save(const std::string &sPath) const;
+
+		uint32_t GetBucket(const uint8_t *pGram) const;
+
+		// The posting list of a bucket, as [pBegin, pEnd).
+		void GetPostings(uint32_t nBucket, const uint32_t *&pBegin, const uint32_t *&pEnd) const;
+
+	private:
+		const ModuleImage &m_aImage;
+
+		uint32_t m_nBucketBits;
+		bool m_bCached;
+
+		std::vector<uint32_t> m_vecOffsets; // Bucket starts in m_vecPositions, plus the end.
+		std::vector<uint32_t> m_vecPositions; // RVAs, ascending within a bucket.
+	}; // GameData::NGramIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_NGRAMINDEX_HPP_
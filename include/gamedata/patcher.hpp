@@ -0,0 +1,67 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_PATCHER_HPP_
+#define _INCLUDE_GAMEDATA_PATCHER_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace GameData
+{
+	// Byte patches of the current process, written in batches: the pages of a batch are made
+	// writable once per run of equally protected pages, and what each patch overwrites is kept
+	// in a journal to be written back on unload.
+	class Patcher
+	{
+	public:
+		// Queued until the next Apply().
+		void Add(uintptr_t pAddress, const uint8_t *pBytes, size_t nLength);
+
+		// Nothing is written unless every page of the batch could be made writable.
+		bool Apply(std::string &sError);
+
+		// Writes back the journal, the latest patch first, and empties it.
+		bool Revert(std::string &sError);
+
+		size_t GetPendingCount() const;
+		size_t GetAppliedCount() const;
+
+	protected:
+		struct Write_t
+		{
+			uintptr_t m_pAddress;
+			std::vector<uint8_t> m_vecBytes;
+		}; // GameData::Patcher::Write_t
+
+		// bWritten tells whether the bytes are in place, even when restoring a protection failed.
+		static bool Write(const std::vector<Write_t> &vecWrites, bool &bWritten, std::string &sError);
+
+	private:
+		std::vector<Write_t> m_vecPending;
+		std::vector<Write_t> m_vecJournal; // The original bytes, in order of application.
+	}; // GameData::Patcher
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_PATCHER_HPP_
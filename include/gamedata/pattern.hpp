@@ -0,0 +1,111 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_PATTERN_HPP_
+#define _INCLUDE_GAMEDATA_PATTERN_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace GameData
+{
+	// A signature compiled from "48 8B ? ? 05" text: literal bytes plus a mask (0xFF = literal, 0x00 = wildcard).
+	class Pattern
+	{
+	public:
+		struct Approximate_t
+		{
+			bool m_bFound = false;
+			uintptr_t m_nRVA = 0;
+			size_t m_nDistance = 0;
+			size_t m_nCandidates = 0; // Positions at the best distance; more than one is ambiguous.
+		}; // GameData::Pattern::Approximate_t
+
+	public:
+		Pattern();
+		explicit Pattern(const char *pszPattern);
+
+	public:
+		bool Compile(const char *pszPattern);
+
+		// From raw bytes and a mask of the same length (0xFF = literal, 0x00 = wildcard).
+		bool Assign(const uint8_t *pBytes, const uint8_t *pMask, size_t nLength);
+		bool IsValid() const;
+
+		const uint8_t *GetBytes() const;
+		const uint8_t *GetMask() const;
+		size_t GetLength() const;
+
+		uint64_t GetHash() const;
+
+		// The literal byte scans look for first (the first literal by default), and a neighbouring
+		// literal checked before the full match. Both only affect speed, not what matches.
+		bool SetAnchor(size_t nOffset, size_t nCompanion);
+		size_t GetAnchor() const;
+		size_t GetCompanion() const;
+
+		bool operator==(const Pattern &aOther) const;
+		bool operator!=(const Pattern &aOther) const;
+
+		std::string ToString() const;
+
+	public:
+		bool Match(const uint8_t *pData) const;
+
+		// Returns the first match in [pBegin, pEnd), or nullptr.
+		const uint8_t *Find(const uint8_t *pBegin, const uint8_t *pEnd) const;
+		const uint8_t *FindBackward(const uint8_t *pBegin, const uint8_t *pEnd) const;
+
+		// Scans the code segments of the image, in RVA order.
+		bool Find(const ModuleImage &aImage, uintptr_t &nRVA) const;
+
+	public:
+		size_t GetLiteralCount() const;
+
+		// Mismatching literal bytes at pData, counted up to nLimit + 1.
+		size_t Distance(const uint8_t *pData, size_t nLimit) const;
+
+		// The closest position in the code segments by Hamming distance over literal bytes,
+		// at most nMaxDistance and less than half of the literals away.
+		bool FindApproximate(const ModuleImage &aImage, size_t nMaxDistance, Approximate_t &aResult) const;
+
+		// The same mask over the bytes at pData: the replacement for a shifted signature.
+		Pattern WithBytes(const uint8_t *pData) const;
+
+	protected:
+		void UpdateHash();
+
+	private:
+		std::vector<uint8_t> m_vecBytes;
+		std::vector<uint8_t> m_vecMask;
+
+		size_t m_nAnchor;
+		size_t m_nCompanion;
+		uint64_t m_nHash;
+	}; // GameData::Pattern
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_PATTERN_HPP_
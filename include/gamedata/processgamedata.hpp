@@ -0,0 +1,82 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_PROCESSGAMEDATA_HPP_
+#define _INCLUDE_GAMEDATA_PROCESSGAMEDATA_HPP_
+
+#include <gamedata.hpp>
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GameData
+{
+	// The modules of the current process, enumerated with dl_iterate_phdr() and indexed
+	// by soname, file name and short name ("libserver.so" -> "server").
+	class ProcessGameData : public IGameData
+	{
+	public:
+		ProcessGameData();
+
+	public: // IGameData
+		const DynLibUtils::CModule *FindLibrary(const char *pszName) const override;
+
+	public:
+		// Picks up newly loaded modules; a no-op while the loader's counters are unchanged.
+		bool Refresh() const;
+		size_t GetLibraryCount() const;
+
+	protected:
+		struct Library_t
+		{
+			std::string m_sPath;
+			uintptr_t m_pBase;
+
+			std::unique_ptr<DynLibUtils::CModule> m_pModule; // Created on the first lookup.
+		}; // GameData::ProcessGameData::Library_t
+
+		bool RefreshLocked() const;
+		void AddLibrary(const char *pszPath, const char *pszSOName, uintptr_t pBase) const;
+		void AddName(const std::string &sName, Library_t *pLibrary) const;
+
+	private:
+		mutable std::mutex m_mtxLibraries;
+
+		mutable std::vector<std::unique_ptr<Library_t>> m_vecLibraries;
+		mutable std::unordered_map<std::string, Library_t *> m_mapNames;
+		mutable std::unordered_map<uintptr_t, Library_t *> m_mapBases;
+
+		mutable unsigned long long m_nLoaderAdds;
+		mutable unsigned long long m_nLoaderSubs;
+	}; // GameData::ProcessGameData
+}; // GameData
+
+#endif // defined(__linux__)
+
+#endif //_INCLUDE_GAMEDATA_PROCESSGAMEDATA_HPP_
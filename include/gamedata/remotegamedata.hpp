@@ -0,0 +1,119 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_REMOTEGAMEDATA_HPP_
+#define _INCLUDE_GAMEDATA_REMOTEGAMEDATA_HPP_
+
+#include <gamedata.hpp>
+
+#if defined(__linux__)
+
+#include <gamedata/bufferimage.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GameData
+{
+	// A snapshot of a module loaded by another process. The runtime base is the address
+	// in the target; pointers inside the copy are rebased onto the local one, and the ones
+	// the target wrote at runtime are mapped back through it when followed.
+	class RemoteModuleImage : public BufferModuleImage
+	{
+	public:
+		struct Region_t
+		{
+			uintptr_t m_pStart;
+			uintptr_t m_pEnd;
+		}; // GameData::RemoteModuleImage::Region_t
+
+	public:
+		// vecRegions are the readable mappings of the target, as listed in /proc/<pid>/maps;
+		// the ones within the module (its anonymous .bss included) are copied.
+		bool Load(pid_t iPID, uintptr_t pRemoteBase, const std::vector<Region_t> &vecRegions, bool bPause, std::string &sError);
+
+	protected:
+		struct Read_t
+		{
+			size_t m_nOffset;
+			uintptr_t m_pRemote;
+			size_t m_nLength;
+		}; // GameData::RemoteModuleImage::Read_t
+
+		// One process_vm_readv() per IOV_MAX regions, /proc/<pid>/mem when that is refused.
+		static bool ReadRemote(pid_t iPID, uint8_t *pLocal, const std::vector<Read_t> &vecReads);
+	}; // GameData::RemoteModuleImage
+
+	// Resolves gamedata against a running process without injecting into it: each module
+	// is copied out once, and everything else runs against the copy.
+	class RemoteGameData : public IGameData
+	{
+	public:
+		explicit RemoteGameData(pid_t iPID);
+
+	public: // IGameData
+		const DynLibUtils::CModule *FindLibrary(const char *pszName) const override;
+		const ModuleImage *FindLibraryImage(const char *pszName) const override;
+
+	public:
+		// Stops the target (SIGSTOP) for the duration of each copy, so it sees one consistent state.
+		void SetPauseTarget(bool bValue);
+
+		pid_t GetPID() const;
+		bool Refresh() const;
+		std::string GetLastError() const;
+
+	protected:
+		struct Library_t
+		{
+			std::string m_sPath;
+			uintptr_t m_pBase;
+
+			bool m_bLoaded = false;
+			std::unique_ptr<RemoteModuleImage> m_pImage; // Copied on the first lookup.
+		}; // GameData::RemoteGameData::Library_t
+
+		bool RefreshLocked() const;
+		void AddName(const std::string &sName, Library_t *pLibrary) const;
+
+	private:
+		pid_t m_iPID;
+		bool m_bPauseTarget;
+
+		mutable std::mutex m_mtxLibraries;
+
+		mutable std::vector<RemoteModuleImage::Region_t> m_vecRegions;
+		mutable std::vector<std::unique_ptr<Library_t>> m_vecLibraries;
+		mutable std::unordered_map<std::string, Library_t *> m_mapNames;
+		mutable std::string m_sLastError;
+	}; // GameData::RemoteGameData
+}; // GameData
+
+#endif // defined(__linux__)
+
+#endif //_INCLUDE_GAMEDATA_REMOTEGAMEDATA_HPP_
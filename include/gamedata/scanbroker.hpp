@@ -0,0 +1,113 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_SCANBROKER_HPP_
+#define _INCLUDE_GAMEDATA_SCANBROKER_HPP_
+
+#include <gamedata/fingerprint.hpp>
+#include <gamedata/image.hpp>
+#include <gamedata/pattern.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+namespace GameData
+{
+	// Deduplicates pattern scans by (module, compiled pattern): the first caller scans,
+	// concurrent callers of the same key wait for it, later ones get the memoized result.
+	// A module is identified by its fingerprint, so the images each plugin has of it share
+	// the results (RVAs), and an unloaded one leaves nothing dangling.
+	class ScanBroker
+	{
+	public:
+		struct Result_t
+		{
+			bool m_bFound = false;
+			uintptr_t m_nRVA = 0;
+		}; // GameData::ScanBroker::Result_t
+
+		struct Statistics_t
+		{
+			size_t m_nRequests = 0;
+			size_t m_nScans = 0;
+			size_t m_nIndexed = 0; // Scans answered by the n-gram index.
+		}; // GameData::ScanBroker::Statistics_t
+
+	public:
+		Result_t Scan(const ModuleImage *pImage, const Pattern &aPattern);
+
+		void Purge();
+
+		Statistics_t GetStatistics() const;
+
+		// Answers scans from the NGramIndex of a module, built (or loaded from its cache directory)
+		// on the first scan. Patterns without a 4-byte literal run are still scanned.
+		void SetIndexed(bool bValue);
+		bool IsIndexed() const;
+
+	private:
+		struct Key_t
+		{
+			Fingerprint m_aModule;
+			size_t m_nSize;
+			Pattern m_aPattern;
+
+			bool operator==(const Key_t &aOther) const
+			{
+				return m_aModule == aOther.m_aModule && m_nSize == aOther.m_nSize && m_aPattern == aOther.m_aPattern;
+			}
+		}; // GameData::ScanBroker::Key_t
+
+		struct KeyHash_t
+		{
+			size_t operator()(const Key_t &aKey) const
+			{
+				uint64_t nHash = aKey.m_aPattern.GetHash() ^ aKey.m_nSize;
+
+				for(size_t n = 0, nLength = aKey.m_aModule.GetLength(); n < nLength; n++)
+				{
+					nHash = (nHash ^ aKey.m_aModule.GetData()[n]) * 0x100000001B3ULL;
+				}
+
+				return static_cast<size_t>(nHash);
+			}
+		}; // GameData::ScanBroker::KeyHash_t
+
+		mutable std::mutex m_mtxResults;
+		std::unordered_map<Key_t, std::shared_future<Result_t>, KeyHash_t> m_mapResults;
+
+		Statistics_t m_aStatistics;
+
+		std::atomic<bool> m_bIndexed {false};
+	}; // GameData::ScanBroker
+
+	// The process-wide broker. Plugins linking their own copy of this library
+	// share one by handing the same instance to SetScanBroker().
+	ScanBroker *GetScanBroker();
+	void SetScanBroker(ScanBroker *pBroker);
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_SCANBROKER_HPP_
@@ -0,0 +1,52 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_SCHEMAINDEX_HPP_
+#define _INCLUDE_GAMEDATA_SCHEMAINDEX_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace GameData
+{
+	// Field offsets of SchemaSystem classes, as read from a dump, by "Class::m_field".
+	class SchemaIndex
+	{
+	public:
+		void AddClass(const char *pszName, const char *pszParent);
+		void AddField(const char *pszClass, const char *pszField, ptrdiff_t nOffset);
+		void Clear();
+
+		size_t GetCount() const;
+
+		// A field a base class declares is found through the parents of the named class.
+		bool Find(const char *pszName, ptrdiff_t &nOffset) const;
+
+	private:
+		std::unordered_map<std::string, ptrdiff_t> m_mapFields; // "Class::m_field".
+		std::unordered_map<std::string, std::string> m_mapParents;
+	}; // GameData::SchemaIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_SCHEMAINDEX_HPP_
@@ -0,0 +1,68 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_STRINGINDEX_HPP_
+#define _INCLUDE_GAMEDATA_STRINGINDEX_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace GameData
+{
+	// Locations of the NUL-terminated strings in the read-only data of a module, by hash.
+	class StringIndex
+	{
+	public:
+		explicit StringIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+
+		// RVAs of the string, ascending. Strings the linker merged into the tail of a longer
+		// one have no entry of their own; those are searched for when nothing else is found.
+		void Find(const char *pszText, std::vector<uintptr_t> &vecRVAs) const;
+
+	protected:
+		struct Entry_t
+		{
+			uint64_t m_nHash;
+			uint32_t m_nRVA;
+
+			bool operator<(const Entry_t &aOther) const
+			{
+				return m_nHash != aOther.m_nHash ? m_nHash < aOther.m_nHash : m_nRVA < aOther.m_nRVA;
+			}
+		}; // GameData::StringIndex::Entry_t
+
+		void FindMerged(const char *pszText, size_t nLength, std::vector<uintptr_t> &vecRVAs) const;
+
+	private:
+		const ModuleImage &m_aImage;
+
+		std::vector<Entry_t> m_vecEntries;
+	}; // GameData::StringIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_STRINGINDEX_HPP_
@@ -0,0 +1,73 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_SUFFIXINDEX_HPP_
+#define _INCLUDE_GAMEDATA_SUFFIXINDEX_HPP_
+
+#include <gamedata/image.hpp>
+#include <gamedata/pattern.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace GameData
+{
+	// A suffix array over the code segments of a module (built once, by SA-IS in linear time):
+	// a literal run of a pattern narrows the candidates down in O(m log n) instead of a scan.
+	class SuffixIndex
+	{
+	public:
+		explicit SuffixIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetSize() const;
+
+		// Matches in the code segments, counted up to nLimit.
+		size_t Count(const Pattern &aPattern, size_t nLimit) const;
+
+		// The shortest pattern matching at nRVA and nowhere else, of at most nMaxLength bytes.
+		// Branch and RIP-relative displacements, absolute addresses and 32/64-bit immediates
+		// are wildcarded, as those are what relocations and rebuilds change.
+		bool Generate(uintptr_t nRVA, size_t nMaxLength, Pattern &aResult) const;
+
+	protected:
+		struct Range_t
+		{
+			uintptr_t m_nRVA;
+			size_t m_nOffset;
+			size_t m_nSize;
+		}; // GameData::SuffixIndex::Range_t
+
+		const Range_t *FindRange(size_t nOffset) const;
+
+		// The suffixes starting with the nLength bytes, as [nLower, nUpper) of the array.
+		void Lookup(const uint8_t *pBytes, size_t nLength, size_t &nLower, size_t &nUpper) const;
+
+	private:
+		std::vector<Range_t> m_vecRanges;
+		std::vector<uint8_t> m_vecText;
+		std::vector<int32_t> m_vecSuffixes;
+	}; // GameData::SuffixIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_SUFFIXINDEX_HPP_
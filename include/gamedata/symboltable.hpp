@@ -0,0 +1,84 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_SYMBOLTABLE_HPP_
+#define _INCLUDE_GAMEDATA_SYMBOLTABLE_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace GameData
+{
+	// The exported symbols of a module, looked up through the hash tables the loader uses:
+	// .gnu.hash (or the SysV .hash) over .dynsym on ELF, the sorted name table of the
+	// export directory on PE. Nothing is built, the tables are only located once.
+	class SymbolTable
+	{
+	public:
+		explicit SymbolTable(const ModuleImage &aImage);
+
+	public:
+		bool IsAvailable() const;
+
+		// Defined symbols only; of versioned ELF ones, the default version.
+		bool Find(const char *pszName, uintptr_t &nRVA) const;
+
+	public: // ELF
+		bool FindDynamic(int64_t nTag, uint64_t &nValue) const;
+
+		// The name of the nIndex-th .dynsym entry, as relocations refer to symbols.
+		const char *GetName(uint32_t nIndex) const;
+
+		// Dynamic entries hold runtime addresses once relocated, link-time ones otherwise.
+		uintptr_t ToRVA(uint64_t nAddress) const;
+
+	protected:
+		void InitELF();
+		void InitPE();
+
+		bool FindGNU(const char *pszName, uintptr_t &nRVA) const;
+		bool FindSysV(const char *pszName, uintptr_t &nRVA) const;
+		bool FindExport(const char *pszName, uintptr_t &nRVA) const;
+
+		// Whether the nIndex-th .dynsym entry is a definition of pszName.
+		bool MatchSymbol(uint32_t nIndex, const char *pszName, uintptr_t &nRVA) const;
+
+	private:
+		const ModuleImage &m_aImage;
+
+		uintptr_t m_nDynamic;
+		size_t m_nDynamicSize;
+
+		uintptr_t m_nGNUHash;
+		uintptr_t m_nSysVHash;
+		uintptr_t m_nSymbols;
+		uintptr_t m_nStrings;
+		size_t m_nStringsSize;
+		uintptr_t m_nVersions;
+
+		uintptr_t m_nExports;
+		size_t m_nExportsSize;
+	}; // GameData::SymbolTable
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_SYMBOLTABLE_HPP_
@@ -0,0 +1,75 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_VTABLEINDEX_HPP_
+#define _INCLUDE_GAMEDATA_VTABLEINDEX_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GameData
+{
+	// The primary vtables of a module by class name, found through its RTTI: Itanium
+	// (type name -> typeinfo -> vtable) for ELF and Mach-O, MSVC (complete object
+	// locator -> type descriptor) for PE. Names are in source form ("CBaseEntity",
+	// "std::exception"); ones which do not decode (templates) stay mangled.
+	class VtableIndex
+	{
+	public:
+		explicit VtableIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+
+		// nRVA is the address point: the first virtual function slot.
+		bool Find(const char *pszClassName, uintptr_t &nRVA) const;
+
+	protected:
+		struct Pointer_t
+		{
+			uint32_t m_nTarget;
+			uint32_t m_nSource;
+
+			bool operator<(const Pointer_t &aOther) const
+			{
+				return m_nTarget != aOther.m_nTarget ? m_nTarget < aOther.m_nTarget : m_nSource < aOther.m_nSource;
+			}
+		}; // GameData::VtableIndex::Pointer_t
+
+		void IndexItanium(const ModuleImage &aImage, const std::vector<Pointer_t> &vecPointers);
+		void IndexMSVC(const ModuleImage &aImage, const std::vector<Pointer_t> &vecPointers);
+
+		static uint32_t SelectCompleteVtable(const ModuleImage &aImage, const std::vector<uint32_t> &vecCandidates);
+
+		void Add(std::string sName, uint32_t nRVA);
+
+	private:
+		std::unordered_map<std::string, uint32_t> m_mapVtables;
+	}; // GameData::VtableIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_VTABLEINDEX_HPP_
@@ -0,0 +1,79 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_XREFINDEX_HPP_
+#define _INCLUDE_GAMEDATA_XREFINDEX_HPP_
+
+#include <gamedata/image.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace GameData
+{
+	enum XrefKind : int
+	{
+		XREF_NONE = 0,
+
+		XREF_DATA = (1 << 0), // A RIP-relative memory operand (lea, mov, cmp, ...).
+		XREF_CALL = (1 << 1), // call rel32
+		XREF_JUMP = (1 << 2), // jmp rel32, tail calls included.
+
+		XREF_BRANCH = XREF_CALL | XREF_JUMP,
+		XREF_ALL = XREF_DATA | XREF_BRANCH,
+	}; // GameData::XrefKind
+
+	// The references of the code segments of a module, found by one linear sweep of the
+	// instruction decoder: by target (target -> sites) for all of them, and by site
+	// (site -> target) for the branches.
+	class XrefIndex
+	{
+	public:
+		struct Xref_t
+		{
+			uint32_t m_nTarget;
+			uint32_t m_nSource;
+			int m_nKind;
+		}; // GameData::XrefIndex::Xref_t
+
+	public:
+		explicit XrefIndex(const ModuleImage &aImage);
+
+	public:
+		size_t GetCount() const;
+
+		// Instructions of the given kinds referencing nTarget, ascending.
+		void FindReferences(uintptr_t nTarget, std::vector<uintptr_t> &vecSources, int nKinds = XREF_DATA) const;
+
+		// Targets of the calls from nRVA on, in site order, up to nEnd; with 0, up to the next
+		// function start known from the call graph (the lowest call target above nRVA).
+		void FindCallsFrom(uintptr_t nRVA, std::vector<uintptr_t> &vecTargets, uintptr_t nEnd = 0) const;
+
+	private:
+		std::vector<Xref_t> m_vecByTarget;
+		std::vector<Xref_t> m_vecBranchesBySource;
+		std::vector<uint32_t> m_vecCallTargets; // Unique, ascending.
+	}; // GameData::XrefIndex
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_XREFINDEX_HPP_
@@ -20,6 +20,23 @@
  */
 
 #include <gamedata.hpp>
+#include <gamedata/expression.hpp>
+#include <gamedata/functionhashindex.hpp>
+#include <gamedata/functionindex.hpp>
+#include <gamedata/importtable.hpp>
+#include <gamedata/interfaceindex.hpp>
+#include <gamedata/scanbroker.hpp>
+#include <gamedata/stringindex.hpp>
+#include <gamedata/symboltable.hpp>
+#include <gamedata/vtableindex.hpp>
+#include <gamedata/xrefindex.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 
 #include <tier0/commonmacros.h>
 #include <tier0/platform.h>
@@ -61,11 +78,66 @@ static CKV3MemberName s_aPlatformMemberNames[Platform::PLAT_MAX] =
 };
 
 static CKV3MemberName s_aLibraryMemberName = CKV3MemberName("library"), 
-                      s_aSignatureMemberName = CKV3MemberName("signature");
+                      s_aSignatureMemberName = CKV3MemberName("signature"),
+                      s_aStringMemberName = CKV3MemberName("string"),
+                      s_aReferenceMemberName = CKV3MemberName("reference"),
+                      s_aSymbolMemberName = CKV3MemberName("symbol"),
+                      s_aImportMemberName = CKV3MemberName("import"),
+                      s_aFunctionHashMemberName = CKV3MemberName("function_hash");
+
+static CKV3MemberName s_aAddressMemberName = CKV3MemberName("address"),
+                      s_aBytesMemberName = CKV3MemberName("bytes"),
+                      s_aExpectedMemberName = CKV3MemberName("expected");
+
+static CKV3MemberName s_aPatternMemberName = CKV3MemberName("pattern"),
+                      s_aMaxMemberName = CKV3MemberName("max"),
+                      s_aBackwardMemberName = CKV3MemberName("backward");
+
+static CKV3MemberName s_aSchemaMemberName = CKV3MemberName("schema"),
+                      s_aClassesMemberName = CKV3MemberName("classes"),
+                      s_aFieldsMemberName = CKV3MemberName("fields"),
+                      s_aParentMemberName = CKV3MemberName("parent"),
+                      s_aSizeMemberName = CKV3MemberName("size"),
+                      s_aTypeMemberName = CKV3MemberName("type");
+
+struct FieldTypeInfo_t
+{
+	const char *m_pszName;
+	uint32 m_nSize;
+};
+
+static const FieldTypeInfo_t s_aFieldTypes[GameData::FIELD_MAX] =
+{
+	{"bool", 1}, // GameData::FIELD_BOOL
+	{"int8", 1}, // GameData::FIELD_INT8
+	{"uint8", 1}, // GameData::FIELD_UINT8
+	{"int16", 2}, // GameData::FIELD_INT16
+	{"uint16", 2}, // GameData::FIELD_UINT16
+	{"int32", 4}, // GameData::FIELD_INT32
+	{"uint32", 4}, // GameData::FIELD_UINT32
+	{"int64", 8}, // GameData::FIELD_INT64
+	{"uint64", 8}, // GameData::FIELD_UINT64
+	{"float32", 4}, // GameData::FIELD_FLOAT32
+	{"float64", 8}, // GameData::FIELD_FLOAT64
+	{"pointer", sizeof(void *)}, // GameData::FIELD_POINTER
+	{"vector", 12}, // GameData::FIELD_VECTOR
+	{"qangle", 12}, // GameData::FIELD_QANGLE
+	{"handle", 4}, // GameData::FIELD_HANDLE
+};
+
+static CKV3MemberName s_aModulesMemberName = CKV3MemberName("modules"),
+                      s_aAddressesMemberName = CKV3MemberName("addresses"),
+                      s_aModuleMemberName = CKV3MemberName("module"),
+                      s_aRVAMemberName = CKV3MemberName("rva");
 
 DLL_IMPORT IVEngineServer *engine;
 DLL_IMPORT IServerGameDLL *server;
 
+const GameData::ModuleImage *IGameData::FindLibraryImage(const char *pszName) const
+{
+	return GameData::GetModuleImage(FindLibrary(pszName));
+}
+
 const CKV3MemberName &GameData::GetSourceEngineMemberName()
 {
 #if SOURCE_ENGINE == SE_CS2
@@ -119,10 +191,24 @@ ptrdiff_t GameData::ReadOffset(const char *pszValue)
 	return static_cast<ptrdiff_t>(strtol(pszValue, NULL, 0));
 }
 
+GameData::Config::Config()
+ :  m_ePlatform(GetCurrentPlatform()),
+    m_nRecoveryDistance(0),
+    m_bUseRecovered(false),
+    m_bSchemaLoaded(false),
+    m_mapModuleImages(DefLessFunc(const CUtlSymbolLarge))
+{
+}
+
 GameData::Config::Config(const Addresses &aAddressStorage, const Keys &aKeysStorage, const Offsets &aOffsetsStorage)
  :  m_aAddressStorage(aAddressStorage), 
     m_aKeysStorage(aKeysStorage), 
-    m_aOffsetStorage(aOffsetsStorage)
+    m_aOffsetStorage(aOffsetsStorage),
+    m_ePlatform(GetCurrentPlatform()),
+    m_nRecoveryDistance(0),
+    m_bUseRecovered(false),
+    m_bSchemaLoaded(false),
+    m_mapModuleImages(DefLessFunc(const CUtlSymbolLarge))
 {
 }
 
@@ -134,6 +220,17 @@ bool GameData::Config::Load(IGameData *pRoot, KeyValues3 *pGameConfig, CBufferSt
 
 	KeyValues3 *pEngineValues = pGameConfig->FindMember(aEngineMemberName);
 
+	// Patched bytes are not what "expected" describes, and a patch may be gone from the config.
+	if(m_aPatcher.GetAppliedCount())
+	{
+		RevertPatches(vecMessages);
+	}
+
+	// The images of modules unloaded since are freed by the root, look them up again.
+	m_mapLibraries.clear();
+	m_mapModuleImages.RemoveAll();
+	m_setLoadedAddresses.clear();
+
 	if(!pEngineValues)
 	{
 		const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszEngineKey, "\" section"};
@@ -149,8 +246,181 @@ bool GameData::Config::Load(IGameData *pRoot, KeyValues3 *pGameConfig, CBufferSt
 void GameData::Config::ClearValues()
 {
 	m_aAddressStorage.ClearValues();
+	m_aRelativeAddressStorage.ClearValues();
 	m_aKeysStorage.ClearValues();
 	m_aOffsetStorage.ClearValues();
+	m_aAnchorStorage.ClearValues();
+	m_aLayoutStorage.ClearValues();
+}
+
+bool GameData::Config::ExportRelativeAddresses(KeyValues3 *pData, CBufferStringVector &vecMessages) const
+{
+	KeyValues3 *pModulesValues = pData->FindOrCreateMember(s_aModulesMemberName);
+
+	KeyValues3 *pAddressesValues = pData->FindOrCreateMember(s_aAddressesMemberName);
+
+	pModulesValues->SetToEmptyTable();
+	pAddressesValues->SetToEmptyTable();
+
+	FOR_EACH_MAP_FAST(m_mapModuleImages, i)
+	{
+		const auto &sModule = m_mapModuleImages.Key(i);
+
+		const auto &aFingerprint = GetModuleFingerprint(m_mapModuleImages.Element(i));
+
+		if(!aFingerprint.IsValid())
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "fingerprint ", "of \"", sModule.String(), "\" library"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+
+			continue;
+		}
+
+		char szFingerprint[MAX_GAMEDATA_FINGERPRINT_STRING_LENGTH];
+
+		pModulesValues->FindOrCreateMember(sModule.String())->SetString(aFingerprint.ToString(szFingerprint, sizeof(szFingerprint)));
+	}
+
+	const auto &mapRelatives = m_aRelativeAddressStorage.m_mapValues;
+
+	FOR_EACH_MAP_FAST(mapRelatives, i)
+	{
+		const auto &sName = mapRelatives.Key(i);
+
+		const auto &aRelative = mapRelatives.Element(i);
+
+		KeyValues3 *pAddressValues = pAddressesValues->FindOrCreateMember(sName.String());
+
+		pAddressValues->SetToEmptyTable();
+		pAddressValues->FindOrCreateMember(s_aModuleMemberName)->SetString(aRelative.m_sModule.String());
+		pAddressValues->FindOrCreateMember(s_aRVAMemberName)->SetUInt64(aRelative.m_nRVA);
+	}
+
+	return true;
+}
+
+bool GameData::Config::ImportRelativeAddresses(IGameData *pRoot, KeyValues3 *pData, CBufferStringVector &vecMessages)
+{
+	KeyValues3 *pModulesValues = pData->FindMember(s_aModulesMemberName);
+
+	KeyValues3 *pAddressesValues = pData->FindMember(s_aAddressesMemberName);
+
+	if(!pModulesValues || !pAddressesValues)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", s_aModulesMemberName.GetString(), "\" or \"", s_aAddressesMemberName.GetString(), "\" section"};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	bool bResult = true;
+
+	// Verify modules first: a changed binary invalidates all of its RVAs.
+	CUtlMap<CUtlSymbolLarge, const ModuleImage *> mapImages(DefLessFunc(const CUtlSymbolLarge));
+
+	for(KV3MemberId_t i = 0, iMemberCount = pModulesValues->GetMemberCount(); i < iMemberCount; i++)
+	{
+		const char *pszLibraryName = pModulesValues->GetMemberName(i);
+
+		const char *pszFingerprint = pModulesValues->GetMember(i)->GetString("");
+
+		const auto *pLibImage = pRoot->FindLibraryImage(pszLibraryName);
+
+		if(!pLibImage)
+		{
+			const char *pszMessageConcat[] = {"Unknown \"", pszLibraryName, "\" library"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			bResult = false;
+
+			continue;
+		}
+
+		Fingerprint aExpected;
+
+		if(!aExpected.FromString(pszFingerprint))
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "parse ", "\"", pszFingerprint, "\" fingerprint ", "of \"", pszLibraryName, "\" library"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			bResult = false;
+
+			continue;
+		}
+
+		if(GetModuleFingerprint(pLibImage) != aExpected)
+		{
+			const char *pszMessageConcat[] = {"Fingerprint ", "of \"", pszLibraryName, "\" library ", "has changed"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			bResult = false;
+
+			continue;
+		}
+
+		mapImages.Insert(GetSymbol(pszLibraryName), pLibImage);
+	}
+
+	for(KV3MemberId_t i = 0, iMemberCount = pAddressesValues->GetMemberCount(); i < iMemberCount; i++)
+	{
+		const char *pszAddressName = pAddressesValues->GetMemberName(i);
+
+		KeyValues3 *pAddressValues = pAddressesValues->GetMember(i);
+
+		KeyValues3 *pModuleValues = pAddressValues->FindMember(s_aModuleMemberName);
+
+		KeyValues3 *pRVAValues = pAddressValues->FindMember(s_aRVAMemberName);
+
+		if(!pModuleValues || !pRVAValues)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "\"", s_aModuleMemberName.GetString(), "\" or \"", s_aRVAMemberName.GetString(), "\" key ", "at \"", pszAddressName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			bResult = false;
+
+			continue;
+		}
+
+		const char *pszModuleName = pModuleValues->GetString("");
+
+		auto iFound = mapImages.Find(FindSymbol(pszModuleName));
+
+		if(!IS_VALID_GAMEDATA_INDEX(mapImages, iFound))
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "import ", "\"", pszAddressName, "\" address: ", "\"", pszModuleName, "\" module ", "is not verified"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			bResult = false;
+
+			continue;
+		}
+
+		const auto sModule = mapImages.Key(iFound);
+
+		const auto *pLibImage = mapImages.Element(iFound);
+
+		uintp nRVA = pRVAValues->GetUInt64();
+
+		if(!pLibImage->ContainsRVA(nRVA))
+		{
+			const char *pszMessageConcat[] = {"Out of ", "\"", sModule.String(), "\" library ", "at \"", pszAddressName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			bResult = false;
+
+			continue;
+		}
+
+		const auto sAddressName = GetSymbol(pszAddressName);
+
+		AddModuleImage(sModule, pLibImage);
+		SetAddress(sAddressName, pLibImage->FromRVA(nRVA));
+		SetRelativeAddress(sAddressName, {sModule, nRVA});
+	}
+
+	return bResult;
 }
 
 GameData::Config::Addresses &GameData::Config::GetAddresses()
@@ -158,6 +428,11 @@ GameData::Config::Addresses &GameData::Config::GetAddresses()
 	return m_aAddressStorage;
 }
 
+GameData::Config::RelativeAddresses &GameData::Config::GetRelativeAddresses()
+{
+	return m_aRelativeAddressStorage;
+}
+
 GameData::Config::Keys &GameData::Config::GetKeys()
 {
 	return m_aKeysStorage;
@@ -168,6 +443,55 @@ GameData::Config::Offsets &GameData::Config::GetOffsets()
 	return m_aOffsetStorage;
 }
 
+GameData::Config::Anchors &GameData::Config::GetAnchors()
+{
+	return m_aAnchorStorage;
+}
+
+GameData::Config::Layouts &GameData::Config::GetLayouts()
+{
+	return m_aLayoutStorage;
+}
+
+GameData::Platform GameData::Config::GetPlatform() const
+{
+	return m_ePlatform;
+}
+
+void GameData::Config::SetPlatform(Platform eValue)
+{
+	m_ePlatform = eValue;
+}
+
+void GameData::Config::SetSignatureRecovery(size_t nMaxDistance, bool bUseRecovered)
+{
+	m_nRecoveryDistance = nMaxDistance;
+	m_bUseRecovered = bUseRecovered;
+}
+
+bool GameData::Config::RevertPatches(CBufferStringVector &vecMessages)
+{
+	std::string sError;
+
+	if(!m_aPatcher.Revert(sError))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "revert ", "patches: ", sError.c_str()};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	return true;
+}
+
+void GameData::Config::SetSchemaDump(const char *pszPath)
+{
+	m_sSchemaDump = pszPath;
+	m_bSchemaLoaded = false;
+	m_aSchema.Clear();
+}
+
 bool GameData::Config::LoadEngine(IGameData *pRoot, KeyValues3 *pEngineValues, CBufferStringVector &vecMessages)
 {
 	struct
@@ -180,6 +504,14 @@ bool GameData::Config::LoadEngine(IGameData *pRoot, KeyValues3 *pEngineValues, C
 			"Signatures",
 			&GameData::Config::LoadEngineSignatures
 		},
+		{
+			"Vtables",
+			&GameData::Config::LoadEngineVtables
+		},
+		{
+			"Interfaces",
+			&GameData::Config::LoadEngineInterfaces
+		},
 		{
 			"Keys",
 			&GameData::Config::LoadEngineKeys
@@ -191,6 +523,10 @@ bool GameData::Config::LoadEngine(IGameData *pRoot, KeyValues3 *pEngineValues, C
 		{
 			"Addresses",
 			&GameData::Config::LoadEngineAddresses
+		},
+		{
+			"Patches",
+			&GameData::Config::LoadEnginePatches
 		}
 	};
 
@@ -204,11 +540,27 @@ bool GameData::Config::LoadEngine(IGameData *pRoot, KeyValues3 *pEngineValues, C
 
 		KeyValues3 *pEngineMember = pEngineValues->FindMember(aSectionMember);
 
-		if(pEngineMember && !(this->*(aSections[n].pfnLoadOne))(pRoot, pEngineMember, vecSubMessages))
+		if(!pEngineMember)
 		{
-			const char *pszMessageConcat[] = {"Failed to ", "load \"", aSectionMember.GetString(), "\" section:"};
+			continue;
+		}
 
-			vecMessages.AddToTail(pszMessageConcat);
+		bool bLoaded = (this->*(aSections[n].pfnLoadOne))(pRoot, pEngineMember, vecSubMessages);
+
+		// A loaded section may still have entries which did not resolve.
+		if(!bLoaded || vecSubMessages.Count())
+		{
+			const char *pszFailedConcat[] = {"Failed to ", "load \"", aSectionMember.GetString(), "\" section:"};
+			const char *pszPartialConcat[] = {"In \"", aSectionMember.GetString(), "\" section:"};
+
+			if(bLoaded)
+			{
+				vecMessages.AddToTail(pszPartialConcat);
+			}
+			else
+			{
+				vecMessages.AddToTail(pszFailedConcat);
+			}
 
 			FOR_EACH_VEC(vecSubMessages, i)
 			{
@@ -218,6 +570,8 @@ bool GameData::Config::LoadEngine(IGameData *pRoot, KeyValues3 *pEngineValues, C
 
 				vecMessages.AddToTail(pszSubMessageConcat);
 			}
+
+			vecSubMessages.Purge();
 		}
 	}
 
@@ -243,10 +597,23 @@ bool GameData::Config::LoadEngineSignatures(IGameData *pRoot, KeyValues3 *pSigna
 
 	const char *pszLibraryKey = aLibraryMemberName.GetString();
 
-	const auto &aPlatformMemberName = GameData::GetCurrentPlatformMemberName();
+	const auto &aPlatformMemberName = GameData::GetPlatformMemberName(m_ePlatform);
 
 	const char *pszPlatformKey = aPlatformMemberName.GetString();
 
+	struct SignatureEntry_t
+	{
+		const char *m_pszName;
+		CUtlSymbolLarge m_sLibrary;
+		const Library_t *m_pLibrary;
+		const char *m_pszSignature;
+		const char *m_pszString; // Instead of the signature: a reference to this string literal.
+		int m_iReference;
+		const char *m_pszSymbol; // Before the signature: an exported symbol, the signature is the fallback.
+	};
+
+	CUtlVector<SignatureEntry_t> vecEntries;
+
 	do
 	{
 		KeyValues3 *pSigSection = pSignaturesValues->GetMember(i);
@@ -267,9 +634,11 @@ bool GameData::Config::LoadEngineSignatures(IGameData *pRoot, KeyValues3 *pSigna
 
 		const char *pszLibraryName = pLibraryValues->GetString("<none>");
 
-		const auto *pLibModule = pRoot->FindLibrary(pszLibraryName);
+		const auto sLibrary = GetSymbol(pszLibraryName);
+
+		const auto *pLibrary = FindLibrary(pRoot, sLibrary);
 
-		if(!pLibModule)
+		if(!pLibrary)
 		{
 			const char *pszMessageConcat[] = {"Unknown \"", pszLibraryName, "\" library ", "at \"", pszSigName, "\""};
 
@@ -279,25 +648,35 @@ bool GameData::Config::LoadEngineSignatures(IGameData *pRoot, KeyValues3 *pSigna
 			continue;
 		}
 
-		KeyValues3 *pPlatformValues = pSigSection->FindMember(aPlatformMemberName);
+		KeyValues3 *pStringValues = pSigSection->FindMember(s_aStringMemberName);
 
-		if(!pPlatformValues)
+		if(pStringValues)
 		{
-			const char *pszMessageConcat[] = {"Failed to ", "get ", "platform ", "(\"", pszPlatformKey, "\" key) ", "at \"", pszSigName, "\""};
+			KeyValues3 *pReferenceValues = pSigSection->FindMember(s_aReferenceMemberName);
 
-			vecMessages.AddToTail(pszMessageConcat);
+			vecEntries.AddToTail({pszSigName, sLibrary, pLibrary, nullptr, pStringValues->GetString(), pReferenceValues ? pReferenceValues->GetInt() : 0, nullptr});
 			i++;
 
 			continue;
 		}
 
-		const char *pszSignature = pPlatformValues->GetString();
+		KeyValues3 *pSymbolValues = pSigSection->FindMember(s_aSymbolMemberName);
+
+		const char *pszSymbol = pSymbolValues ? pSymbolValues->GetString() : nullptr;
+
+		KeyValues3 *pPlatformValues = pSigSection->FindMember(aPlatformMemberName);
+
+		if(!pPlatformValues && pszSymbol)
+		{
+			vecEntries.AddToTail({pszSigName, sLibrary, pLibrary, nullptr, nullptr, 0, pszSymbol});
+			i++;
 
-		const auto pSigResult = pLibModule->FindPattern(pszSignature);
+			continue;
+		}
 
-		if(!pSigResult)
+		if(!pPlatformValues)
 		{
-			const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszSigName, "\""};
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "platform ", "(\"", pszPlatformKey, "\" key) ", "at \"", pszSigName, "\""};
 
 			vecMessages.AddToTail(pszMessageConcat);
 			i++;
@@ -305,107 +684,1046 @@ bool GameData::Config::LoadEngineSignatures(IGameData *pRoot, KeyValues3 *pSigna
 			continue;
 		}
 
-		SetAddress(GetSymbol(pszSigName), pSigResult);
+		vecEntries.AddToTail({pszSigName, sLibrary, pLibrary, pPlatformValues->GetString(), nullptr, 0, pszSymbol});
 
 		i++;
 	}
 	while(i < iMemberCount);
 
-	return true;
-}
-
-bool GameData::Config::LoadEngineKeys(IGameData *pRoot, KeyValues3 *pKeysValues, CBufferStringVector &vecMessages)
-{
-	int iMemberCount = pKeysValues->GetMemberCount();
-
-	if(!iMemberCount)
+	// Group by module, so per-module state stays hot while its signatures resolve.
+	std::stable_sort(vecEntries.Base(), vecEntries.Base() + vecEntries.Count(), [](const SignatureEntry_t &aLeft, const SignatureEntry_t &aRight)
 	{
-		static const char *s_pszMessageConcat[] = {"Keys section is empty"};
+		return aLeft.m_pLibrary->m_pImage != aRight.m_pLibrary->m_pImage ? aLeft.m_pLibrary->m_pImage < aRight.m_pLibrary->m_pImage
+		                                                                 : aLeft.m_pLibrary->m_pModule < aRight.m_pLibrary->m_pModule;
+	});
 
-		vecMessages.AddToTail(s_pszMessageConcat);
+	FOR_EACH_VEC(vecEntries, j)
+	{
+		const auto &aEntry = vecEntries[j];
 
-		return false;
-	}
+		const char *pszSigName = aEntry.m_pszName;
 
-	KV3MemberId_t i = 0;
+		if(aEntry.m_pszString)
+		{
+			const auto *pLibImage = aEntry.m_pLibrary->m_pImage;
 
-	const auto &aPlatformMemberName = GameData::GetCurrentPlatformMemberName();
+			if(!pLibImage)
+			{
+				const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszSigName, "\": ", "string references need a parsed module"};
 
-	const char *pszPlatformKey = aPlatformMemberName.GetString();
+				vecMessages.AddToTail(pszMessageConcat);
 
-	do
-	{
-		KeyValues3 *pKeySection = pKeysValues->GetMember(i);
+				continue;
+			}
 
-		const char *pszKeyName = pKeysValues->GetMemberName(i);
+			uintptr_t nRVA;
 
-		KeyValues3 *pPlatformValues = pKeySection->FindMember(aPlatformMemberName);
+			if(!FindStringReference(pszSigName, pLibImage, aEntry.m_pszString, aEntry.m_iReference, nRVA, vecMessages))
+			{
+				continue;
+			}
 
-		if(!pPlatformValues)
-		{
-			const char *pszMessageConcat[] = {"Failed to ", "get ", " platform ", "(\"", pszPlatformKey, "\" key)", "at \"", pszKeyName, "\""};
+			const auto sSigName = GetSymbol(pszSigName);
 
-			vecMessages.AddToTail(pszMessageConcat);
-			i++;
+			SetAddress(sSigName, pLibImage->FromRVA(nRVA));
+			SetRelativeAddress(sSigName, {aEntry.m_sLibrary, nRVA});
 
 			continue;
 		}
 
-		SetKey(GetSymbol(pszKeyName), pPlatformValues->GetString());
+		if(aEntry.m_pszSymbol)
+		{
+			const auto *pLibImage = aEntry.m_pLibrary->m_pImage;
 
-		i++;
-	}
-	while(i < iMemberCount);
+			uintptr_t nRVA;
 
-	return true;
-}
+			// A hash lookup; the signature is scanned for only when the symbol is gone.
+			if(pLibImage && pLibImage->GetIndex<SymbolTable>().Find(aEntry.m_pszSymbol, nRVA))
+			{
+				const auto sSigName = GetSymbol(pszSigName);
 
-bool GameData::Config::LoadEngineOffsets(IGameData *pRoot, KeyValues3 *pOffsetsValues, CBufferStringVector &vecMessages)
-{
-	int iMemberCount = pOffsetsValues->GetMemberCount();
+				SetAddress(sSigName, pLibImage->FromRVA(nRVA));
+				SetRelativeAddress(sSigName, {aEntry.m_sLibrary, nRVA});
 
-	if(!iMemberCount)
-	{
-		static const char *s_pszMessageConcat[] = {"Offsets section is empty"};
+				continue;
+			}
 
-		vecMessages.AddToTail(s_pszMessageConcat);
+			if(!aEntry.m_pszSignature)
+			{
+				const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", aEntry.m_pszSymbol, "\" symbol ", "at \"", pszSigName, "\""};
 
-		return false;
-	}
+				vecMessages.AddToTail(pszMessageConcat);
 
-	KV3MemberId_t i = 0;
+				continue;
+			}
+		}
 
-	const auto &aPlatformMemberName = GameData::GetCurrentPlatformMemberName();
+		Pattern aPattern;
 
-	const char *pszPlatformKey = aPlatformMemberName.GetString();
+		if(!aPattern.Compile(aEntry.m_pszSignature))
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "compile ", "\"", pszSigName, "\" signature"};
 
-	do
-	{
-		KeyValues3 *pOffsetSection = pOffsetsValues->GetMember(i);
+			vecMessages.AddToTail(pszMessageConcat);
 
-		const char *pszOffsetName = pOffsetsValues->GetMemberName(i);
+			continue;
+		}
 
-		KeyValues3 *pPlatformValues = pOffsetSection->FindMember(aPlatformMemberName);
+		const auto *pLibModule = aEntry.m_pLibrary->m_pModule;
+
+		const auto *pLibImage = aEntry.m_pLibrary->m_pImage;
+
+		const auto sSigName = GetSymbol(pszSigName);
+
+		if(!pLibImage)
+		{
+			// Not a format we can parse: scan without the broker, absolute address only.
+			const auto pSigResult = pLibModule->FindPattern(aEntry.m_pszSignature);
+
+			if(!pSigResult)
+			{
+				const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszSigName, "\""};
+
+				vecMessages.AddToTail(pszMessageConcat);
+
+				continue;
+			}
+
+			SetAddress(sSigName, pSigResult);
+
+			continue;
+		}
+
+		// Memoized per module: the first signature of a module profiles it.
+		const auto aAnchor = pLibImage->GetIndex<ByteProfile>().SelectAnchor(aPattern);
+
+		aPattern.SetAnchor(aAnchor.m_nOffset, aAnchor.m_nCompanion);
+		SetAnchor(sSigName, aAnchor);
+
+		const auto aScanResult = GetScanBroker()->Scan(pLibImage, aPattern);
+
+		uintptr_t nRVA = aScanResult.m_nRVA;
+
+		if(!aScanResult.m_bFound && !RecoverSignature(pszSigName, pLibImage, aPattern, nRVA, vecMessages))
+		{
+			continue;
+		}
+
+		SetAddress(sSigName, pLibImage->FromRVA(nRVA));
+		SetRelativeAddress(sSigName, {aEntry.m_sLibrary, nRVA});
+	}
+
+	return true;
+}
+
+bool GameData::Config::RecoverSignature(const char *pszSigName, const ModuleImage *pImage, const Pattern &aPattern, uintptr_t &nRVA, CBufferStringVector &vecMessages)
+{
+	Pattern::Approximate_t aApproximate;
+
+	if(!m_nRecoveryDistance || !aPattern.FindApproximate(*pImage, m_nRecoveryDistance, aApproximate))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszSigName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	bool bAmbiguous = aApproximate.m_nCandidates > 1,
+	     bUse = m_bUseRecovered && !bAmbiguous;
+
+	char szDetails[96];
+
+	snprintf(szDetails, sizeof(szDetails), "at 0x%llX, %zu of %zu bytes differ%s", static_cast<unsigned long long>(aApproximate.m_nRVA),
+	         aApproximate.m_nDistance, aPattern.GetLiteralCount(), bAmbiguous ? ", ambiguous" : "");
+
+	const auto sSuggested = aPattern.WithBytes(pImage->GetPointer(aApproximate.m_nRVA)).ToString();
+
+	const char *pszMessageConcat[] = {bUse ? "Recovered " : "Failed to find ", "\"", pszSigName, "\" ", bUse ? "" : "(closest ", szDetails, bUse ? "" : ")", ", suggested: ", sSuggested.c_str()};
+
+	vecMessages.AddToTail(pszMessageConcat);
+
+	if(!bUse)
+	{
+		return false;
+	}
+
+	nRVA = aApproximate.m_nRVA;
+
+	return true;
+}
+
+bool GameData::Config::FindStringReference(const char *pszSigName, const ModuleImage *pImage, const char *pszText, int iReference, uintptr_t &nRVA, CBufferStringVector &vecMessages)
+{
+	std::vector<uintptr_t> vecStrings;
+
+	// Both indexes are built on the first string entry of a module and shared by the rest.
+	pImage->GetIndex<StringIndex>().Find(pszText, vecStrings);
+
+	if(vecStrings.empty())
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszText, "\" string ", "at \"", pszSigName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	const auto &aXrefs = pImage->GetIndex<XrefIndex>();
+
+	std::vector<uintptr_t> vecReferences, vecSources;
+
+	for(uintptr_t nString : vecStrings)
+	{
+		aXrefs.FindReferences(nString, vecSources);
+		vecReferences.insert(vecReferences.end(), vecSources.begin(), vecSources.end());
+	}
+
+	std::sort(vecReferences.begin(), vecReferences.end());
+
+	if(iReference < 0 || static_cast<size_t>(iReference) >= vecReferences.size())
+	{
+		char szReference[16], szCount[16];
+
+		snprintf(szReference, sizeof(szReference), "%d", iReference);
+		snprintf(szCount, sizeof(szCount), "%zu", vecReferences.size());
+
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "reference #", szReference, " to \"", pszText, "\" string ", "(", szCount, " found) ", "at \"", pszSigName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	nRVA = vecReferences[iReference];
+
+	return true;
+}
+
+const GameData::ModuleImage *GameData::Config::LoadEngineLibraryImage(IGameData *pRoot, const char *pszEntryName, KeyValues3 *pEntryValues, CUtlSymbolLarge &sLibrary, CBufferStringVector &vecMessages)
+{
+	const auto &aLibraryMemberName = s_aLibraryMemberName;
+
+	const char *pszLibraryKey = aLibraryMemberName.GetString();
+
+	KeyValues3 *pLibraryValues = pEntryValues->FindMember(aLibraryMemberName);
+
+	if(!pLibraryValues)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "get ", "\"", pszLibraryKey, "\" key ", "at \"", pszEntryName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return nullptr;
+	}
+
+	const char *pszLibraryName = pLibraryValues->GetString("<none>");
+
+	sLibrary = GetSymbol(pszLibraryName);
+
+	const auto *pLibrary = FindLibrary(pRoot, sLibrary);
+
+	if(!pLibrary)
+	{
+		const char *pszMessageConcat[] = {"Unknown \"", pszLibraryName, "\" library ", "at \"", pszEntryName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return nullptr;
+	}
+
+	if(!pLibrary->m_pImage)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszEntryName, "\": ", "\"", pszLibraryName, "\" library ", "is not a parsed module"};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return nullptr;
+	}
+
+	return pLibrary->m_pImage;
+}
+
+bool GameData::Config::LoadEngineVtables(IGameData *pRoot, KeyValues3 *pVtablesValues, CBufferStringVector &vecMessages)
+{
+	int iMemberCount = pVtablesValues->GetMemberCount();
+
+	if(!iMemberCount)
+	{
+		static const char *s_pszMessageConcat[] = {"Section is empty"};
+
+		vecMessages.AddToTail(s_pszMessageConcat);
+
+		return false;
+	}
+
+	KV3MemberId_t i = 0;
+
+	do
+	{
+		KeyValues3 *pVtableSection = pVtablesValues->GetMember(i);
+
+		const char *pszClassName = pVtablesValues->GetMemberName(i);
+
+		CUtlSymbolLarge sLibrary;
+
+		const auto *pLibImage = LoadEngineLibraryImage(pRoot, pszClassName, pVtableSection, sLibrary, vecMessages);
+
+		if(!pLibImage)
+		{
+			i++;
+
+			continue;
+		}
+
+		uintptr_t nRVA;
+
+		// One RTTI walk per module, shared by all of its classes.
+		if(!pLibImage->GetIndex<VtableIndex>().Find(pszClassName, nRVA))
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "find ", "a vtable ", "of \"", pszClassName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		const auto sClassName = GetSymbol(pszClassName);
+
+		SetAddress(sClassName, pLibImage->FromRVA(nRVA));
+		SetRelativeAddress(sClassName, {sLibrary, nRVA});
+
+		i++;
+	}
+	while(i < iMemberCount);
+
+	return true;
+}
+
+bool GameData::Config::LoadEngineInterfaces(IGameData *pRoot, KeyValues3 *pInterfacesValues, CBufferStringVector &vecMessages)
+{
+	int iMemberCount = pInterfacesValues->GetMemberCount();
+
+	if(!iMemberCount)
+	{
+		static const char *s_pszMessageConcat[] = {"Section is empty"};
+
+		vecMessages.AddToTail(s_pszMessageConcat);
+
+		return false;
+	}
+
+	KV3MemberId_t i = 0;
+
+	do
+	{
+		KeyValues3 *pInterfaceSection = pInterfacesValues->GetMember(i);
+
+		const char *pszVersion = pInterfacesValues->GetMemberName(i);
+
+		CUtlSymbolLarge sLibrary;
+
+		const auto *pLibImage = LoadEngineLibraryImage(pRoot, pszVersion, pInterfaceSection, sLibrary, vecMessages);
+
+		if(!pLibImage)
+		{
+			i++;
+
+			continue;
+		}
+
+		// One list walk per module, shared by all of its interfaces.
+		const auto &aInterfaces = pLibImage->GetIndex<InterfaceIndex>();
+
+		const auto *pInterface = aInterfaces.Find(pszVersion);
+
+		if(!pInterface)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszVersion, "\" interface"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		const auto sVersion = GetSymbol(pszVersion);
+
+		if(pInterface->m_nInstance)
+		{
+			SetAddress(sVersion, pLibImage->FromRVA(pInterface->m_nInstance));
+			SetRelativeAddress(sVersion, {sLibrary, pInterface->m_nInstance});
+		}
+		else if(pLibImage->IsLive())
+		{
+			// Shared with every load of the module, so reloading a config does not construct another one.
+			void *pInstance = aInterfaces.Instantiate(*pLibImage, *pInterface);
+
+			SetAddress(sVersion, pInstance);
+
+			RelativeAddress_t aRelative;
+
+			if(FindModuleByAddress(reinterpret_cast<uintptr_t>(pInstance), aRelative))
+			{
+				SetRelativeAddress(sVersion, aRelative);
+			}
+		}
+		else
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "create ", "\"", pszVersion, "\" interface: ", "not a static object, and the module is not loaded here"};
+
+			vecMessages.AddToTail(pszMessageConcat);
+		}
+
+		i++;
+	}
+	while(i < iMemberCount);
+
+	return true;
+}
+
+bool GameData::Config::LoadEngineKeys(IGameData *pRoot, KeyValues3 *pKeysValues, CBufferStringVector &vecMessages)
+{
+	int iMemberCount = pKeysValues->GetMemberCount();
+
+	if(!iMemberCount)
+	{
+		static const char *s_pszMessageConcat[] = {"Keys section is empty"};
+
+		vecMessages.AddToTail(s_pszMessageConcat);
+
+		return false;
+	}
+
+	KV3MemberId_t i = 0;
+
+	const auto &aPlatformMemberName = GameData::GetPlatformMemberName(m_ePlatform);
+
+	const char *pszPlatformKey = aPlatformMemberName.GetString();
+
+	do
+	{
+		KeyValues3 *pKeySection = pKeysValues->GetMember(i);
+
+		const char *pszKeyName = pKeysValues->GetMemberName(i);
+
+		KeyValues3 *pPlatformValues = pKeySection->FindMember(aPlatformMemberName);
+
+		if(!pPlatformValues)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", " platform ", "(\"", pszPlatformKey, "\" key)", "at \"", pszKeyName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		SetKey(GetSymbol(pszKeyName), pPlatformValues->GetString());
+
+		i++;
+	}
+	while(i < iMemberCount);
+
+	return true;
+}
+
+bool GameData::Config::LoadEngineOffsets(IGameData *pRoot, KeyValues3 *pOffsetsValues, CBufferStringVector &vecMessages)
+{
+	int iMemberCount = pOffsetsValues->GetMemberCount();
+
+	if(!iMemberCount)
+	{
+		static const char *s_pszMessageConcat[] = {"Offsets section is empty"};
+
+		vecMessages.AddToTail(s_pszMessageConcat);
+
+		return false;
+	}
+
+	KV3MemberId_t i = 0;
+
+	const auto &aPlatformMemberName = GameData::GetPlatformMemberName(m_ePlatform);
+
+	const char *pszPlatformKey = aPlatformMemberName.GetString();
+
+	std::vector<std::pair<const char *, const char *>> vecPending; // Expressions referring to offsets further down.
+	std::vector<std::pair<const char *, KeyValues3 *>> vecLayouts; // After every offset, for their expressions.
+
+	do
+	{
+		KeyValues3 *pOffsetSection = pOffsetsValues->GetMember(i);
+
+		const char *pszOffsetName = pOffsetsValues->GetMemberName(i);
+
+		if(pOffsetSection->FindMember(s_aFieldsMemberName))
+		{
+			vecLayouts.emplace_back(pszOffsetName, pOffsetSection);
+			i++;
+
+			continue;
+		}
+
+		KeyValues3 *pSchemaValues = pOffsetSection->FindMember(s_aSchemaMemberName);
+
+		if(pSchemaValues)
+		{
+			const char *pszFieldName = pSchemaValues->GetString();
+
+			ptrdiff_t nOffset;
+
+			if(!LoadSchemaDump(vecMessages) || !m_aSchema.Find(pszFieldName, nOffset))
+			{
+				const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszFieldName, "\" schema field ", "at \"", pszOffsetName, "\""};
+
+				vecMessages.AddToTail(pszMessageConcat);
+				i++;
+
+				continue;
+			}
+
+			SetOffset(GetSymbol(pszOffsetName), nOffset);
+			i++;
+
+			continue;
+		}
+
+		KeyValues3 *pPlatformValues = pOffsetSection->FindMember(aPlatformMemberName);
 
 		if(!pPlatformValues)
 		{
-			const char *pszMessageConcat[] = {"Failed to ", "get ", " platform ", "(\"", pszPlatformKey, "\" key)", "at \"", pszOffsetName, "\""};
+			const char *pszMessageConcat[] = {"Failed to ", "get ", " platform ", "(\"", pszPlatformKey, "\" key)", "at \"", pszOffsetName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		if(pPlatformValues->GetType() != KV3_TYPE_STRING)
+		{
+			SetOffset(GetSymbol(pszOffsetName), pPlatformValues->GetUInt64());
+			i++;
+
+			continue;
+		}
+
+		vecPending.emplace_back(pszOffsetName, pPlatformValues->GetString());
+		i++;
+	}
+	while(i < iMemberCount);
+
+	for(const auto &it : vecPending)
+	{
+		m_setPendingOffsets.insert(GetSymbol(it.first).String());
+	}
+
+	// Folded in passes, so an expression may refer to any entry of the section. The pass which
+	// makes no progress reports what is left.
+	for(size_t nPrevious = 0; !vecPending.empty(); )
+	{
+		bool bLast = nPrevious == vecPending.size();
+
+		nPrevious = vecPending.size();
+
+		for(auto it = vecPending.begin(); it != vecPending.end(); )
+		{
+			ptrdiff_t nValue;
+
+			std::string sError;
+
+			bool bUnresolved;
+
+			if(ReadExpression(it->second, nValue, sError, &bUnresolved))
+			{
+				const auto sOffset = GetSymbol(it->first);
+
+				SetOffset(sOffset, nValue);
+				m_setPendingOffsets.erase(sOffset.String());
+				it = vecPending.erase(it);
+
+				continue;
+			}
+
+			if(bLast || !bUnresolved)
+			{
+				const char *pszMessageConcat[] = {"Failed to ", "evaluate ", "\"", it->first, "\" offset: ", sError.c_str()};
+
+				vecMessages.AddToTail(pszMessageConcat);
+				it = vecPending.erase(it);
+
+				continue;
+			}
+
+			++it;
+		}
+	}
+
+	// Failed ones keep the value of a previous Load, as any other entry of the section.
+	m_setPendingOffsets.clear();
+
+	for(const auto &it : vecLayouts)
+	{
+		LoadEngineLayout(it.first, it.second, vecMessages);
+	}
+
+	return true;
+}
+
+bool GameData::Config::LoadEnginePatches(IGameData *pRoot, KeyValues3 *pPatchesValues, CBufferStringVector &vecMessages)
+{
+	int iMemberCount = pPatchesValues->GetMemberCount();
+
+	if(!iMemberCount)
+	{
+		static const char *s_pszMessageConcat[] = {"Patches section is empty"};
+
+		vecMessages.AddToTail(s_pszMessageConcat);
+
+		return false;
+	}
+
+	KV3MemberId_t i = 0;
+
+	const auto &aPlatformMemberName = GameData::GetPlatformMemberName(m_ePlatform);
+
+	do
+	{
+		KeyValues3 *pPatchSection = pPatchesValues->GetMember(i);
+
+		const char *pszPatchName = pPatchesValues->GetMemberName(i);
+
+		KeyValues3 *pAddressValues = pPatchSection->FindMember(s_aAddressMemberName);
+
+		const auto sAddress = pAddressValues ? FindSymbol(pAddressValues->GetString()) : CUtlSymbolLarge();
+
+		// Not a value left by a previous Load, the module may have moved since.
+		const DynLibUtils::CMemory *pAddress = sAddress.IsValid() && m_setLoadedAddresses.count(sAddress.String()) ? m_aAddressStorage.Find(sAddress) : nullptr;
+
+		if(!pAddress || !*pAddress)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "the \"", s_aAddressMemberName.GetString(), "\" ", "of \"", pszPatchName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		// "<bytes>", or { "bytes": "<bytes>", "expected": "<pattern>" }; by platform or for all of them.
+		KeyValues3 *pPlatformValues = pPatchSection->FindMember(aPlatformMemberName);
+
+		KeyValues3 *pValues = pPlatformValues ? pPlatformValues : pPatchSection;
+
+		KeyValues3 *pBytesValues = pValues->GetType() == KV3_TYPE_STRING ? pValues : pValues->FindMember(s_aBytesMemberName);
+
+		KeyValues3 *pExpectedValues = pValues->GetType() == KV3_TYPE_STRING ? nullptr : pValues->FindMember(s_aExpectedMemberName);
+
+		Pattern aBytes;
+
+		if(!pBytesValues || !aBytes.Compile(pBytesValues->GetString()) || aBytes.GetLiteralCount() != aBytes.GetLength())
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "literal \"", s_aBytesMemberName.GetString(), "\" ", "of \"", pszPatchName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		uintptr_t pPatch = pAddress->GetPtr();
+
+		RelativeAddress_t aRelative;
+
+		const ModuleImage *pImage = FindModuleByAddress(pPatch, aRelative) ? FindModuleImage(aRelative.m_sModule) : nullptr;
+
+		if(!pImage || !pImage->ContainsRVA(aRelative.m_nRVA, aBytes.GetLength()))
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "find ", "a module ", "for \"", pszPatchName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+			i++;
+
+			continue;
+		}
+
+		if(pExpectedValues)
+		{
+			Pattern aExpected;
+
+			if(!aExpected.Compile(pExpectedValues->GetString()) || !pImage->ContainsRVA(aRelative.m_nRVA, aExpected.GetLength()) || !aExpected.Match(pImage->GetPointer(aRelative.m_nRVA)))
+			{
+				const char *pszMessageConcat[] = {"Unexpected bytes ", "at \"", pszPatchName, "\": ", "not \"", pExpectedValues->GetString(), "\""};
+
+				vecMessages.AddToTail(pszMessageConcat);
+				i++;
+
+				continue;
+			}
+		}
+
+		// Offline (files, other processes) the patch is checked only: the process to patch is this one.
+		if(pImage->IsLive())
+		{
+			m_aPatcher.Add(pPatch, aBytes.GetBytes(), aBytes.GetLength());
+		}
+
+		i++;
+	}
+	while(i < iMemberCount);
+
+	std::string sError;
+
+	if(!m_aPatcher.Apply(sError))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "apply ", "patches: ", sError.c_str()};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	return true;
+}
+
+bool GameData::Config::LoadEngineLayout(const char *pszLayoutName, KeyValues3 *pLayoutValues, CBufferStringVector &vecMessages)
+{
+	const auto &aPlatformMemberName = GameData::GetPlatformMemberName(m_ePlatform);
+
+	KeyValues3 *pFieldsValues = pLayoutValues->FindMember(s_aFieldsMemberName);
+
+	KeyValues3 *pClassValues = pLayoutValues->FindMember(s_aSchemaMemberName);
+
+	const char *pszClassName = pClassValues ? pClassValues->GetString() : nullptr;
+
+	int iFieldCount = pFieldsValues->GetMemberCount();
+
+	Layout_t aLayout;
+
+	aLayout.m_vecFields.reserve(iFieldCount);
+
+	for(KV3MemberId_t i = 0; i < iFieldCount; i++)
+	{
+		const char *pszFieldName = pFieldsValues->GetMemberName(i);
+
+		KeyValues3 *pFieldValues = pFieldsValues->GetMember(i);
+
+		Layout_t::Field_t aField {GetSymbol(pszFieldName), 0, 0, FIELD_UNKNOWN};
+
+		// { "type": "<type>", "size": <bytes>, and the offset as of an Offsets entry }, or the offset alone.
+		KeyValues3 *pOffsetValues = pFieldValues;
+
+		std::string sSchemaName;
+
+		if(pFieldValues->GetType() == KV3_TYPE_TABLE)
+		{
+			KeyValues3 *pTypeValues = pFieldValues->FindMember(s_aTypeMemberName);
+
+			KeyValues3 *pSizeValues = pFieldValues->FindMember(s_aSizeMemberName);
+
+			if(pTypeValues)
+			{
+				const char *pszType = pTypeValues->GetString();
+
+				for(int iType = FIELD_FIRST; iType < FIELD_MAX; iType++)
+				{
+					if(!strcmp(s_aFieldTypes[iType].m_pszName, pszType))
+					{
+						aField.m_eType = static_cast<FieldType>(iType);
+						aField.m_nSize = s_aFieldTypes[iType].m_nSize;
+
+						break;
+					}
+				}
+
+				if(aField.m_eType == FIELD_UNKNOWN)
+				{
+					const char *pszMessageConcat[] = {"Unknown \"", pszType, "\" type ", "of \"", pszFieldName, "\" field ", "in \"", pszLayoutName, "\" layout"};
+
+					vecMessages.AddToTail(pszMessageConcat);
+
+					return false;
+				}
+			}
+
+			if(pSizeValues)
+			{
+				aField.m_nSize = static_cast<uint32>(pSizeValues->GetUInt64());
+			}
+
+			KeyValues3 *pSchemaValues = pFieldValues->FindMember(s_aSchemaMemberName);
+
+			pOffsetValues = pFieldValues->FindMember(aPlatformMemberName);
+
+			if(pSchemaValues)
+			{
+				sSchemaName = pSchemaValues->GetString();
+			}
+			else if(!pOffsetValues && pszClassName)
+			{
+				sSchemaName.assign(pszClassName).append("::").append(pszFieldName); // Of the layout's "schema" class.
+			}
+		}
+
+		std::string sError;
+
+		if(!sSchemaName.empty())
+		{
+			if(!LoadSchemaDump(vecMessages) || !m_aSchema.Find(sSchemaName.c_str(), aField.m_nOffset))
+			{
+				const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", sSchemaName.c_str(), "\" schema field ", "in \"", pszLayoutName, "\" layout"};
+
+				vecMessages.AddToTail(pszMessageConcat);
+
+				return false;
+			}
+		}
+		else if(!pOffsetValues)
+		{
+			sError = "no offset";
+		}
+		else if(pOffsetValues->GetType() == KV3_TYPE_STRING)
+		{
+			ReadExpression(pOffsetValues->GetString(), aField.m_nOffset, sError);
+		}
+		else if(pOffsetValues->GetType() == KV3_TYPE_INT || pOffsetValues->GetType() == KV3_TYPE_UINT)
+		{
+			aField.m_nOffset = static_cast<ptrdiff_t>(pOffsetValues->GetInt64());
+		}
+		else
+		{
+			sError = "not a number";
+		}
+
+		// A field lies within the object.
+		if(sError.empty() && aField.m_nOffset < 0)
+		{
+			sError = "negative offset";
+		}
+
+		if(!sError.empty())
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "\"", pszFieldName, "\" field ", "of \"", pszLayoutName, "\" layout: ", sError.c_str()};
 
 			vecMessages.AddToTail(pszMessageConcat);
-			i++;
 
+			return false;
+		}
+
+		aLayout.m_nExtent = std::max(aLayout.m_nExtent, static_cast<size_t>(aField.m_nOffset) + aField.m_nSize);
+		aLayout.m_vecFields.push_back(aField);
+	}
+
+	SetLayout(GetSymbol(pszLayoutName), aLayout);
+
+	return true;
+}
+
+bool GameData::Config::ReadExpression(const char *pszText, ptrdiff_t &nResult, std::string &sError, bool *pUnresolved)
+{
+	// As ReadOffset() read it.
+	if(!*pszText)
+	{
+		nResult = 0;
+
+		return true;
+	}
+
+	auto funcResolve = [this](const std::string &sName, int64_t &nValue) -> bool
+	{
+		const auto sSymbol = FindSymbol(sName.c_str());
+
+		// Not the value of a previous Load while this one folds it.
+		if(!sSymbol.IsValid() || m_setPendingOffsets.count(sSymbol.String()))
+		{
+			return false;
+		}
+
+		const ptrdiff_t *pOffset = m_aOffsetStorage.Find(sSymbol);
+
+		if(pOffset)
+		{
+			nValue = *pOffset;
+
+			return true;
+		}
+
+		const CUtlString *pKey = m_aKeysStorage.Find(sSymbol);
+
+		if(!pKey || pKey->IsEmpty())
+		{
+			return false;
+		}
+
+		char *pszEnd;
+
+		nValue = strtoll(pKey->Get(), &pszEnd, 0);
+
+		return !*pszEnd;
+	};
+
+	int64_t nValue;
+
+	if(!GameData::EvaluateExpression(pszText, funcResolve, nValue, sError, pUnresolved))
+	{
+		return false;
+	}
+
+	nResult = static_cast<ptrdiff_t>(nValue);
+
+	return true;
+}
+
+bool GameData::Config::ReadActionValue(const char *pszAddressName, const char *pszName, KeyValues3 *pAction, ptrdiff_t &nResult, CBufferStringVector &vecMessages)
+{
+	if(pAction->GetType() != KV3_TYPE_STRING)
+	{
+		nResult = static_cast<ptrdiff_t>(pAction->GetUInt64());
+
+		return true;
+	}
+
+	std::string sError;
+
+	if(!ReadExpression(pAction->GetString(), nResult, sError))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "evaluate ", "\"", pszName, "\" key ", "in \"", pszAddressName, "\": ", sError.c_str()};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	return true;
+}
+
+bool GameData::Config::LoadSchemaDump(CBufferStringVector &vecMessages)
+{
+	if(m_bSchemaLoaded)
+	{
+		return m_aSchema.GetCount() != 0;
+	}
+
+	m_bSchemaLoaded = true; // A failure is reported once.
+
+	const char *pszPath = m_sSchemaDump.Get();
+
+	if(m_sSchemaDump.IsEmpty())
+	{
+		static const char *s_pszMessageConcat[] = {"Failed to ", "get ", "a schema dump: ", "none is set"};
+
+		vecMessages.AddToTail(s_pszMessageConcat);
+
+		return false;
+	}
+
+	std::ifstream aStream(pszPath, std::ios::binary);
+
+	if(!aStream)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "open ", "\"", pszPath, "\" schema dump"};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	std::ostringstream aText;
+
+	aText << aStream.rdbuf();
+
+	KeyValues3 aDump;
+
+	CUtlString sError;
+
+	if(!LoadKV3FromJSON(&aDump, &sError, aText.str().c_str(), pszPath))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "parse ", "\"", pszPath, "\" schema dump: ", sError.Get()};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	int iMemberCount = aDump.GetMemberCount();
+
+	for(KV3MemberId_t i = 0; i < iMemberCount; i++)
+	{
+		KeyValues3 *pMember = aDump.GetMember(i);
+
+		if(pMember->GetType() != KV3_TYPE_TABLE)
+		{
 			continue;
 		}
 
-		SetOffset(GetSymbol(pszOffsetName), pPlatformValues->GetType() == KV3_TYPE_STRING ? GameData::ReadOffset(pPlatformValues->GetString()) : pPlatformValues->GetUInt64());
+		KeyValues3 *pClassesValues = pMember->FindMember(s_aClassesMemberName);
 
-		i++;
+		if(!pClassesValues)
+		{
+			LoadSchemaClass(aDump.GetMemberName(i), pMember); // Flat, class by class.
+
+			continue;
+		}
+
+		int iClassCount = pClassesValues->GetMemberCount();
+
+		for(KV3MemberId_t j = 0; j < iClassCount; j++)
+		{
+			LoadSchemaClass(pClassesValues->GetMemberName(j), pClassesValues->GetMember(j));
+		}
+	}
+
+	if(!m_aSchema.GetCount())
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "fields ", "in \"", pszPath, "\" schema dump"};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
 	}
-	while(i < iMemberCount);
 
 	return true;
 }
 
+void GameData::Config::LoadSchemaClass(const char *pszClassName, KeyValues3 *pClassValues)
+{
+	if(pClassValues->GetType() != KV3_TYPE_TABLE)
+	{
+		return;
+	}
+
+	KeyValues3 *pFieldsValues = pClassValues->FindMember(s_aFieldsMemberName);
+
+	if(pFieldsValues)
+	{
+		KeyValues3 *pParentValues = pClassValues->FindMember(s_aParentMemberName);
+
+		if(pParentValues && pParentValues->GetType() == KV3_TYPE_STRING)
+		{
+			m_aSchema.AddClass(pszClassName, pParentValues->GetString());
+		}
+	}
+	else
+	{
+		pFieldsValues = pClassValues;
+	}
+
+	int iFieldCount = pFieldsValues->GetMemberCount();
+
+	for(KV3MemberId_t i = 0; i < iFieldCount; i++)
+	{
+		KeyValues3 *pFieldValues = pFieldsValues->GetMember(i);
+
+		KV3Type_t eType = pFieldValues->GetType();
+
+		if(eType == KV3_TYPE_INT || eType == KV3_TYPE_UINT)
+		{
+			m_aSchema.AddField(pszClassName, pFieldsValues->GetMemberName(i), static_cast<ptrdiff_t>(pFieldValues->GetInt64()));
+		}
+	}
+}
+
 bool GameData::Config::LoadEngineAddresses(IGameData *pRoot, KeyValues3 *pAddressesValues, CBufferStringVector &vecMessages)
 {
 	int iMemberCount = pAddressesValues->GetMemberCount();
@@ -451,7 +1769,17 @@ bool GameData::Config::LoadEngineAddresses(IGameData *pRoot, KeyValues3 *pAddres
 			continue;
 		}
 
-		SetAddress(GetSymbol(pszAddressName), pAddrCur);
+		const auto sAddressName = GetSymbol(pszAddressName);
+
+		SetAddress(sAddressName, pAddrCur);
+
+		RelativeAddress_t aRelative;
+
+		// Heap or foreign addresses have no stable module-relative form.
+		if(FindModuleByAddress(pAddrCur, aRelative))
+		{
+			SetRelativeAddress(sAddressName, aRelative);
+		}
 
 		i++;
 	}
@@ -473,36 +1801,126 @@ bool GameData::Config::LoadEngineAddressActions(IGameData *pRoot, const char *ps
 		return false;
 	}
 
-	const auto &aSignatureMemberName = s_aSignatureMemberName;
+	const auto &aSignatureMemberName = s_aSignatureMemberName;
+
+	const char *pszSignatureKey = aSignatureMemberName.GetString();
+
+	KeyValues3 *pSignatureValues = pActionsValues->FindMember(aSignatureMemberName);
+
+	if(pSignatureValues)
+	{
+		const char *pszSignatureName = pSignatureValues->GetString();
+
+		const auto &pSigAddress = GetAddress(GetSymbol(pszSignatureName));
+
+		if(!pSigAddress)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "\"", pszSignatureKey, "\" signature ", "in \"", pszAddressName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+
+			return false;
+		}
+
+		pAddrCur = pSigAddress.GetPtr();
+
+		pActionsValues->RemoveMember(pSignatureValues);
+		iMemberCount--;
+	}
+
+	KeyValues3 *pImportValues = pActionsValues->FindMember(s_aImportMemberName);
+
+	if(pImportValues)
+	{
+		const char *pszImportName = pImportValues->GetString();
+
+		const auto &aLibraryMemberName = s_aLibraryMemberName;
+
+		const char *pszLibraryKey = aLibraryMemberName.GetString();
+
+		KeyValues3 *pLibraryValues = pActionsValues->FindMember(aLibraryMemberName);
+
+		const auto *pLibrary = pLibraryValues ? FindLibrary(pRoot, GetSymbol(pLibraryValues->GetString())) : nullptr;
+
+		if(!pLibrary || !pLibrary->m_pImage)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "a parsed \"", pszLibraryKey, "\" ", "of \"", pszImportName, "\" import ", "in \"", pszAddressName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+
+			return false;
+		}
+
+		const auto *pLibImage = pLibrary->m_pImage;
+
+		uintptr_t nRVA;
+
+		// The slot, not the function: "read" follows it to the bound address.
+		if(!pLibImage->GetIndex<ImportTable>().Find(pszImportName, nRVA))
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "find ", "\"", pszImportName, "\" import ", "in \"", pszAddressName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
+
+			return false;
+		}
+
+		pAddrCur = pLibImage->FromRVA(nRVA);
+
+		pActionsValues->RemoveMember(pImportValues);
+		pActionsValues->RemoveMember(pLibraryValues);
+		iMemberCount -= 2;
+	}
+
+	KeyValues3 *pFunctionHashValues = pActionsValues->FindMember(s_aFunctionHashMemberName);
+
+	if(pFunctionHashValues)
+	{
+		const char *pszFunctionHash = pFunctionHashValues->GetString();
+
+		const auto &aLibraryMemberName = s_aLibraryMemberName;
+
+		const char *pszLibraryKey = aLibraryMemberName.GetString();
+
+		KeyValues3 *pLibraryValues = pActionsValues->FindMember(aLibraryMemberName);
+
+		const auto *pLibrary = pLibraryValues ? FindLibrary(pRoot, GetSymbol(pLibraryValues->GetString())) : nullptr;
+
+		if(!pLibrary || !pLibrary->m_pImage)
+		{
+			const char *pszMessageConcat[] = {"Failed to ", "get ", "a parsed \"", pszLibraryKey, "\" ", "of \"", pszFunctionHash, "\" function hash ", "in \"", pszAddressName, "\""};
+
+			vecMessages.AddToTail(pszMessageConcat);
 
-	const char *pszSignatureKey = aSignatureMemberName.GetString();
+			return false;
+		}
 
-	KeyValues3 *pSignatureValues = pActionsValues->FindMember(aSignatureMemberName);
+		char *pszEnd;
 
-	if(pSignatureValues)
-	{
-		const char *pszSignatureName = pSignatureValues->GetString();
+		uint64_t nHash = strtoull(pszFunctionHash, &pszEnd, 16);
 
-		const auto &pSigAddress = GetAddress(GetSymbol(pszSignatureName));
+		uintptr_t nRVA;
 
-		if(!pSigAddress)
+		// Hex string: 64-bit values do not survive JSON numbers.
+		if(!*pszFunctionHash || *pszEnd || !pLibrary->m_pImage->GetIndex<FunctionHashIndex>().Find(nHash, nRVA))
 		{
-			const char *pszMessageConcat[] = {"Failed to ", "get ", "\"", pszSignatureKey, "\" signature ", "in \"", pszAddressName, "\""};
+			const char *pszMessageConcat[] = {"Failed to ", "find ", "a single function ", "by \"", pszFunctionHash, "\" hash ", "in \"", pszAddressName, "\""};
 
 			vecMessages.AddToTail(pszMessageConcat);
 
 			return false;
 		}
 
-		pAddrCur = pSigAddress.GetPtr();
+		pAddrCur = pLibrary->m_pImage->FromRVA(nRVA);
 
-		pActionsValues->RemoveMember(pSignatureValues);
-		iMemberCount--;
+		pActionsValues->RemoveMember(pFunctionHashValues);
+		pActionsValues->RemoveMember(pLibraryValues);
+		iMemberCount -= 2;
 	}
 
 	// Remove an extra keys.
 	{
-		int iCurrentPlat = GetCurrentPlatform();
+		int iCurrentPlat = m_ePlatform;
 
 		for(int iPlat = PLAT_FIRST; iPlat < PLAT_MAX; iPlat++)
 		{
@@ -521,7 +1939,7 @@ bool GameData::Config::LoadEngineAddressActions(IGameData *pRoot, const char *ps
 		return true;
 	}
 
-	const auto &aPlatformMemberName = GameData::GetCurrentPlatformMemberName();
+	const auto &aPlatformMemberName = GameData::GetPlatformMemberName(m_ePlatform);
 
 	const char *pszPlatformKey = aPlatformMemberName.GetString();
 
@@ -539,7 +1957,17 @@ bool GameData::Config::LoadEngineAddressActions(IGameData *pRoot, const char *ps
 		}
 		else
 		{
-			ptrdiff_t nActionValue = static_cast<ptrdiff_t>(pAction->GetUInt64());
+			static const char *s_pszNumericActions[] = {"offset", "read", "read_offs32", "vfunc", "callers_of", "nth_call"};
+
+			ptrdiff_t nActionValue = 0;
+
+			for(const char *pszNumericAction : s_pszNumericActions)
+			{
+				if(!strcmp(pszName, pszNumericAction) && !ReadActionValue(pszAddressName, pszName, pAction, nActionValue, vecMessages))
+				{
+					return false;
+				}
+			}
 
 			if(!strcmp(pszName, "offset"))
 			{
@@ -549,11 +1977,33 @@ bool GameData::Config::LoadEngineAddressActions(IGameData *pRoot, const char *ps
 			{
 				if(!pszName[4])
 				{
-					pAddrCur = *reinterpret_cast<uintptr_t *>(pAddrCur + nActionValue);
+					uintptr_t pValue;
+
+					if(!ReadMemory(pAddrCur + nActionValue, &pValue, sizeof(pValue)))
+					{
+						const char *pszMessageConcat[] = {"Failed to ", "read ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+						vecMessages.AddToTail(pszMessageConcat);
+
+						return false;
+					}
+
+					pAddrCur = pValue;
 				}
 				else if(!strcmp(&pszName[4], "_offs32"))
 				{
-					pAddrCur = pAddrCur + nActionValue + sizeof(int32_t) + *reinterpret_cast<int32_t *>(pAddrCur + nActionValue);
+					int32_t nValue;
+
+					if(!ReadMemory(pAddrCur + nActionValue, &nValue, sizeof(nValue)))
+					{
+						const char *pszMessageConcat[] = {"Failed to ", "read ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+						vecMessages.AddToTail(pszMessageConcat);
+
+						return false;
+					}
+
+					pAddrCur = pAddrCur + nActionValue + sizeof(int32_t) + nValue;
 				}
 				else
 				{
@@ -565,6 +2015,42 @@ bool GameData::Config::LoadEngineAddressActions(IGameData *pRoot, const char *ps
 					continue;
 				}
 			}
+			else if(!strcmp(pszName, "vfunc"))
+			{
+				uintptr_t pValue;
+
+				if(!ReadMemory(pAddrCur + nActionValue * sizeof(void *), &pValue, sizeof(pValue)))
+				{
+					const char *pszMessageConcat[] = {"Failed to ", "read ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+					vecMessages.AddToTail(pszMessageConcat);
+
+					return false;
+				}
+
+				pAddrCur = pValue;
+			}
+			else if(!strcmp(pszName, "callers_of") || !strcmp(pszName, "nth_call"))
+			{
+				if(!LoadEngineXrefAction(pszAddressName, pszName, nActionValue, pAddrCur, vecMessages))
+				{
+					return false;
+				}
+			}
+			else if(!strcmp(pszName, "scan"))
+			{
+				if(!LoadEngineScanAction(pszAddressName, pszName, pAction, pAddrCur, vecMessages))
+				{
+					return false;
+				}
+			}
+			else if(!strcmp(pszName, "function_start") || !strcmp(pszName, "scan_in_function"))
+			{
+				if(!LoadEngineFunctionAction(pszAddressName, pszName, pAction, pAddrCur, vecMessages))
+				{
+					return false;
+				}
+			}
 			else
 			{
 				const char *pszMessageConcat[] = {"Unknown \"", pszName, "\" key"};
@@ -583,6 +2069,218 @@ bool GameData::Config::LoadEngineAddressActions(IGameData *pRoot, const char *ps
 	return true;
 }
 
+bool GameData::Config::LoadEngineXrefAction(const char *pszAddressName, const char *pszName, ptrdiff_t nIndex, uintptr_t &pAddrCur, CBufferStringVector &vecMessages)
+{
+	RelativeAddress_t aRelative;
+
+	const ModuleImage *pImage = FindModuleByAddress(pAddrCur, aRelative) ? FindModuleImage(aRelative.m_sModule) : nullptr;
+
+	if(!pImage)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a module ", "for \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	// Built on the first xref action of a module, shared by the rest.
+	const auto &aXrefs = pImage->GetIndex<XrefIndex>();
+
+	std::vector<uintptr_t> vecRVAs;
+
+	if(!strcmp(pszName, "callers_of"))
+	{
+		aXrefs.FindReferences(aRelative.m_nRVA, vecRVAs, XREF_CALL);
+	}
+	else
+	{
+		FunctionIndex::Function_t aFunction;
+
+		// Exact bounds from the unwind tables when they cover the site, the call graph guess otherwise.
+		uintptr_t nEnd = pImage->GetIndex<FunctionIndex>().Find(aRelative.m_nRVA, aFunction) ? aFunction.m_nEnd : 0;
+
+		aXrefs.FindCallsFrom(aRelative.m_nRVA, vecRVAs, nEnd);
+	}
+
+	if(nIndex < 0 || static_cast<size_t>(nIndex) >= vecRVAs.size())
+	{
+		char szIndex[24], szCount[24];
+
+		snprintf(szIndex, sizeof(szIndex), "%td", nIndex);
+		snprintf(szCount, sizeof(szCount), "%zu", vecRVAs.size());
+
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "call #", szIndex, " (", szCount, " found) ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	pAddrCur = pImage->FromRVA(vecRVAs[nIndex]);
+
+	return true;
+}
+
+bool GameData::Config::LoadEngineScanAction(const char *pszAddressName, const char *pszName, KeyValues3 *pAction, uintptr_t &pAddrCur, CBufferStringVector &vecMessages)
+{
+	KeyValues3 *pPatternValues = pAction->FindMember(s_aPatternMemberName);
+
+	KeyValues3 *pMaxValues = pAction->FindMember(s_aMaxMemberName);
+
+	if(!pPatternValues || !pMaxValues)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "get ", "\"", s_aPatternMemberName.GetString(), "\" or \"", s_aMaxMemberName.GetString(), "\" key ", "of \"", pszName, "\" ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	Pattern aPattern;
+
+	if(!aPattern.Compile(pPatternValues->GetString()))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "compile ", "\"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	RelativeAddress_t aRelative;
+
+	const ModuleImage *pImage = FindModuleByAddress(pAddrCur, aRelative) ? FindModuleImage(aRelative.m_sModule) : nullptr;
+
+	if(!pImage)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a module ", "for \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	const ModuleImage::Segment_t *pSegment = pImage->FindSegment(aRelative.m_nRVA);
+
+	if(!pSegment)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a segment ", "for \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	KeyValues3 *pBackwardValues = pAction->FindMember(s_aBackwardMemberName);
+
+	bool bBackward = pBackwardValues && pBackwardValues->GetBool();
+
+	uintptr_t nMax = static_cast<uintptr_t>(pMaxValues->GetUInt64()),
+	          nLow = pSegment->m_nRVA,
+	          nHigh = std::min(static_cast<uintptr_t>(pSegment->m_nRVA + pSegment->m_nSize), static_cast<uintptr_t>(pImage->GetSize())),
+	          nLength = aPattern.GetLength();
+
+	// A match starts within nMax bytes: [cur, cur + max] forward, [cur - max, cur) backward. Clamped to the segment.
+	uintptr_t nBegin = bBackward ? aRelative.m_nRVA - std::min(nMax, aRelative.m_nRVA - nLow) : aRelative.m_nRVA,
+	          nEnd = bBackward ? aRelative.m_nRVA - 1 + nLength : aRelative.m_nRVA + std::min(nMax, nHigh - aRelative.m_nRVA) + nLength;
+
+	nEnd = std::max(std::min(nEnd, nHigh), nBegin);
+
+	const uint8_t *pBegin = pImage->GetPointer(nBegin),
+	              *pEnd = pImage->GetPointer(nEnd),
+	              *pMatch = nullptr;
+
+	// Nearest first either way, so "backward" lands on the closest preceding match.
+	if(!bBackward)
+	{
+		pMatch = aPattern.Find(pBegin, pEnd);
+	}
+	else if(nBegin < aRelative.m_nRVA)
+	{
+		pMatch = aPattern.FindBackward(pBegin, pEnd);
+	}
+
+	if(!pMatch)
+	{
+		char szMax[24];
+
+		snprintf(szMax, sizeof(szMax), "%zu", static_cast<size_t>(nMax));
+
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a match ", "within ", szMax, " bytes ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	pAddrCur = pImage->FromRVA(nBegin + (pMatch - pBegin));
+
+	return true;
+}
+
+bool GameData::Config::LoadEngineFunctionAction(const char *pszAddressName, const char *pszName, KeyValues3 *pAction, uintptr_t &pAddrCur, CBufferStringVector &vecMessages)
+{
+	RelativeAddress_t aRelative;
+
+	const ModuleImage *pImage = FindModuleByAddress(pAddrCur, aRelative) ? FindModuleImage(aRelative.m_sModule) : nullptr;
+
+	if(!pImage)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a module ", "for \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	FunctionIndex::Function_t aFunction;
+
+	if(!pImage->GetIndex<FunctionIndex>().Find(aRelative.m_nRVA, aFunction))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a function ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	if(!strcmp(pszName, "function_start"))
+	{
+		pAddrCur = pImage->FromRVA(aFunction.m_nStart);
+
+		return true;
+	}
+
+	Pattern aPattern;
+
+	if(!aPattern.Compile(pAction->GetString()))
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "compile ", "\"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	// From the current address (inclusive) to the end of its function.
+	const uint8_t *pBegin = pImage->GetPointer(aRelative.m_nRVA),
+	              *pMatch = aPattern.Find(pBegin, pImage->GetPointer(aFunction.m_nEnd));
+
+	if(!pMatch)
+	{
+		const char *pszMessageConcat[] = {"Failed to ", "find ", "a match ", "by \"", pszName, "\" key ", "in \"", pszAddressName, "\""};
+
+		vecMessages.AddToTail(pszMessageConcat);
+
+		return false;
+	}
+
+	pAddrCur = pImage->FromRVA(aRelative.m_nRVA + (pMatch - pBegin));
+
+	return true;
+}
+
 CUtlSymbolLarge GameData::Config::GetSymbol(const char *pszText)
 {
 	return m_aSymbolTable.AddString(pszText);
@@ -598,6 +2296,11 @@ const DynLibUtils::CMemory &GameData::Config::GetAddress(const CUtlSymbolLarge &
 	return m_aAddressStorage.Get(sName);
 }
 
+const GameData::Config::RelativeAddress_t &GameData::Config::GetRelativeAddress(const CUtlSymbolLarge &sName) const
+{
+	return m_aRelativeAddressStorage.Get(sName);
+}
+
 const CUtlString &GameData::Config::GetKey(const CUtlSymbolLarge &sName) const
 {
 	return m_aKeysStorage.Get(sName);
@@ -608,9 +2311,25 @@ const ptrdiff_t &GameData::Config::GetOffset(const CUtlSymbolLarge &sName) const
 	return m_aOffsetStorage.Get(sName);
 }
 
+const GameData::ByteProfile::Anchor_t &GameData::Config::GetAnchor(const CUtlSymbolLarge &sName) const
+{
+	return m_aAnchorStorage.Get(sName);
+}
+
+const GameData::Config::Layout_t *GameData::Config::GetLayout(const CUtlSymbolLarge &sName) const
+{
+	return m_aLayoutStorage.Find(sName);
+}
+
 void GameData::Config::SetAddress(const CUtlSymbolLarge &sName, const DynLibUtils::CMemory &aMemory)
 {
 	m_aAddressStorage.Set(sName, aMemory);
+	m_setLoadedAddresses.insert(sName.String());
+}
+
+void GameData::Config::SetRelativeAddress(const CUtlSymbolLarge &sName, const RelativeAddress_t &aRelative)
+{
+	m_aRelativeAddressStorage.Set(sName, aRelative);
 }
 
 void GameData::Config::SetKey(const CUtlSymbolLarge &sName, const CUtlString &sValue)
@@ -622,3 +2341,129 @@ void GameData::Config::SetOffset(const CUtlSymbolLarge &sName, const ptrdiff_t &
 {
 	m_aOffsetStorage.Set(sName, nValue);
 }
+
+void GameData::Config::SetAnchor(const CUtlSymbolLarge &sName, const ByteProfile::Anchor_t &aAnchor)
+{
+	m_aAnchorStorage.Set(sName, aAnchor);
+}
+
+void GameData::Config::SetLayout(const CUtlSymbolLarge &sName, const Layout_t &aLayout)
+{
+	m_aLayoutStorage.Set(sName, aLayout);
+}
+
+void GameData::Config::AddModuleImage(const CUtlSymbolLarge &sModule, const ModuleImage *pImage)
+{
+	m_mapModuleImages.InsertOrReplace(sModule, pImage);
+}
+
+const GameData::ModuleImage *GameData::Config::FindModuleImage(const CUtlSymbolLarge &sModule) const
+{
+	auto &map = m_mapModuleImages;
+
+	auto iFound = map.Find(sModule);
+
+	return IS_VALID_GAMEDATA_INDEX(map, iFound) ? map.Element(iFound) : nullptr;
+}
+
+bool GameData::Config::FindModuleByAddress(uintptr_t pAddress, RelativeAddress_t &aResult) const
+{
+	pAddress = ToLocalAddress(pAddress);
+
+	FOR_EACH_MAP_FAST(m_mapModuleImages, i)
+	{
+		const auto *pImage = m_mapModuleImages.Element(i);
+
+		if(pImage->Contains(pAddress))
+		{
+			aResult.m_sModule = m_mapModuleImages.Key(i);
+			aResult.m_nRVA = pImage->ToRVA(pAddress);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const GameData::Config::Library_t *GameData::Config::FindLibrary(IGameData *pRoot, const CUtlSymbolLarge &sLibrary)
+{
+	// Symbols are interned (case-insensitive), so the string pointer is the identity.
+	const char *pszLibraryName = sLibrary.String();
+
+	auto itFound = m_mapLibraries.find(pszLibraryName);
+
+	if(itFound != m_mapLibraries.end())
+	{
+		return itFound->second.IsValid() ? &itFound->second : nullptr;
+	}
+
+	Library_t aLibrary {};
+
+	aLibrary.m_pModule = pRoot->FindLibrary(pszLibraryName);
+	aLibrary.m_pImage = aLibrary.m_pModule ? GameData::GetModuleImage(aLibrary.m_pModule) : pRoot->FindLibraryImage(pszLibraryName);
+
+	if(aLibrary.m_pImage)
+	{
+		AddModuleImage(sLibrary, aLibrary.m_pImage);
+	}
+
+	auto &aResult = m_mapLibraries[pszLibraryName] = aLibrary;
+
+	return aResult.IsValid() ? &aResult : nullptr;
+}
+
+uintptr_t GameData::Config::ToLocalAddress(uintptr_t pAddress) const
+{
+	FOR_EACH_MAP_FAST(m_mapModuleImages, i)
+	{
+		const auto *pImage = m_mapModuleImages.Element(i);
+
+		uintptr_t nRuntimeBase = pImage->GetRuntimeBase(),
+		          nLocalBase = reinterpret_cast<uintptr_t>(pImage->GetBase());
+
+		// Loaded and file images run where they are; only a remote copy differs.
+		if(nRuntimeBase != nLocalBase && pAddress - nRuntimeBase < pImage->GetSize())
+		{
+			return nLocalBase + (pAddress - nRuntimeBase);
+		}
+	}
+
+	return pAddress;
+}
+
+bool GameData::Config::ReadMemory(uintptr_t pAddress, void *pOutput, size_t nSize) const
+{
+	pAddress = ToLocalAddress(pAddress);
+
+	bool bLive = true;
+
+	FOR_EACH_MAP_FAST(m_mapModuleImages, i)
+	{
+		const auto *pImage = m_mapModuleImages.Element(i);
+
+		if(pImage->Contains(pAddress))
+		{
+			if(!pImage->ContainsRVA(pImage->ToRVA(pAddress), nSize))
+			{
+				return false;
+			}
+
+			memcpy(pOutput, reinterpret_cast<const void *>(pAddress), nSize);
+
+			return true;
+		}
+
+		bLive &= pImage->IsLive();
+	}
+
+	// Outside of every image, only the memory of a live process is there to read.
+	if(!bLive)
+	{
+		return false;
+	}
+
+	memcpy(pOutput, reinterpret_cast<const void *>(pAddress), nSize);
+
+	return true;
+}
@@ -0,0 +1,333 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/bufferimage.hpp>
+
+#include "formats.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#	include <windows.h>
+#else
+#	include <sys/mman.h>
+#endif
+
+using namespace GameData::Formats;
+
+GameData::BufferModuleImage::BufferModuleImage()
+ :  m_pMemory(nullptr),
+    m_nMemorySize(0)
+{
+}
+
+GameData::BufferModuleImage::~BufferModuleImage()
+{
+	Release();
+}
+
+uint8_t *GameData::BufferModuleImage::GetMemory() const
+{
+	return m_pMemory;
+}
+
+size_t GameData::BufferModuleImage::GetMemorySize() const
+{
+	return m_nMemorySize;
+}
+
+void GameData::BufferModuleImage::RelocateELF(uint64_t nAppliedBias)
+{
+	const auto aHeader = Read<ELF::Ehdr_t>(m_pMemory);
+
+	if(aHeader.e_phoff > m_nMemorySize || aHeader.e_phnum * sizeof(ELF::Phdr_t) > m_nMemorySize - aHeader.e_phoff)
+	{
+		return;
+	}
+
+	uintptr_t nMinAddress = UINTPTR_MAX,
+	          nDynamic = 0;
+
+	size_t nDynamicSize = 0;
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(m_pMemory + aHeader.e_phoff + n * sizeof(ELF::Phdr_t));
+
+		if(aProgram.p_type == ELF::PT_LOAD)
+		{
+			nMinAddress = std::min<uintptr_t>(nMinAddress, aProgram.p_vaddr & ~static_cast<uint64_t>(0xFFF));
+		}
+		else if(aProgram.p_type == ELF::PT_DYNAMIC)
+		{
+			nDynamic = aProgram.p_vaddr;
+			nDynamicSize = aProgram.p_memsz;
+		}
+	}
+
+	if(!nDynamicSize)
+	{
+		return;
+	}
+
+	// What the loader adds to link-time addresses: the local base stands in for the load address.
+	uintptr_t nBias = reinterpret_cast<uintptr_t>(m_pMemory) - nMinAddress;
+
+	// A copy of a loaded module has its address entries relocated already; a file has them as linked.
+	auto ToLinkAddress = [nAppliedBias](uint64_t nValue) -> uint64_t
+	{
+		return nAppliedBias && nValue >= nAppliedBias ? nValue - nAppliedBias : nValue;
+	};
+
+	auto IsInside = [this, nMinAddress](uint64_t nAddress, uint64_t nLength) -> bool
+	{
+		uint64_t nRVA = nAddress - nMinAddress;
+
+		return nAddress >= nMinAddress && nRVA <= m_nMemorySize && nLength <= m_nMemorySize - nRVA;
+	};
+
+	if(!IsInside(nDynamic, nDynamicSize))
+	{
+		return;
+	}
+
+	uint64_t nRela = 0, nRelaSize = 0,
+	         nJumpRel = 0, nJumpRelSize = 0,
+	         nRelr = 0, nRelrSize = 0;
+
+	uint8_t *pDynamic = m_pMemory + (nDynamic - nMinAddress);
+
+	for(size_t nOffset = 0; nOffset + sizeof(ELF::Dyn_t) <= nDynamicSize; nOffset += sizeof(ELF::Dyn_t))
+	{
+		auto aEntry = Read<ELF::Dyn_t>(pDynamic + nOffset);
+
+		if(aEntry.d_tag == ELF::DT_NULL)
+		{
+			break;
+		}
+
+		switch(aEntry.d_tag)
+		{
+			case ELF::DT_RELA:      nRela = ToLinkAddress(aEntry.d_val); break;
+			case ELF::DT_RELASZ:    nRelaSize = aEntry.d_val; break;
+			case ELF::DT_JMPREL:    nJumpRel = ToLinkAddress(aEntry.d_val); break;
+			case ELF::DT_PLTRELSZ:  nJumpRelSize = aEntry.d_val; break;
+			case ELF::DT_RELR:      nRelr = ToLinkAddress(aEntry.d_val); break;
+			case ELF::DT_RELRSZ:    nRelrSize = aEntry.d_val; break;
+			default:                break;
+		}
+
+		// The loader rewrites the address entries of the dynamic table in place; keep the two layouts alike.
+		switch(aEntry.d_tag)
+		{
+			case ELF::DT_HASH:
+			case ELF::DT_STRTAB:
+			case ELF::DT_SYMTAB:
+			case ELF::DT_RELA:
+			case ELF::DT_JMPREL:
+			case ELF::DT_GNU_HASH:
+			{
+				aEntry.d_val = ToLinkAddress(aEntry.d_val) + nBias;
+				memcpy(pDynamic + nOffset, &aEntry, sizeof(aEntry));
+
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+	auto Relocate = [this, nMinAddress, nBias, &IsInside](uint64_t nTable, uint64_t nTableSize)
+	{
+		if(!nTableSize || !IsInside(nTable, nTableSize))
+		{
+			return;
+		}
+
+		const uint8_t *pTable = m_pMemory + (nTable - nMinAddress);
+
+		for(uint64_t nOffset = 0; nOffset + sizeof(ELF::Rela_t) <= nTableSize; nOffset += sizeof(ELF::Rela_t))
+		{
+			const auto aRela = Read<ELF::Rela_t>(pTable + nOffset);
+
+			uint32_t nType = aRela.GetType();
+
+			// IRELATIVE keeps the resolver address, as there is nothing to call it in.
+			if(nType != ELF::R_X86_64_RELATIVE && nType != ELF::R_X86_64_IRELATIVE)
+			{
+				continue;
+			}
+
+			if(!IsInside(aRela.r_offset, sizeof(uint64_t)))
+			{
+				continue;
+			}
+
+			uint64_t nValue = static_cast<uint64_t>(aRela.r_addend) + nBias;
+
+			memcpy(m_pMemory + (aRela.r_offset - nMinAddress), &nValue, sizeof(nValue));
+		}
+	};
+
+	Relocate(nRela, nRelaSize);
+	Relocate(nJumpRel, nJumpRelSize);
+
+	if(nRelrSize && IsInside(nRelr, nRelrSize))
+	{
+		const uint8_t *pRelr = m_pMemory + (nRelr - nMinAddress);
+
+		uint64_t nWhere = 0;
+
+		auto RelocateWord = [this, nMinAddress, nAppliedBias, nBias, &IsInside](uint64_t nAddress)
+		{
+			if(!IsInside(nAddress, sizeof(uint64_t)))
+			{
+				return;
+			}
+
+			uint8_t *pWord = m_pMemory + (nAddress - nMinAddress);
+
+			uint64_t nValue = Read<uint64_t>(pWord) - nAppliedBias + nBias;
+
+			memcpy(pWord, &nValue, sizeof(nValue));
+		};
+
+		for(uint64_t nOffset = 0; nOffset + sizeof(uint64_t) <= nRelrSize; nOffset += sizeof(uint64_t))
+		{
+			uint64_t nEntry = Read<uint64_t>(pRelr + nOffset);
+
+			if(!(nEntry & 1))
+			{
+				// An address: relocate it and continue the bitmaps after it.
+				RelocateWord(nEntry);
+				nWhere = nEntry + sizeof(uint64_t);
+
+				continue;
+			}
+
+			// A bitmap of the next 63 words.
+			for(uint64_t nBit = 0; (nEntry >>= 1); nBit++)
+			{
+				if(nEntry & 1)
+				{
+					RelocateWord(nWhere + nBit * sizeof(uint64_t));
+				}
+			}
+
+			nWhere += 63 * sizeof(uint64_t);
+		}
+	}
+}
+
+void GameData::BufferModuleImage::RelocatePE(uint32_t nDirectoryRVA, uint32_t nDirectorySize, uint64_t nAppliedBase)
+{
+	if(!nDirectorySize || nDirectoryRVA > m_nMemorySize || nDirectorySize > m_nMemorySize - nDirectoryRVA)
+	{
+		return;
+	}
+
+	uint64_t nDelta = reinterpret_cast<uintptr_t>(m_pMemory) - nAppliedBase;
+
+	const uint8_t *pBlock = m_pMemory + nDirectoryRVA,
+	              *pEnd = pBlock + nDirectorySize;
+
+	while(pBlock + sizeof(PE::BaseRelocation_t) <= pEnd)
+	{
+		const auto aBlock = Read<PE::BaseRelocation_t>(pBlock);
+
+		if(aBlock.SizeOfBlock < sizeof(PE::BaseRelocation_t) || pBlock + aBlock.SizeOfBlock > pEnd)
+		{
+			break;
+		}
+
+		size_t nEntries = (aBlock.SizeOfBlock - sizeof(PE::BaseRelocation_t)) / sizeof(uint16_t);
+
+		for(size_t n = 0; n < nEntries; n++)
+		{
+			uint16_t nEntry = Read<uint16_t>(pBlock + sizeof(PE::BaseRelocation_t) + n * sizeof(uint16_t));
+
+			// Only 64-bit slots are used by x86-64 images; the rest is padding.
+			if((nEntry >> 12) != PE::REL_BASED_DIR64)
+			{
+				continue;
+			}
+
+			uint64_t nRVA = static_cast<uint64_t>(aBlock.VirtualAddress) + (nEntry & 0xFFF);
+
+			if(nRVA + sizeof(uint64_t) > m_nMemorySize)
+			{
+				continue;
+			}
+
+			uint64_t nValue = Read<uint64_t>(m_pMemory + nRVA) + nDelta;
+
+			memcpy(m_pMemory + nRVA, &nValue, sizeof(nValue));
+		}
+
+		pBlock += aBlock.SizeOfBlock;
+	}
+}
+
+bool GameData::BufferModuleImage::Allocate(size_t nSize)
+{
+#if defined(_WIN32)
+	void *pMemory = VirtualAlloc(nullptr, nSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+	if(!pMemory)
+	{
+		return false;
+	}
+#else
+	void *pMemory = mmap(nullptr, nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if(pMemory == MAP_FAILED)
+	{
+		return false;
+	}
+#endif
+
+	m_pMemory = reinterpret_cast<uint8_t *>(pMemory);
+	m_nMemorySize = nSize;
+
+	return true;
+}
+
+void GameData::BufferModuleImage::Release()
+{
+	if(!m_pMemory)
+	{
+		return;
+	}
+
+#if defined(_WIN32)
+	VirtualFree(m_pMemory, 0, MEM_RELEASE);
+#else
+	munmap(m_pMemory, m_nMemorySize);
+#endif
+
+	m_pMemory = nullptr;
+	m_nMemorySize = 0;
+}
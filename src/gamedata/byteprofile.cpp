@@ -0,0 +1,117 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/byteprofile.hpp>
+
+GameData::ByteProfile::ByteProfile(const ModuleImage &aImage)
+ :  m_nTotal(0),
+    m_vecBytes(0x100),
+    m_vecPairs(0x10000)
+{
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(!it.IsCode() || !it.m_nSize || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			continue;
+		}
+
+		const uint8_t *pData = aImage.GetPointer(it.m_nRVA);
+
+		for(size_t n = 0; n < it.m_nSize; n++)
+		{
+			m_vecBytes[pData[n]]++;
+		}
+
+		for(size_t n = 1; n < it.m_nSize; n++)
+		{
+			m_vecPairs[(pData[n - 1] << 8) | pData[n]]++;
+		}
+
+		m_nTotal += it.m_nSize;
+	}
+}
+
+size_t GameData::ByteProfile::GetTotal() const
+{
+	return m_nTotal;
+}
+
+size_t GameData::ByteProfile::GetByteCount(uint8_t nByte) const
+{
+	return m_vecBytes[nByte];
+}
+
+size_t GameData::ByteProfile::GetPairCount(uint8_t nFirst, uint8_t nSecond) const
+{
+	return m_vecPairs[(nFirst << 8) | nSecond];
+}
+
+GameData::ByteProfile::Anchor_t GameData::ByteProfile::SelectAnchor(const Pattern &aPattern) const
+{
+	Anchor_t aResult;
+
+	const uint8_t *pBytes = aPattern.GetBytes(),
+	              *pMask = aPattern.GetMask();
+
+	size_t nLength = aPattern.GetLength();
+
+	bool bFound = false;
+
+	// The anchor is what memchr() runs on, so the rarest single byte comes first;
+	// the companion only decides which candidates reach the full match.
+	for(size_t n = 0; n < nLength; n++)
+	{
+		if(!pMask[n])
+		{
+			continue;
+		}
+
+		size_t nExpected = m_vecBytes[pBytes[n]],
+		       nCompanion = n;
+
+		if(n && pMask[n - 1] && GetPairCount(pBytes[n - 1], pBytes[n]) < nExpected)
+		{
+			nExpected = GetPairCount(pBytes[n - 1], pBytes[n]);
+			nCompanion = n - 1;
+		}
+
+		if(n + 1 < nLength && pMask[n + 1] && GetPairCount(pBytes[n], pBytes[n + 1]) < nExpected)
+		{
+			nExpected = GetPairCount(pBytes[n], pBytes[n + 1]);
+			nCompanion = n + 1;
+		}
+
+		size_t nBestByte = bFound ? m_vecBytes[pBytes[aResult.m_nOffset]] : 0;
+
+		if(!bFound || m_vecBytes[pBytes[n]] < nBestByte || (m_vecBytes[pBytes[n]] == nBestByte && nExpected < aResult.m_nExpected))
+		{
+			aResult.m_nOffset = n;
+			aResult.m_nCompanion = nCompanion;
+			aResult.m_nExpected = nExpected;
+
+			bFound = true;
+		}
+	}
+
+	aResult.m_flSelectivity = m_nTotal ? static_cast<double>(aResult.m_nExpected) / static_cast<double>(m_nTotal) : 1.0;
+
+	return aResult;
+}
@@ -0,0 +1,346 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/expression.hpp>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+	// Recursive descent, one function per precedence level.
+	class CExpressionParser
+	{
+	public:
+		CExpressionParser(const char *pszText, const GameData::ExpressionResolver_t &funcResolve)
+		 :  m_pszText(pszText),
+		    m_pszCur(pszText),
+		    m_funcResolve(funcResolve),
+		    m_nDepth(0),
+		    m_bUnresolved(false)
+		{
+		}
+
+	public:
+		bool Parse(int64_t &nResult)
+		{
+			if(!ParseOr(nResult))
+			{
+				return false;
+			}
+
+			SkipSpaces();
+
+			return !*m_pszCur || Fail("Unexpected character");
+		}
+
+		const std::string &GetError() const
+		{
+			return m_sError;
+		}
+
+		bool IsUnresolved() const
+		{
+			return m_bUnresolved;
+		}
+
+	protected:
+		struct Operator_t
+		{
+			const char *m_pszToken;
+			int64_t (*m_pfnApply)(int64_t nLeft, int64_t nRight);
+		}; // CExpressionParser::Operator_t
+
+		using Level_t = bool (CExpressionParser::*)(int64_t &nResult);
+
+		bool Fail(const char *pszMessage)
+		{
+			m_sError.assign(pszMessage).append(" at ").append(std::to_string(m_pszCur - m_pszText)).append(" in \"").append(m_pszText).append("\"");
+
+			return false;
+		}
+
+		void SkipSpaces()
+		{
+			while(isspace(static_cast<unsigned char>(*m_pszCur)))
+			{
+				m_pszCur++;
+			}
+		}
+
+		// Takes the longest of aOperators matching at the cursor.
+		const Operator_t *MatchOperator(const Operator_t *pOperators, size_t nCount)
+		{
+			SkipSpaces();
+
+			const Operator_t *pBest = nullptr;
+
+			size_t nBestLength = 0;
+
+			for(size_t n = 0; n < nCount; n++)
+			{
+				size_t nLength = strlen(pOperators[n].m_pszToken);
+
+				if(nLength > nBestLength && !strncmp(m_pszCur, pOperators[n].m_pszToken, nLength))
+				{
+					pBest = &pOperators[n];
+					nBestLength = nLength;
+				}
+			}
+
+			if(pBest)
+			{
+				m_pszCur += nBestLength;
+			}
+
+			return pBest;
+		}
+
+		template<size_t N>
+		bool ParseBinary(int64_t &nResult, Level_t pfnNext, const Operator_t (&aOperators)[N])
+		{
+			if(!(this->*pfnNext)(nResult))
+			{
+				return false;
+			}
+
+			while(const Operator_t *pOperator = MatchOperator(aOperators, N))
+			{
+				int64_t nRight;
+
+				if(!(this->*pfnNext)(nRight))
+				{
+					return false;
+				}
+
+				if(pOperator->m_pfnApply == Divide || pOperator->m_pfnApply == Modulo)
+				{
+					if(!nRight || (nResult == INT64_MIN && nRight == -1))
+					{
+						return Fail("Division overflow");
+					}
+				}
+
+				nResult = pOperator->m_pfnApply(nResult, nRight);
+			}
+
+			return true;
+		}
+
+		static int64_t Or(int64_t nLeft, int64_t nRight)           { return nLeft | nRight; }
+		static int64_t Xor(int64_t nLeft, int64_t nRight)          { return nLeft ^ nRight; }
+		static int64_t And(int64_t nLeft, int64_t nRight)          { return nLeft & nRight; }
+		static int64_t ShiftLeft(int64_t nLeft, int64_t nRight)    { return static_cast<int64_t>(static_cast<uint64_t>(nLeft) << (nRight & 63)); }
+		static int64_t ShiftRight(int64_t nLeft, int64_t nRight)   { return nLeft >> (nRight & 63); }
+		static int64_t Add(int64_t nLeft, int64_t nRight)          { return static_cast<int64_t>(static_cast<uint64_t>(nLeft) + static_cast<uint64_t>(nRight)); }
+		static int64_t Subtract(int64_t nLeft, int64_t nRight)     { return static_cast<int64_t>(static_cast<uint64_t>(nLeft) - static_cast<uint64_t>(nRight)); }
+		static int64_t Multiply(int64_t nLeft, int64_t nRight)     { return static_cast<int64_t>(static_cast<uint64_t>(nLeft) * static_cast<uint64_t>(nRight)); }
+		static int64_t Divide(int64_t nLeft, int64_t nRight)       { return nLeft / nRight; }
+		static int64_t Modulo(int64_t nLeft, int64_t nRight)       { return nLeft % nRight; }
+
+		bool ParseOr(int64_t &nResult)
+		{
+			static const Operator_t s_aOperators[] = {{"|", Or}};
+
+			return ParseBinary(nResult, &CExpressionParser::ParseXor, s_aOperators);
+		}
+
+		bool ParseXor(int64_t &nResult)
+		{
+			static const Operator_t s_aOperators[] = {{"^", Xor}};
+
+			return ParseBinary(nResult, &CExpressionParser::ParseAnd, s_aOperators);
+		}
+
+		bool ParseAnd(int64_t &nResult)
+		{
+			static const Operator_t s_aOperators[] = {{"&", And}};
+
+			return ParseBinary(nResult, &CExpressionParser::ParseShift, s_aOperators);
+		}
+
+		bool ParseShift(int64_t &nResult)
+		{
+			static const Operator_t s_aOperators[] = {{"<<", ShiftLeft}, {">>", ShiftRight}};
+
+			return ParseBinary(nResult, &CExpressionParser::ParseAdditive, s_aOperators);
+		}
+
+		bool ParseAdditive(int64_t &nResult)
+		{
+			static const Operator_t s_aOperators[] = {{"+", Add}, {"-", Subtract}};
+
+			return ParseBinary(nResult, &CExpressionParser::ParseMultiplicative, s_aOperators);
+		}
+
+		bool ParseMultiplicative(int64_t &nResult)
+		{
+			static const Operator_t s_aOperators[] = {{"*", Multiply}, {"/", Divide}, {"%", Modulo}};
+
+			return ParseBinary(nResult, &CExpressionParser::ParseUnary, s_aOperators);
+		}
+
+		// Every nesting, a unary operator or a parenthesis, recurses through here.
+		bool ParseUnary(int64_t &nResult)
+		{
+			if(m_nDepth == s_nMaxDepth)
+			{
+				return Fail("Expression too deep");
+			}
+
+			m_nDepth++;
+
+			bool bResult = ParseOperand(nResult);
+
+			m_nDepth--;
+
+			return bResult;
+		}
+
+		bool ParseOperand(int64_t &nResult)
+		{
+			SkipSpaces();
+
+			char cOperator = *m_pszCur;
+
+			if(cOperator == '-' || cOperator == '+' || cOperator == '~')
+			{
+				m_pszCur++;
+
+				if(!ParseUnary(nResult))
+				{
+					return false;
+				}
+
+				if(cOperator == '-')
+				{
+					nResult = Subtract(0, nResult);
+				}
+				else if(cOperator == '~')
+				{
+					nResult = ~nResult;
+				}
+
+				return true;
+			}
+
+			return ParsePrimary(nResult);
+		}
+
+		bool ParsePrimary(int64_t &nResult)
+		{
+			SkipSpaces();
+
+			if(*m_pszCur == '(')
+			{
+				m_pszCur++;
+
+				if(!ParseOr(nResult))
+				{
+					return false;
+				}
+
+				SkipSpaces();
+
+				if(*m_pszCur != ')')
+				{
+					return Fail("Expected \")\"");
+				}
+
+				m_pszCur++;
+
+				return true;
+			}
+
+			if(isdigit(static_cast<unsigned char>(*m_pszCur)))
+			{
+				char *pszEnd;
+
+				nResult = static_cast<int64_t>(strtoull(m_pszCur, &pszEnd, 0));
+
+				if(isalnum(static_cast<unsigned char>(*pszEnd)) || *pszEnd == '_')
+				{
+					return Fail("Malformed number");
+				}
+
+				m_pszCur = pszEnd;
+
+				return true;
+			}
+
+			if(isalpha(static_cast<unsigned char>(*m_pszCur)) || *m_pszCur == '_')
+			{
+				const char *pszStart = m_pszCur;
+
+				while(isalnum(static_cast<unsigned char>(*m_pszCur)) || *m_pszCur == '_' || *m_pszCur == ':' || *m_pszCur == '.')
+				{
+					m_pszCur++;
+				}
+
+				std::string sName(pszStart, m_pszCur - pszStart);
+
+				if(!m_funcResolve || !m_funcResolve(sName, nResult))
+				{
+					m_bUnresolved = true;
+					m_pszCur = pszStart;
+
+					return Fail(("Unknown \"" + sName + "\"").c_str());
+				}
+
+				return true;
+			}
+
+			return Fail(*m_pszCur ? "Unexpected character" : "Unexpected end");
+		}
+
+	private:
+		const char *m_pszText;
+		const char *m_pszCur;
+
+		const GameData::ExpressionResolver_t &m_funcResolve;
+
+		static constexpr size_t s_nMaxDepth = 256;
+
+		size_t m_nDepth;
+		bool m_bUnresolved;
+		std::string m_sError;
+	}; // CExpressionParser
+}; // namespace
+
+bool GameData::EvaluateExpression(const char *pszText, const ExpressionResolver_t &funcResolve, int64_t &nResult, std::string &sError, bool *pUnresolved)
+{
+	CExpressionParser aParser(pszText, funcResolve);
+
+	bool bResult = aParser.Parse(nResult);
+
+	if(!bResult)
+	{
+		sError = aParser.GetError();
+	}
+
+	if(pUnresolved)
+	{
+		*pUnresolved = aParser.IsUnresolved();
+	}
+
+	return bResult;
+}
@@ -0,0 +1,587 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/filegamedata.hpp>
+
+#include "formats.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if !defined(_WIN32)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+using namespace GameData::Formats;
+
+static uint32_t ReadBigEndian32(const uint8_t *pData)
+{
+	return (static_cast<uint32_t>(pData[0]) << 24) | (static_cast<uint32_t>(pData[1]) << 16) | (static_cast<uint32_t>(pData[2]) << 8) | pData[3];
+}
+
+class CMappedFile
+{
+public:
+	CMappedFile()
+	 :  m_pData(nullptr),
+	    m_nSize(0)
+	{
+	}
+
+	~CMappedFile()
+	{
+#if defined(_WIN32)
+		delete[] m_pData;
+#else
+		if(m_pData)
+		{
+			munmap(m_pData, m_nSize);
+		}
+#endif
+	}
+
+	bool Open(const char *pszPath)
+	{
+#if defined(_WIN32)
+		FILE *pFile = fopen(pszPath, "rb");
+
+		if(!pFile)
+		{
+			return false;
+		}
+
+		fseek(pFile, 0, SEEK_END);
+
+		long nSize = ftell(pFile);
+
+		fseek(pFile, 0, SEEK_SET);
+
+		if(nSize > 0)
+		{
+			m_nSize = static_cast<size_t>(nSize);
+			m_pData = new uint8_t[m_nSize];
+
+			if(fread(m_pData, 1, m_nSize, pFile) != m_nSize)
+			{
+				delete[] m_pData;
+
+				m_pData = nullptr;
+			}
+		}
+
+		fclose(pFile);
+
+		return m_pData != nullptr;
+#else
+		int iFile = open(pszPath, O_RDONLY | O_CLOEXEC);
+
+		if(iFile < 0)
+		{
+			return false;
+		}
+
+		struct stat aStat;
+
+		if(fstat(iFile, &aStat) || aStat.st_size <= 0)
+		{
+			close(iFile);
+
+			return false;
+		}
+
+		void *pData = mmap(nullptr, static_cast<size_t>(aStat.st_size), PROT_READ, MAP_PRIVATE, iFile, 0);
+
+		close(iFile);
+
+		if(pData == MAP_FAILED)
+		{
+			return false;
+		}
+
+		m_pData = reinterpret_cast<uint8_t *>(pData);
+		m_nSize = static_cast<size_t>(aStat.st_size);
+
+		return true;
+#endif
+	}
+
+	const uint8_t *GetData() const
+	{
+		return m_pData;
+	}
+
+	size_t GetSize() const
+	{
+		return m_nSize;
+	}
+
+private:
+	uint8_t *m_pData;
+	size_t m_nSize;
+};
+
+bool GameData::FileModuleImage::Load(const char *pszPath, std::string &sError)
+{
+	Release();
+
+	m_sPath = pszPath;
+
+	CMappedFile aFile;
+
+	if(!aFile.Open(pszPath))
+	{
+		sError = "Failed to open \"" + m_sPath + "\"";
+
+		return false;
+	}
+
+	const uint8_t *pFile = aFile.GetData();
+
+	size_t nFileSize = aFile.GetSize();
+
+	bool bLaidOut;
+
+	if(nFileSize >= sizeof(ELF::s_aMagic) && !memcmp(pFile, ELF::s_aMagic, sizeof(ELF::s_aMagic)))
+	{
+		bLaidOut = LayoutELF(pFile, nFileSize, sError);
+	}
+	else if(nFileSize >= sizeof(uint16_t) && Read<uint16_t>(pFile) == PE::DOS_MAGIC)
+	{
+		bLaidOut = LayoutPE(pFile, nFileSize, sError);
+	}
+	else if(nFileSize >= sizeof(uint32_t) && (Read<uint32_t>(pFile) == MachO::MAGIC_64 || ReadBigEndian32(pFile) == MachO::FAT_MAGIC))
+	{
+		bLaidOut = LayoutMachO(pFile, nFileSize, sError);
+	}
+	else
+	{
+		sError = "Unknown image format of \"" + m_sPath + "\"";
+
+		return false;
+	}
+
+	if(!bLaidOut)
+	{
+		sError += " in \"" + m_sPath + "\"";
+
+		return false;
+	}
+
+	if(!Init(m_pMemory, m_nMemorySize, false))
+	{
+		sError = "Failed to parse the laid out \"" + m_sPath + "\"";
+
+		return false;
+	}
+
+	return true;
+}
+
+const std::string &GameData::FileModuleImage::GetPath() const
+{
+	return m_sPath;
+}
+
+bool GameData::FileModuleImage::LayoutELF(const uint8_t *pFile, size_t nFileSize, std::string &sError)
+{
+	if(nFileSize < sizeof(ELF::Ehdr_t))
+	{
+		sError = "Truncated ELF header";
+
+		return false;
+	}
+
+	const auto aHeader = Read<ELF::Ehdr_t>(pFile);
+
+	if(aHeader.e_ident[4] != ELF::CLASS_64 || aHeader.e_phentsize != sizeof(ELF::Phdr_t) ||
+	   aHeader.e_phoff > nFileSize || aHeader.e_phnum * sizeof(ELF::Phdr_t) > nFileSize - aHeader.e_phoff)
+	{
+		sError = "Unsupported ELF layout";
+
+		return false;
+	}
+
+	std::vector<ELF::Phdr_t> vecLoads;
+
+	uintptr_t nMinAddress = UINTPTR_MAX,
+	          nMaxAddress = 0;
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(pFile + aHeader.e_phoff + n * sizeof(ELF::Phdr_t));
+
+		if(aProgram.p_type == ELF::PT_LOAD)
+		{
+			nMinAddress = std::min<uintptr_t>(nMinAddress, aProgram.p_vaddr & ~static_cast<uint64_t>(0xFFF));
+			nMaxAddress = std::max<uintptr_t>(nMaxAddress, aProgram.p_vaddr + aProgram.p_memsz);
+			vecLoads.push_back(aProgram);
+		}
+	}
+
+	if(nMaxAddress <= nMinAddress)
+	{
+		sError = "No loadable segments";
+
+		return false;
+	}
+
+	if(!Allocate(nMaxAddress - nMinAddress))
+	{
+		sError = "Failed to allocate the image";
+
+		return false;
+	}
+
+	for(const auto &it : vecLoads)
+	{
+		// The loader maps whole pages, so the bytes before an unaligned start come along.
+		uint64_t nPageDelta = it.p_vaddr & 0xFFF;
+
+		if(it.p_offset < nPageDelta || it.p_offset - nPageDelta > nFileSize)
+		{
+			continue;
+		}
+
+		uint64_t nOffset = it.p_offset - nPageDelta,
+		         nTarget = it.p_vaddr - nPageDelta - nMinAddress,
+		         nLength = std::min<uint64_t>({it.p_filesz + nPageDelta, it.p_memsz + nPageDelta, nFileSize - nOffset, m_nMemorySize - nTarget});
+
+		memcpy(m_pMemory + nTarget, pFile + nOffset, nLength);
+	}
+
+	RelocateELF();
+
+	return true;
+}
+
+bool GameData::FileModuleImage::LayoutPE(const uint8_t *pFile, size_t nFileSize, std::string &sError)
+{
+	if(nFileSize < PE::DOS_LFANEW_OFFSET + sizeof(uint32_t))
+	{
+		sError = "Truncated DOS header";
+
+		return false;
+	}
+
+	uint32_t nNTOffset = Read<uint32_t>(pFile + PE::DOS_LFANEW_OFFSET);
+
+	size_t nOptionalOffset = static_cast<size_t>(nNTOffset) + sizeof(uint32_t) + sizeof(PE::FileHeader_t);
+
+	if(nOptionalOffset + PE::OPTIONAL_DATA_DIRECTORY > nFileSize || Read<uint32_t>(pFile + nNTOffset) != PE::NT_SIGNATURE)
+	{
+		sError = "Truncated NT headers";
+
+		return false;
+	}
+
+	const auto aFileHeader = Read<PE::FileHeader_t>(pFile + nNTOffset + sizeof(uint32_t));
+
+	const uint8_t *pOptionalHeader = pFile + nOptionalOffset;
+
+	if(Read<uint16_t>(pOptionalHeader) != PE::OPTIONAL_MAGIC_64)
+	{
+		sError = "Not a PE32+ image";
+
+		return false;
+	}
+
+	uint64_t nImageBase = Read<uint64_t>(pOptionalHeader + PE::OPTIONAL_IMAGE_BASE);
+
+	uint32_t nImageSize = Read<uint32_t>(pOptionalHeader + PE::OPTIONAL_SIZE_OF_IMAGE),
+	         nHeadersSize = Read<uint32_t>(pOptionalHeader + PE::OPTIONAL_SIZE_OF_HEADERS);
+
+	size_t nSectionsOffset = nOptionalOffset + aFileHeader.SizeOfOptionalHeader;
+
+	if(!nImageSize || nSectionsOffset + aFileHeader.NumberOfSections * sizeof(PE::SectionHeader_t) > nFileSize)
+	{
+		sError = "Truncated section table";
+
+		return false;
+	}
+
+	if(!Allocate(nImageSize))
+	{
+		sError = "Failed to allocate the image";
+
+		return false;
+	}
+
+	memcpy(m_pMemory, pFile, std::min<size_t>({nHeadersSize, nImageSize, nFileSize}));
+
+	for(uint16_t n = 0; n < aFileHeader.NumberOfSections; n++)
+	{
+		const auto aSection = Read<PE::SectionHeader_t>(pFile + nSectionsOffset + n * sizeof(PE::SectionHeader_t));
+
+		if(aSection.PointerToRawData >= nFileSize || aSection.VirtualAddress >= nImageSize)
+		{
+			continue;
+		}
+
+		size_t nLength = std::min<size_t>({aSection.SizeOfRawData, nFileSize - aSection.PointerToRawData, nImageSize - aSection.VirtualAddress});
+
+		if(aSection.VirtualSize)
+		{
+			nLength = std::min<size_t>(nLength, aSection.VirtualSize);
+		}
+
+		memcpy(m_pMemory + aSection.VirtualAddress, pFile + aSection.PointerToRawData, nLength);
+	}
+
+	uint32_t nDirectoryCount = Read<uint32_t>(pOptionalHeader + PE::OPTIONAL_NUMBER_OF_RVA_AND_SIZES);
+
+	if(PE::DIRECTORY_BASERELOC < nDirectoryCount && nOptionalOffset + PE::OPTIONAL_DATA_DIRECTORY + (PE::DIRECTORY_BASERELOC + 1) * sizeof(PE::DataDirectory_t) <= nFileSize)
+	{
+		const auto aRelocs = Read<PE::DataDirectory_t>(pOptionalHeader + PE::OPTIONAL_DATA_DIRECTORY + PE::DIRECTORY_BASERELOC * sizeof(PE::DataDirectory_t));
+
+		RelocatePE(aRelocs.VirtualAddress, aRelocs.Size, nImageBase);
+	}
+
+	return true;
+}
+
+bool GameData::FileModuleImage::LayoutMachO(const uint8_t *pFile, size_t nFileSize, std::string &sError)
+{
+	if(ReadBigEndian32(pFile) == MachO::FAT_MAGIC)
+	{
+		if(nFileSize < sizeof(MachO::FatHeader_t))
+		{
+			sError = "Truncated fat header";
+
+			return false;
+		}
+
+		uint32_t nArchs = ReadBigEndian32(pFile + offsetof(MachO::FatHeader_t, nfat_arch));
+
+		for(uint32_t n = 0; n < nArchs; n++)
+		{
+			const uint8_t *pArch = pFile + sizeof(MachO::FatHeader_t) + n * sizeof(MachO::FatArch_t);
+
+			if(pArch + sizeof(MachO::FatArch_t) > pFile + nFileSize)
+			{
+				break;
+			}
+
+			uint32_t nOffset = ReadBigEndian32(pArch + offsetof(MachO::FatArch_t, offset)),
+			         nSize = ReadBigEndian32(pArch + offsetof(MachO::FatArch_t, size));
+
+			if(static_cast<int32_t>(ReadBigEndian32(pArch + offsetof(MachO::FatArch_t, cputype))) == MachO::CPU_TYPE_X86_64 &&
+			   nOffset < nFileSize && nSize <= nFileSize - nOffset)
+			{
+				return LayoutMachO(pFile + nOffset, nSize, sError);
+			}
+		}
+
+		sError = "No x86-64 slice";
+
+		return false;
+	}
+
+	if(nFileSize < sizeof(MachO::Header_t))
+	{
+		sError = "Truncated Mach-O header";
+
+		return false;
+	}
+
+	const auto aHeader = Read<MachO::Header_t>(pFile);
+
+	if(aHeader.magic != MachO::MAGIC_64 || aHeader.sizeofcmds > nFileSize - sizeof(MachO::Header_t))
+	{
+		sError = "Unsupported Mach-O layout";
+
+		return false;
+	}
+
+	const uint8_t *pCommands = pFile + sizeof(MachO::Header_t),
+	              *pCommandsEnd = pCommands + aHeader.sizeofcmds;
+
+	std::vector<MachO::SegmentCommand_t> vecSegments;
+
+	uint64_t nBase = 0,
+	         nEnd = 0;
+
+	bool bHasBase = false;
+
+	for(const uint8_t *pCommand = pCommands; pCommand + sizeof(MachO::LoadCommand_t) <= pCommandsEnd; )
+	{
+		const auto aCommand = Read<MachO::LoadCommand_t>(pCommand);
+
+		if(aCommand.cmdsize < sizeof(MachO::LoadCommand_t) || pCommand + aCommand.cmdsize > pCommandsEnd)
+		{
+			break;
+		}
+
+		if(aCommand.cmd == MachO::LC_SEGMENT_64 && aCommand.cmdsize >= sizeof(MachO::SegmentCommand_t))
+		{
+			const auto aSegment = Read<MachO::SegmentCommand_t>(pCommand);
+
+			// __PAGEZERO and friends reserve address space only.
+			if(aSegment.initprot)
+			{
+				if(aSegment.fileoff == 0 && aSegment.filesize)
+				{
+					nBase = aSegment.vmaddr;
+					bHasBase = true;
+				}
+
+				nEnd = std::max<uint64_t>(nEnd, aSegment.vmaddr + aSegment.vmsize);
+				vecSegments.push_back(aSegment);
+			}
+		}
+
+		pCommand += aCommand.cmdsize;
+	}
+
+	if(!bHasBase || nEnd <= nBase)
+	{
+		sError = "No mapped segments";
+
+		return false;
+	}
+
+	if(!Allocate(nEnd - nBase))
+	{
+		sError = "Failed to allocate the image";
+
+		return false;
+	}
+
+	for(const auto &it : vecSegments)
+	{
+		if(it.vmaddr < nBase || it.fileoff >= nFileSize)
+		{
+			continue;
+		}
+
+		size_t nLength = std::min<uint64_t>({it.filesize, it.vmsize, nFileSize - it.fileoff});
+
+		memcpy(m_pMemory + (it.vmaddr - nBase), pFile + it.fileoff, nLength);
+	}
+
+	return true;
+}
+
+GameData::FileGameData::FileGameData()
+{
+}
+
+const DynLibUtils::CModule *GameData::FileGameData::FindLibrary(const char *) const
+{
+	return nullptr;
+}
+
+const GameData::ModuleImage *GameData::FileGameData::FindLibraryImage(const char *pszName) const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	auto itFound = m_mapImages.find(pszName);
+
+	if(itFound != m_mapImages.end())
+	{
+		return itFound->second.get();
+	}
+
+	std::vector<std::string> vecPaths;
+
+	GetCandidates(pszName, vecPaths);
+
+	std::unique_ptr<FileModuleImage> pImage;
+
+	std::string sError = "No file found for \"" + std::string(pszName) + "\"";
+
+	for(const auto &sPath : vecPaths)
+	{
+		auto pCandidate = std::make_unique<FileModuleImage>();
+
+		std::string sCandidateError;
+
+		if(pCandidate->Load(sPath.c_str(), sCandidateError))
+		{
+			pImage = std::move(pCandidate);
+
+			break;
+		}
+
+		// A candidate which does not exist is silent; a broken one is the error to report.
+		if(sCandidateError.compare(0, 14, "Failed to open"))
+		{
+			sError = sCandidateError;
+		}
+	}
+
+	if(!pImage)
+	{
+		m_sLastError = sError;
+	}
+
+	return (m_mapImages[pszName] = std::move(pImage)).get();
+}
+
+void GameData::FileGameData::AddSearchPath(const char *pszPath)
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	m_vecSearchPaths.emplace_back(pszPath);
+}
+
+void GameData::FileGameData::AddLibrary(const char *pszName, const char *pszPath)
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	m_mapPaths[pszName] = pszPath;
+	m_mapImages.erase(pszName);
+}
+
+std::string GameData::FileGameData::GetLastError() const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	return m_sLastError;
+}
+
+void GameData::FileGameData::GetCandidates(const char *pszName, std::vector<std::string> &vecPaths) const
+{
+	auto itPath = m_mapPaths.find(pszName);
+
+	if(itPath != m_mapPaths.end())
+	{
+		vecPaths.push_back(itPath->second);
+
+		return;
+	}
+
+	// "server" -> "server", "libserver.so", "server.so", "server.dll", "libserver.dylib", "server.dylib".
+	const std::string sName = pszName;
+	const std::string aFileNames[] = {sName, "lib" + sName + ".so", sName + ".so", sName + ".dll", "lib" + sName + ".dylib", sName + ".dylib"};
+
+	for(const auto &sSearchPath : m_vecSearchPaths)
+	{
+		for(const auto &sFileName : aFileNames)
+		{
+			vecPaths.push_back(sSearchPath + '/' + sFileName);
+		}
+	}
+}
@@ -0,0 +1,254 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/fingerprint.hpp>
+#include <gamedata/hash.hpp>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#define GAMEDATA_FINGERPRINT_PAGE_SIZE 4096
+#define GAMEDATA_FINGERPRINT_SAMPLED_PAGES 16
+
+static const char *s_pszSourcePrefixes[GameData::Fingerprint::SOURCE_MAX] =
+{
+	"id", // GameData::Fingerprint::SOURCE_BUILD_ID
+	"ch", // GameData::Fingerprint::SOURCE_CONTENT_HASH
+};
+
+static const GameData::Fingerprint s_aInvalidFingerprint;
+
+GameData::Fingerprint::Fingerprint()
+ :  m_eSource(SOURCE_UNKNOWN),
+    m_aData {},
+    m_nLength(0)
+{
+}
+
+GameData::Fingerprint::Fingerprint(const ModuleImage &aImage)
+ :  Fingerprint()
+{
+	size_t nBuildIdLength;
+
+	const uint8_t *pBuildId = aImage.GetBuildId(nBuildIdLength);
+
+	if(pBuildId)
+	{
+		m_eSource = SOURCE_BUILD_ID;
+		m_nLength = std::min(nBuildIdLength, sizeof(m_aData));
+
+		memcpy(m_aData, pBuildId, m_nLength);
+
+		return;
+	}
+
+	ComputeContentHash(aImage);
+}
+
+bool GameData::Fingerprint::IsValid() const
+{
+	return m_eSource != SOURCE_UNKNOWN;
+}
+
+GameData::Fingerprint::Source GameData::Fingerprint::GetSource() const
+{
+	return m_eSource;
+}
+
+const uint8_t *GameData::Fingerprint::GetData() const
+{
+	return m_aData;
+}
+
+size_t GameData::Fingerprint::GetLength() const
+{
+	return m_nLength;
+}
+
+bool GameData::Fingerprint::operator==(const Fingerprint &aOther) const
+{
+	return m_eSource == aOther.m_eSource && m_nLength == aOther.m_nLength && !memcmp(m_aData, aOther.m_aData, m_nLength);
+}
+
+bool GameData::Fingerprint::operator!=(const Fingerprint &aOther) const
+{
+	return !(*this == aOther);
+}
+
+const char *GameData::Fingerprint::ToString(char *pszBuffer, size_t nMaxLength) const
+{
+	if(!nMaxLength)
+	{
+		return pszBuffer;
+	}
+
+	pszBuffer[0] = '\0';
+
+	if(!IsValid())
+	{
+		return pszBuffer;
+	}
+
+	size_t nWritten = snprintf(pszBuffer, nMaxLength, "%s:", s_pszSourcePrefixes[m_eSource]);
+
+	for(size_t n = 0; n < m_nLength && nWritten + 2 < nMaxLength; n++)
+	{
+		nWritten += snprintf(&pszBuffer[nWritten], nMaxLength - nWritten, "%02x", m_aData[n]);
+	}
+
+	return pszBuffer;
+}
+
+bool GameData::Fingerprint::FromString(const char *pszValue)
+{
+	*this = Fingerprint();
+
+	const char *pszData = strchr(pszValue, ':');
+
+	if(!pszData)
+	{
+		return false;
+	}
+
+	Source eSource = SOURCE_UNKNOWN;
+
+	for(int n = SOURCE_FIRST; n < SOURCE_MAX; n++)
+	{
+		const char *pszPrefix = s_pszSourcePrefixes[n];
+
+		if(static_cast<size_t>(pszData - pszValue) == strlen(pszPrefix) && !strncmp(pszValue, pszPrefix, pszData - pszValue))
+		{
+			eSource = static_cast<Source>(n);
+
+			break;
+		}
+	}
+
+	if(eSource == SOURCE_UNKNOWN)
+	{
+		return false;
+	}
+
+	pszData++;
+
+	size_t nLength = strlen(pszData);
+
+	if(nLength % 2 || nLength / 2 > sizeof(m_aData))
+	{
+		return false;
+	}
+
+	for(size_t n = 0; n < nLength / 2; n++)
+	{
+		unsigned int nByte;
+
+		if(sscanf(&pszData[n * 2], "%2x", &nByte) != 1)
+		{
+			*this = Fingerprint();
+
+			return false;
+		}
+
+		m_aData[n] = static_cast<uint8_t>(nByte);
+	}
+
+	m_eSource = eSource;
+	m_nLength = nLength / 2;
+
+	return true;
+}
+
+void GameData::Fingerprint::ComputeContentHash(const ModuleImage &aImage)
+{
+	const auto &vecSegments = aImage.GetSegments();
+
+	if(vecSegments.empty())
+	{
+		return;
+	}
+
+	// Two seeds give a 128-bit digest over the same samples.
+	Hash64 aLow(0), aHigh(aImage.GetSize());
+
+	auto funcUpdate = [&](const void *pData, size_t nLength)
+	{
+		aLow.Update(pData, nLength);
+		aHigh.Update(pData, nLength);
+	};
+
+	int nFormat = aImage.GetFormat();
+
+	uint64_t nSize = aImage.GetSize();
+
+	funcUpdate(&nFormat, sizeof(nFormat));
+	funcUpdate(&nSize, sizeof(nSize));
+
+	for(const auto &it : vecSegments)
+	{
+		uint64_t aEntry[3] = {it.m_nRVA, it.m_nSize, static_cast<uint64_t>(it.m_nFlags)};
+
+		funcUpdate(aEntry, sizeof(aEntry));
+	}
+
+	funcUpdate(aImage.GetBase(), std::min<size_t>(vecSegments.front().m_nSize, GAMEDATA_FINGERPRINT_PAGE_SIZE));
+
+	// PE images get rebased in place, so past the headers their bytes differ per process.
+	if(aImage.GetFormat() != IMAGE_FORMAT_PE)
+	{
+		for(const auto &it : vecSegments)
+		{
+			if(!it.IsReadOnly())
+			{
+				continue;
+			}
+
+			size_t nPages = (it.m_nSize + GAMEDATA_FINGERPRINT_PAGE_SIZE - 1) / GAMEDATA_FINGERPRINT_PAGE_SIZE,
+			       nSamples = std::min<size_t>(nPages, GAMEDATA_FINGERPRINT_SAMPLED_PAGES);
+
+			for(size_t n = 0; n < nSamples; n++)
+			{
+				size_t nPage = nSamples > 1 ? n * (nPages - 1) / (nSamples - 1) : 0,
+				       nOffset = nPage * GAMEDATA_FINGERPRINT_PAGE_SIZE;
+
+				funcUpdate(aImage.GetPointer(it.m_nRVA + nOffset), std::min<size_t>(it.m_nSize - nOffset, GAMEDATA_FINGERPRINT_PAGE_SIZE));
+			}
+		}
+	}
+
+	uint64_t aDigest[2] = {aLow.Digest(), aHigh.Digest()};
+
+	m_eSource = SOURCE_CONTENT_HASH;
+	m_nLength = sizeof(aDigest);
+
+	memcpy(m_aData, aDigest, sizeof(aDigest));
+}
+
+const GameData::Fingerprint &GameData::GetModuleFingerprint(const ModuleImage *pImage)
+{
+	return pImage ? pImage->GetIndex<Fingerprint>() : s_aInvalidFingerprint;
+}
+
+const GameData::Fingerprint &GameData::GetModuleFingerprint(const DynLibUtils::CModule *pModule)
+{
+	return GetModuleFingerprint(GetModuleImage(pModule));
+}
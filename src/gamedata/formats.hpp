@@ -0,0 +1,365 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_GAMEDATA_FORMATS_HPP_
+#define _INCLUDE_GAMEDATA_FORMATS_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+// Own copies of the on-disk layouts, so every format is readable on every host.
+namespace GameData
+{
+	namespace Formats
+	{
+		template<typename T>
+		inline T Read(const void *pData)
+		{
+			T aResult;
+
+			memcpy(&aResult, pData, sizeof(T));
+
+			return aResult;
+		}
+
+		namespace ELF
+		{
+			static constexpr uint8_t s_aMagic[4] = {0x7F, 'E', 'L', 'F'};
+
+			static constexpr uint8_t CLASS_64 = 2;
+			static constexpr uint16_t MACHINE_X86_64 = 62;
+
+			static constexpr uint32_t PT_LOAD = 1;
+			static constexpr uint32_t PT_DYNAMIC = 2;
+			static constexpr uint32_t PT_NOTE = 4;
+			static constexpr uint32_t PT_GNU_EH_FRAME = 0x6474E550;
+
+			static constexpr uint32_t PF_X = 1;
+			static constexpr uint32_t PF_W = 2;
+			static constexpr uint32_t PF_R = 4;
+
+			static constexpr uint32_t NT_GNU_BUILD_ID = 3;
+
+			static constexpr int64_t DT_NULL = 0;
+			static constexpr int64_t DT_PLTRELSZ = 2;
+			static constexpr int64_t DT_HASH = 4;
+			static constexpr int64_t DT_STRTAB = 5;
+			static constexpr int64_t DT_SYMTAB = 6;
+			static constexpr int64_t DT_RELA = 7;
+			static constexpr int64_t DT_RELASZ = 8;
+			static constexpr int64_t DT_STRSZ = 10;
+			static constexpr int64_t DT_SONAME = 14;
+			static constexpr int64_t DT_JMPREL = 23;
+			static constexpr int64_t DT_RELRSZ = 35;
+			static constexpr int64_t DT_RELR = 36;
+			static constexpr int64_t DT_GNU_HASH = 0x6FFFFEF5;
+			static constexpr int64_t DT_VERSYM = 0x6FFFFFF0;
+
+			static constexpr uint16_t SHN_UNDEF = 0;
+			static constexpr uint16_t VERSYM_HIDDEN = 0x8000;
+
+			static constexpr uint32_t R_X86_64_64 = 1;
+			static constexpr uint32_t R_X86_64_GLOB_DAT = 6;
+			static constexpr uint32_t R_X86_64_JUMP_SLOT = 7;
+			static constexpr uint32_t R_X86_64_RELATIVE = 8;
+			static constexpr uint32_t R_X86_64_IRELATIVE = 37;
+
+			struct Ehdr_t
+			{
+				uint8_t e_ident[16];
+				uint16_t e_type;
+				uint16_t e_machine;
+				uint32_t e_version;
+				uint64_t e_entry;
+				uint64_t e_phoff;
+				uint64_t e_shoff;
+				uint32_t e_flags;
+				uint16_t e_ehsize;
+				uint16_t e_phentsize;
+				uint16_t e_phnum;
+				uint16_t e_shentsize;
+				uint16_t e_shnum;
+				uint16_t e_shstrndx;
+			}; // GameData::Formats::ELF::Ehdr_t
+
+			struct Phdr_t
+			{
+				uint32_t p_type;
+				uint32_t p_flags;
+				uint64_t p_offset;
+				uint64_t p_vaddr;
+				uint64_t p_paddr;
+				uint64_t p_filesz;
+				uint64_t p_memsz;
+				uint64_t p_align;
+			}; // GameData::Formats::ELF::Phdr_t
+
+			struct Nhdr_t
+			{
+				uint32_t n_namesz;
+				uint32_t n_descsz;
+				uint32_t n_type;
+			}; // GameData::Formats::ELF::Nhdr_t
+
+			struct Dyn_t
+			{
+				int64_t d_tag;
+				uint64_t d_val;
+			}; // GameData::Formats::ELF::Dyn_t
+
+			struct Rela_t
+			{
+				uint64_t r_offset;
+				uint64_t r_info;
+				int64_t r_addend;
+
+				uint32_t GetType() const
+				{
+					return static_cast<uint32_t>(r_info);
+				}
+
+				uint32_t GetSymbol() const
+				{
+					return static_cast<uint32_t>(r_info >> 32);
+				}
+			}; // GameData::Formats::ELF::Rela_t
+
+			struct Sym_t
+			{
+				uint32_t st_name;
+				uint8_t st_info;
+				uint8_t st_other;
+				uint16_t st_shndx;
+				uint64_t st_value;
+				uint64_t st_size;
+			}; // GameData::Formats::ELF::Sym_t
+		}; // GameData::Formats::ELF
+
+		namespace PE
+		{
+			static constexpr uint16_t DOS_MAGIC = 0x5A4D; // "MZ"
+			static constexpr uint32_t NT_SIGNATURE = 0x00004550; // "PE\0\0"
+			static constexpr uint16_t OPTIONAL_MAGIC_64 = 0x20B;
+
+			static constexpr uint32_t DOS_LFANEW_OFFSET = 0x3C;
+
+			static constexpr uint32_t DIRECTORY_EXPORT = 0;
+			static constexpr uint32_t DIRECTORY_IMPORT = 1;
+			static constexpr uint32_t DIRECTORY_EXCEPTION = 3;
+			static constexpr uint32_t DIRECTORY_BASERELOC = 5;
+			static constexpr uint32_t DIRECTORY_DEBUG = 6;
+
+			static constexpr uint32_t SCN_MEM_EXECUTE = 0x20000000;
+			static constexpr uint32_t SCN_MEM_READ = 0x40000000;
+			static constexpr uint32_t SCN_MEM_WRITE = 0x80000000;
+
+			static constexpr uint32_t DEBUG_TYPE_CODEVIEW = 2;
+			static constexpr uint32_t CODEVIEW_RSDS = 0x53445352; // "RSDS"
+
+			static constexpr uint16_t REL_BASED_ABSOLUTE = 0;
+			static constexpr uint16_t REL_BASED_DIR64 = 10;
+
+			struct FileHeader_t
+			{
+				uint16_t Machine;
+				uint16_t NumberOfSections;
+				uint32_t TimeDateStamp;
+				uint32_t PointerToSymbolTable;
+				uint32_t NumberOfSymbols;
+				uint16_t SizeOfOptionalHeader;
+				uint16_t Characteristics;
+			}; // GameData::Formats::PE::FileHeader_t
+
+			struct DataDirectory_t
+			{
+				uint32_t VirtualAddress;
+				uint32_t Size;
+			}; // GameData::Formats::PE::DataDirectory_t
+
+			// PE32+ optional header offsets.
+			static constexpr uint32_t OPTIONAL_IMAGE_BASE = 24;
+			static constexpr uint32_t OPTIONAL_SIZE_OF_IMAGE = 56;
+			static constexpr uint32_t OPTIONAL_SIZE_OF_HEADERS = 60;
+			static constexpr uint32_t OPTIONAL_NUMBER_OF_RVA_AND_SIZES = 108;
+			static constexpr uint32_t OPTIONAL_DATA_DIRECTORY = 112;
+
+			struct SectionHeader_t
+			{
+				char Name[8];
+				uint32_t VirtualSize;
+				uint32_t VirtualAddress;
+				uint32_t SizeOfRawData;
+				uint32_t PointerToRawData;
+				uint32_t PointerToRelocations;
+				uint32_t PointerToLinenumbers;
+				uint16_t NumberOfRelocations;
+				uint16_t NumberOfLinenumbers;
+				uint32_t Characteristics;
+			}; // GameData::Formats::PE::SectionHeader_t
+
+			struct DebugDirectory_t
+			{
+				uint32_t Characteristics;
+				uint32_t TimeDateStamp;
+				uint16_t MajorVersion;
+				uint16_t MinorVersion;
+				uint32_t Type;
+				uint32_t SizeOfData;
+				uint32_t AddressOfRawData;
+				uint32_t PointerToRawData;
+			}; // GameData::Formats::PE::DebugDirectory_t
+
+			struct ExportDirectory_t
+			{
+				uint32_t Characteristics;
+				uint32_t TimeDateStamp;
+				uint16_t MajorVersion;
+				uint16_t MinorVersion;
+				uint32_t Name;
+				uint32_t Base;
+				uint32_t NumberOfFunctions;
+				uint32_t NumberOfNames;
+				uint32_t AddressOfFunctions;
+				uint32_t AddressOfNames;
+				uint32_t AddressOfNameOrdinals;
+			}; // GameData::Formats::PE::ExportDirectory_t
+
+			struct RuntimeFunction_t
+			{
+				uint32_t BeginAddress;
+				uint32_t EndAddress;
+				uint32_t UnwindData;
+			}; // GameData::Formats::PE::RuntimeFunction_t
+
+			struct ImportDescriptor_t
+			{
+				uint32_t OriginalFirstThunk; // Lookup table: IMPORT_ORDINAL_FLAG | ordinal, or the RVA of { uint16_t hint, char name[] }.
+				uint32_t TimeDateStamp;
+				uint32_t ForwarderChain;
+				uint32_t Name;
+				uint32_t FirstThunk; // Address table, written by the loader.
+			}; // GameData::Formats::PE::ImportDescriptor_t
+
+			static constexpr uint64_t IMPORT_ORDINAL_FLAG = 0x8000000000000000;
+
+			struct BaseRelocation_t
+			{
+				uint32_t VirtualAddress;
+				uint32_t SizeOfBlock;
+			}; // GameData::Formats::PE::BaseRelocation_t
+		}; // GameData::Formats::PE
+
+		namespace MachO
+		{
+			static constexpr uint32_t MAGIC_64 = 0xFEEDFACF;
+			static constexpr uint32_t FAT_MAGIC = 0xCAFEBABE; // Big-endian, as the whole fat header.
+
+			static constexpr int32_t CPU_TYPE_X86_64 = 0x01000007;
+
+			static constexpr uint32_t LC_SEGMENT_64 = 0x19;
+			static constexpr uint32_t LC_UUID = 0x1B;
+
+			static constexpr int32_t VM_PROT_READ = 1;
+			static constexpr int32_t VM_PROT_WRITE = 2;
+			static constexpr int32_t VM_PROT_EXECUTE = 4;
+
+			struct Header_t
+			{
+				uint32_t magic;
+				int32_t cputype;
+				int32_t cpusubtype;
+				uint32_t filetype;
+				uint32_t ncmds;
+				uint32_t sizeofcmds;
+				uint32_t flags;
+				uint32_t reserved;
+			}; // GameData::Formats::MachO::Header_t
+
+			struct FatHeader_t
+			{
+				uint32_t magic;
+				uint32_t nfat_arch;
+			}; // GameData::Formats::MachO::FatHeader_t
+
+			struct FatArch_t
+			{
+				int32_t cputype;
+				int32_t cpusubtype;
+				uint32_t offset;
+				uint32_t size;
+				uint32_t align;
+			}; // GameData::Formats::MachO::FatArch_t
+
+			struct LoadCommand_t
+			{
+				uint32_t cmd;
+				uint32_t cmdsize;
+			}; // GameData::Formats::MachO::LoadCommand_t
+
+			struct SegmentCommand_t
+			{
+				uint32_t cmd;
+				uint32_t cmdsize;
+				char segname[16];
+				uint64_t vmaddr;
+				uint64_t vmsize;
+				uint64_t fileoff;
+				uint64_t filesize;
+				int32_t maxprot;
+				int32_t initprot;
+				uint32_t nsects;
+				uint32_t flags;
+			}; // GameData::Formats::MachO::SegmentCommand_t
+
+			struct UUIDCommand_t
+			{
+				uint32_t cmd;
+				uint32_t cmdsize;
+				uint8_t uuid[16];
+			}; // GameData::Formats::MachO::UUIDCommand_t
+		}; // GameData::Formats::MachO
+
+		// Call frame information (.eh_frame, .eh_frame_hdr), as far as locating FDEs goes.
+		namespace DWARF
+		{
+			static constexpr uint8_t EH_PE_OMIT = 0xFF;
+
+			static constexpr uint8_t EH_PE_FORMAT_MASK = 0x0F;
+			static constexpr uint8_t EH_PE_ABSPTR = 0x00;
+			static constexpr uint8_t EH_PE_ULEB128 = 0x01;
+			static constexpr uint8_t EH_PE_UDATA2 = 0x02;
+			static constexpr uint8_t EH_PE_UDATA4 = 0x03;
+			static constexpr uint8_t EH_PE_UDATA8 = 0x04;
+			static constexpr uint8_t EH_PE_SLEB128 = 0x09;
+			static constexpr uint8_t EH_PE_SDATA2 = 0x0A;
+			static constexpr uint8_t EH_PE_SDATA4 = 0x0B;
+			static constexpr uint8_t EH_PE_SDATA8 = 0x0C;
+
+			static constexpr uint8_t EH_PE_APPLICATION_MASK = 0x70;
+			static constexpr uint8_t EH_PE_PCREL = 0x10;
+			static constexpr uint8_t EH_PE_DATAREL = 0x30;
+
+			static constexpr uint8_t EH_PE_INDIRECT = 0x80;
+		}; // GameData::Formats::DWARF
+	}; // GameData::Formats
+}; // GameData
+
+#endif //_INCLUDE_GAMEDATA_FORMATS_HPP_
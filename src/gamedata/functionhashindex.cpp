@@ -0,0 +1,153 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/functionhashindex.hpp>
+#include <gamedata/functionindex.hpp>
+#include <gamedata/hash.hpp>
+#include <gamedata/instruction.hpp>
+
+#include <string.h>
+
+#define FUNCTION_HASH_SEED 0x46484931 // "FHI1": bump when the normalization changes.
+
+static constexpr uint32_t s_nAmbiguous = UINT32_MAX;
+
+GameData::FunctionHashIndex::FunctionHashIndex(const ModuleImage &aImage)
+{
+	const auto &vecFunctions = aImage.GetIndex<FunctionIndex>().GetFunctions();
+
+	m_mapFunctions.reserve(vecFunctions.size());
+
+	for(const auto &it : vecFunctions)
+	{
+		uint64_t nHash;
+
+		if(!Compute(aImage, it.m_nStart, it.m_nEnd, nHash))
+		{
+			continue;
+		}
+
+		auto aInsert = m_mapFunctions.emplace(nHash, it.m_nStart);
+
+		if(!aInsert.second)
+		{
+			aInsert.first->second = s_nAmbiguous;
+		}
+	}
+}
+
+size_t GameData::FunctionHashIndex::GetCount() const
+{
+	return m_mapFunctions.size();
+}
+
+bool GameData::FunctionHashIndex::Find(uint64_t nHash, uintptr_t &nRVA) const
+{
+	auto it = m_mapFunctions.find(nHash);
+
+	if(it == m_mapFunctions.end() || it->second == s_nAmbiguous)
+	{
+		return false;
+	}
+
+	nRVA = it->second;
+
+	return true;
+}
+
+bool GameData::FunctionHashIndex::Compute(const ModuleImage &aImage, uintptr_t nStart, uintptr_t nEnd, uint64_t &nHash)
+{
+	if(nStart >= nEnd || !aImage.ContainsRVA(nStart, nEnd - nStart))
+	{
+		return false;
+	}
+
+	Hash64 aHash(FUNCTION_HASH_SEED);
+
+	const uint8_t *pCode = aImage.GetPointer(0);
+
+	uintptr_t nRVA = nStart;
+
+	while(nRVA < nEnd)
+	{
+		Instruction_t aInstruction;
+
+		if(!DecodeInstruction(&pCode[nRVA], nEnd - nRVA, aInstruction))
+		{
+			return false;
+		}
+
+		uint8_t nOpcode = aInstruction.m_nOpcode;
+
+		// Alignment padding between blocks varies with the code around it.
+		if(aInstruction.m_nMap == 1 ? nOpcode == 0x1F : !aInstruction.m_nMap && nOpcode == 0x90 && !(aInstruction.m_nOpcodeOffset && (pCode[nRVA + aInstruction.m_nOpcodeOffset - 1] & 0xF1) == 0x41))
+		{
+			nRVA += aInstruction.m_nLength;
+
+			continue;
+		}
+
+		uint8_t aNormalized[16];
+
+		uint8_t nLength;
+
+		if(aInstruction.m_nFlags & INSTRUCTION_RELATIVE)
+		{
+			// Short and near forms of a branch are one: the distance decides which is emitted.
+			aNormalized[0] = static_cast<uint8_t>(aInstruction.m_nFlags & (INSTRUCTION_CALL | INSTRUCTION_JUMP | INSTRUCTION_CONDITIONAL));
+			aNormalized[1] = aInstruction.m_nFlags & INSTRUCTION_CONDITIONAL ? nOpcode & 0x0F : 0;
+			aNormalized[2] = !aInstruction.m_nMap && nOpcode >= 0xE0 && nOpcode <= 0xE3 ? nOpcode : 0xFF; // loop*, jrcxz.
+			nLength = 3;
+		}
+		else
+		{
+			// Prefixes, opcode, ModRM and SIB: everything before the displacement and the immediate.
+			nLength = aInstruction.m_nDisplacementSize ? aInstruction.m_nDisplacementOffset : aInstruction.m_nImmediateSize ? aInstruction.m_nImmediateOffset : aInstruction.m_nLength;
+
+			memcpy(aNormalized, &pCode[nRVA], nLength);
+
+			// The 8-bit and the full-width immediate forms of group 1 and imul are one as well.
+			if(!aInstruction.m_nMap && (nOpcode == 0x83 || nOpcode == 0x6B))
+			{
+				aNormalized[aInstruction.m_nOpcodeOffset] = nOpcode - 2;
+			}
+
+			uint8_t nMod = aInstruction.m_nModRM >> 6;
+
+			// An 8-bit and a 32-bit displacement are one form, as the value decides which is emitted.
+			if((aInstruction.m_nFlags & INSTRUCTION_MODRM) && (nMod == 1 || nMod == 2))
+			{
+				size_t nModRMOffset = aInstruction.m_nDisplacementOffset - 1 - ((aInstruction.m_nModRM & 7) == 4);
+
+				aNormalized[nModRMOffset] = (aNormalized[nModRMOffset] & 0x3F) | 0x80;
+			}
+		}
+
+		aHash.Update(&nLength, sizeof(nLength));
+		aHash.Update(aNormalized, nLength);
+
+		nRVA += aInstruction.m_nLength;
+	}
+
+	nHash = aHash.Digest();
+
+	return true;
+}
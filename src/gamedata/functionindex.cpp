@@ -0,0 +1,447 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/functionindex.hpp>
+
+#include "formats.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+using namespace GameData::Formats;
+
+// Reads the value at nRVA in the format of nEncoding (the low nibble), advancing nRVA.
+static bool ReadFormat(const GameData::ModuleImage &aImage, uintptr_t &nRVA, uint8_t nEncoding, int64_t &nValue)
+{
+	switch(nEncoding & DWARF::EH_PE_FORMAT_MASK)
+	{
+		case DWARF::EH_PE_ULEB128:
+		case DWARF::EH_PE_SLEB128:
+		{
+			uint64_t nResult = 0;
+
+			unsigned nShift = 0;
+
+			uint8_t nByte;
+
+			do
+			{
+				if(!aImage.ContainsRVA(nRVA) || nShift >= 64)
+				{
+					return false;
+				}
+
+				nByte = *aImage.GetPointer(nRVA++);
+				nResult |= static_cast<uint64_t>(nByte & 0x7F) << nShift;
+				nShift += 7;
+			}
+			while(nByte & 0x80);
+
+			if((nEncoding & DWARF::EH_PE_FORMAT_MASK) == DWARF::EH_PE_SLEB128 && nShift < 64 && (nByte & 0x40))
+			{
+				nResult |= ~static_cast<uint64_t>(0) << nShift;
+			}
+
+			nValue = static_cast<int64_t>(nResult);
+
+			return true;
+		}
+
+		case DWARF::EH_PE_UDATA2:
+		case DWARF::EH_PE_SDATA2:
+		{
+			if(!aImage.ContainsRVA(nRVA, sizeof(uint16_t)))
+			{
+				return false;
+			}
+
+			auto nRaw = Read<uint16_t>(aImage.GetPointer(nRVA));
+
+			nValue = (nEncoding & DWARF::EH_PE_FORMAT_MASK) == DWARF::EH_PE_SDATA2 ? static_cast<int16_t>(nRaw) : nRaw;
+			nRVA += sizeof(uint16_t);
+
+			return true;
+		}
+
+		case DWARF::EH_PE_UDATA4:
+		case DWARF::EH_PE_SDATA4:
+		{
+			if(!aImage.ContainsRVA(nRVA, sizeof(uint32_t)))
+			{
+				return false;
+			}
+
+			auto nRaw = Read<uint32_t>(aImage.GetPointer(nRVA));
+
+			nValue = (nEncoding & DWARF::EH_PE_FORMAT_MASK) == DWARF::EH_PE_SDATA4 ? static_cast<int32_t>(nRaw) : static_cast<int64_t>(nRaw);
+			nRVA += sizeof(uint32_t);
+
+			return true;
+		}
+
+		case DWARF::EH_PE_ABSPTR:
+		case DWARF::EH_PE_UDATA8:
+		case DWARF::EH_PE_SDATA8:
+		{
+			if(!aImage.ContainsRVA(nRVA, sizeof(uint64_t)))
+			{
+				return false;
+			}
+
+			nValue = Read<int64_t>(aImage.GetPointer(nRVA));
+			nRVA += sizeof(uint64_t);
+
+			return true;
+		}
+
+		default:
+		{
+			return false;
+		}
+	}
+}
+
+// An encoded address, as an RVA. nDataRel is the base of datarel values (.eh_frame_hdr).
+static bool ReadAddress(const GameData::ModuleImage &aImage, uintptr_t &nRVA, uint8_t nEncoding, uintptr_t nDataRel, uintptr_t &nResult)
+{
+	uintptr_t nField = nRVA;
+
+	int64_t nValue;
+
+	if(nEncoding == DWARF::EH_PE_OMIT || (nEncoding & DWARF::EH_PE_INDIRECT) || !ReadFormat(aImage, nRVA, nEncoding, nValue))
+	{
+		return false;
+	}
+
+	switch(nEncoding & DWARF::EH_PE_APPLICATION_MASK)
+	{
+		case DWARF::EH_PE_PCREL:    nResult = nField + static_cast<uintptr_t>(nValue); return true;
+		case DWARF::EH_PE_DATAREL:  nResult = nDataRel + static_cast<uintptr_t>(nValue); return true;
+		case 0:                     nResult = static_cast<uintptr_t>(nValue) - aImage.GetVirtualBase(); return true;
+		default:                    return false;
+	}
+}
+
+// The encoding of the addresses of the FDEs of a CIE: its "R" augmentation.
+static bool ReadCIEEncoding(const GameData::ModuleImage &aImage, uintptr_t nCIE, uint8_t &nEncoding)
+{
+	nEncoding = DWARF::EH_PE_ABSPTR;
+
+	if(!aImage.ContainsRVA(nCIE, 2 * sizeof(uint32_t) + 1))
+	{
+		return false;
+	}
+
+	uintptr_t nRVA = nCIE + 2 * sizeof(uint32_t); // length, CIE_id (0)
+
+	if(Read<uint32_t>(aImage.GetPointer(nCIE)) == UINT32_MAX)
+	{
+		return false; // 64-bit CFI is not emitted for x86-64 code.
+	}
+
+	uint8_t nVersion = *aImage.GetPointer(nRVA++);
+
+	const char *pszAugmentation = aImage.GetPointer<char>(nRVA);
+
+	size_t nAugmentationLength = strnlen(pszAugmentation, aImage.GetSize() - nRVA);
+
+	nRVA += nAugmentationLength + 1;
+
+	if(pszAugmentation[0] != 'z')
+	{
+		return !pszAugmentation[0];
+	}
+
+	int64_t nSkip;
+
+	// code_alignment_factor, data_alignment_factor, return_address_register, augmentation length.
+	if(!ReadFormat(aImage, nRVA, DWARF::EH_PE_ULEB128, nSkip) || !ReadFormat(aImage, nRVA, DWARF::EH_PE_SLEB128, nSkip))
+	{
+		return false;
+	}
+
+	if(nVersion == 1)
+	{
+		nRVA++;
+	}
+	else if(!ReadFormat(aImage, nRVA, DWARF::EH_PE_ULEB128, nSkip))
+	{
+		return false;
+	}
+
+	if(!ReadFormat(aImage, nRVA, DWARF::EH_PE_ULEB128, nSkip))
+	{
+		return false;
+	}
+
+	for(size_t n = 1; n < nAugmentationLength; n++)
+	{
+		if(!aImage.ContainsRVA(nRVA))
+		{
+			return false;
+		}
+
+		switch(pszAugmentation[n])
+		{
+			case 'R':
+			{
+				nEncoding = *aImage.GetPointer(nRVA);
+
+				return true;
+			}
+
+			case 'L':
+			{
+				nRVA++;
+
+				break;
+			}
+
+			case 'P':
+			{
+				uint8_t nPersonalityEncoding = *aImage.GetPointer(nRVA++);
+
+				int64_t nPersonality;
+
+				if(!ReadFormat(aImage, nRVA, nPersonalityEncoding, nPersonality))
+				{
+					return false;
+				}
+
+				break;
+			}
+
+			default:
+			{
+				break; // "S", "B": no data.
+			}
+		}
+	}
+
+	return true;
+}
+
+GameData::FunctionIndex::FunctionIndex(const ModuleImage &aImage)
+{
+	if(aImage.GetSize() > UINT32_MAX)
+	{
+		return;
+	}
+
+	switch(aImage.GetFormat())
+	{
+		case IMAGE_FORMAT_ELF:
+		{
+			InitELF(aImage);
+
+			break;
+		}
+
+		case IMAGE_FORMAT_PE:
+		{
+			InitPE(aImage);
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+
+	std::sort(m_vecFunctions.begin(), m_vecFunctions.end());
+}
+
+size_t GameData::FunctionIndex::GetCount() const
+{
+	return m_vecFunctions.size();
+}
+
+const std::vector<GameData::FunctionIndex::Function_t> &GameData::FunctionIndex::GetFunctions() const
+{
+	return m_vecFunctions;
+}
+
+bool GameData::FunctionIndex::Find(uintptr_t nRVA, Function_t &aResult) const
+{
+	auto it = std::upper_bound(m_vecFunctions.begin(), m_vecFunctions.end(), Function_t {static_cast<uint32_t>(nRVA), 0});
+
+	if(it == m_vecFunctions.begin() || nRVA > UINT32_MAX)
+	{
+		return false;
+	}
+
+	--it;
+
+	if(nRVA >= it->m_nEnd)
+	{
+		return false;
+	}
+
+	aResult = *it;
+
+	return true;
+}
+
+void GameData::FunctionIndex::InitELF(const ModuleImage &aImage)
+{
+	if(!aImage.ContainsRVA(0, sizeof(ELF::Ehdr_t)))
+	{
+		return;
+	}
+
+	const auto aHeader = Read<ELF::Ehdr_t>(aImage.GetBase());
+
+	if(!aImage.ContainsRVA(aHeader.e_phoff, aHeader.e_phnum * sizeof(ELF::Phdr_t)))
+	{
+		return;
+	}
+
+	uintptr_t nHeader = 0;
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(aImage.GetPointer(aHeader.e_phoff + n * sizeof(ELF::Phdr_t)));
+
+		if(aProgram.p_type == ELF::PT_GNU_EH_FRAME)
+		{
+			nHeader = aProgram.p_vaddr - aImage.GetVirtualBase();
+		}
+	}
+
+	// .eh_frame_hdr: { version, eh_frame_ptr_enc, fde_count_enc, table_enc, eh_frame_ptr, fde_count, { initial_location, fde }[] }
+	if(!nHeader || !aImage.ContainsRVA(nHeader, 4) || *aImage.GetPointer(nHeader) != 1)
+	{
+		return;
+	}
+
+	const uint8_t *pEncodings = aImage.GetPointer(nHeader + 1);
+
+	uint8_t nFramePointerEncoding = pEncodings[0],
+	        nCountEncoding = pEncodings[1],
+	        nTableEncoding = pEncodings[2];
+
+	uintptr_t nRVA = nHeader + 4,
+	          nFrame;
+
+	int64_t nCount;
+
+	if(!ReadAddress(aImage, nRVA, nFramePointerEncoding, nHeader, nFrame) || nCountEncoding == DWARF::EH_PE_OMIT || !ReadFormat(aImage, nRVA, nCountEncoding, nCount) || nCount <= 0)
+	{
+		return;
+	}
+
+	std::unordered_map<uintptr_t, uint8_t> mapCIEEncodings;
+
+	m_vecFunctions.reserve(static_cast<size_t>(nCount));
+
+	for(int64_t n = 0; n < nCount; n++)
+	{
+		uintptr_t nStart, nFDE;
+
+		if(!ReadAddress(aImage, nRVA, nTableEncoding, nHeader, nStart) || !ReadAddress(aImage, nRVA, nTableEncoding, nHeader, nFDE))
+		{
+			break;
+		}
+
+		// FDE: { length, CIE_pointer (back from itself), pc_begin, pc_range, ... }
+		if(!aImage.ContainsRVA(nFDE, 2 * sizeof(uint32_t)) || Read<uint32_t>(aImage.GetPointer(nFDE)) == UINT32_MAX)
+		{
+			continue;
+		}
+
+		uintptr_t nCIE = nFDE + sizeof(uint32_t) - Read<uint32_t>(aImage.GetPointer(nFDE + sizeof(uint32_t)));
+
+		auto itEncoding = mapCIEEncodings.find(nCIE);
+
+		if(itEncoding == mapCIEEncodings.end())
+		{
+			uint8_t nEncoding;
+
+			if(!ReadCIEEncoding(aImage, nCIE, nEncoding))
+			{
+				continue;
+			}
+
+			itEncoding = mapCIEEncodings.emplace(nCIE, nEncoding).first;
+		}
+
+		uintptr_t nField = nFDE + 2 * sizeof(uint32_t),
+		          nBegin;
+
+		int64_t nRange;
+
+		// The range is in the format of the encoding, without its application.
+		if(!ReadAddress(aImage, nField, itEncoding->second, nHeader, nBegin) || !ReadFormat(aImage, nField, itEncoding->second & DWARF::EH_PE_FORMAT_MASK, nRange) || nRange <= 0)
+		{
+			continue;
+		}
+
+		if(nBegin == nStart && aImage.ContainsRVA(nStart, static_cast<size_t>(nRange)))
+		{
+			m_vecFunctions.push_back({static_cast<uint32_t>(nStart), static_cast<uint32_t>(nStart + nRange)});
+		}
+	}
+}
+
+void GameData::FunctionIndex::InitPE(const ModuleImage &aImage)
+{
+	if(!aImage.ContainsRVA(PE::DOS_LFANEW_OFFSET, sizeof(uint32_t)))
+	{
+		return;
+	}
+
+	uint32_t nNTOffset = Read<uint32_t>(aImage.GetPointer(PE::DOS_LFANEW_OFFSET));
+
+	uintptr_t nOptionalHeader = nNTOffset + sizeof(uint32_t) + sizeof(PE::FileHeader_t);
+
+	if(!aImage.ContainsRVA(nOptionalHeader, PE::OPTIONAL_DATA_DIRECTORY + (PE::DIRECTORY_EXCEPTION + 1) * sizeof(PE::DataDirectory_t)))
+	{
+		return;
+	}
+
+	if(Read<uint32_t>(aImage.GetPointer(nOptionalHeader + PE::OPTIONAL_NUMBER_OF_RVA_AND_SIZES)) <= PE::DIRECTORY_EXCEPTION)
+	{
+		return;
+	}
+
+	const auto aExceptions = Read<PE::DataDirectory_t>(aImage.GetPointer(nOptionalHeader + PE::OPTIONAL_DATA_DIRECTORY + PE::DIRECTORY_EXCEPTION * sizeof(PE::DataDirectory_t)));
+
+	if(!aImage.ContainsRVA(aExceptions.VirtualAddress, aExceptions.Size))
+	{
+		return;
+	}
+
+	size_t nCount = aExceptions.Size / sizeof(PE::RuntimeFunction_t);
+
+	m_vecFunctions.reserve(nCount);
+
+	for(size_t n = 0; n < nCount; n++)
+	{
+		const auto aFunction = Read<PE::RuntimeFunction_t>(aImage.GetPointer(aExceptions.VirtualAddress + n * sizeof(PE::RuntimeFunction_t)));
+
+		if(aFunction.BeginAddress < aFunction.EndAddress && aImage.ContainsRVA(aFunction.BeginAddress, aFunction.EndAddress - aFunction.BeginAddress))
+		{
+			m_vecFunctions.push_back({aFunction.BeginAddress, aFunction.EndAddress});
+		}
+	}
+}
@@ -0,0 +1,215 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/hash.hpp>
+
+#include <string.h>
+
+static constexpr uint64_t s_nPrime1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t s_nPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t s_nPrime3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t s_nPrime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t s_nPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t RotateLeft(uint64_t nValue, int nBits)
+{
+	return (nValue << nBits) | (nValue >> (64 - nBits));
+}
+
+static inline uint64_t Read64(const uint8_t *pData)
+{
+	uint64_t nResult;
+
+	memcpy(&nResult, pData, sizeof(nResult));
+
+	return nResult;
+}
+
+static inline uint32_t Read32(const uint8_t *pData)
+{
+	uint32_t nResult;
+
+	memcpy(&nResult, pData, sizeof(nResult));
+
+	return nResult;
+}
+
+static inline uint64_t Round(uint64_t nAcc, uint64_t nInput)
+{
+	nAcc += nInput * s_nPrime2;
+	nAcc = RotateLeft(nAcc, 31);
+	nAcc *= s_nPrime1;
+
+	return nAcc;
+}
+
+static inline uint64_t MergeRound(uint64_t nAcc, uint64_t nValue)
+{
+	nAcc ^= Round(0, nValue);
+	nAcc = nAcc * s_nPrime1 + s_nPrime4;
+
+	return nAcc;
+}
+
+GameData::Hash64::Hash64(uint64_t nSeed)
+{
+	Reset(nSeed);
+}
+
+void GameData::Hash64::Reset(uint64_t nSeed)
+{
+	m_aLanes[0] = nSeed + s_nPrime1 + s_nPrime2;
+	m_aLanes[1] = nSeed + s_nPrime2;
+	m_aLanes[2] = nSeed;
+	m_aLanes[3] = nSeed - s_nPrime1;
+
+	m_nSeed = nSeed;
+	m_nTotalLength = 0;
+	m_nStripeLength = 0;
+}
+
+void GameData::Hash64::Update(const void *pData, size_t nLength)
+{
+	const uint8_t *pInput = reinterpret_cast<const uint8_t *>(pData),
+	              *pInputEnd = pInput + nLength;
+
+	m_nTotalLength += nLength;
+
+	if(m_nStripeLength)
+	{
+		size_t nFill = sizeof(m_aStripe) - m_nStripeLength;
+
+		if(nLength < nFill)
+		{
+			memcpy(m_aStripe + m_nStripeLength, pInput, nLength);
+			m_nStripeLength += nLength;
+
+			return;
+		}
+
+		memcpy(m_aStripe + m_nStripeLength, pInput, nFill);
+		pInput += nFill;
+
+		for(int n = 0; n < 4; n++)
+		{
+			m_aLanes[n] = Round(m_aLanes[n], Read64(m_aStripe + n * sizeof(uint64_t)));
+		}
+
+		m_nStripeLength = 0;
+	}
+
+	if(pInputEnd - pInput >= static_cast<ptrdiff_t>(sizeof(m_aStripe)))
+	{
+		uint64_t nLane0 = m_aLanes[0],
+		         nLane1 = m_aLanes[1],
+		         nLane2 = m_aLanes[2],
+		         nLane3 = m_aLanes[3];
+
+		const uint8_t *pLast = pInputEnd - sizeof(m_aStripe);
+
+		do
+		{
+			nLane0 = Round(nLane0, Read64(pInput));
+			nLane1 = Round(nLane1, Read64(pInput + 8));
+			nLane2 = Round(nLane2, Read64(pInput + 16));
+			nLane3 = Round(nLane3, Read64(pInput + 24));
+
+			pInput += sizeof(m_aStripe);
+		}
+		while(pInput <= pLast);
+
+		m_aLanes[0] = nLane0;
+		m_aLanes[1] = nLane1;
+		m_aLanes[2] = nLane2;
+		m_aLanes[3] = nLane3;
+	}
+
+	if(pInput < pInputEnd)
+	{
+		m_nStripeLength = pInputEnd - pInput;
+		memcpy(m_aStripe, pInput, m_nStripeLength);
+	}
+}
+
+uint64_t GameData::Hash64::Digest() const
+{
+	uint64_t nResult;
+
+	if(m_nTotalLength >= sizeof(m_aStripe))
+	{
+		nResult = RotateLeft(m_aLanes[0], 1) + RotateLeft(m_aLanes[1], 7) + RotateLeft(m_aLanes[2], 12) + RotateLeft(m_aLanes[3], 18);
+
+		for(int n = 0; n < 4; n++)
+		{
+			nResult = MergeRound(nResult, m_aLanes[n]);
+		}
+	}
+	else
+	{
+		nResult = m_nSeed + s_nPrime5;
+	}
+
+	nResult += m_nTotalLength;
+
+	const uint8_t *pInput = m_aStripe,
+	              *pInputEnd = m_aStripe + m_nStripeLength;
+
+	while(pInput + sizeof(uint64_t) <= pInputEnd)
+	{
+		nResult ^= Round(0, Read64(pInput));
+		nResult = RotateLeft(nResult, 27) * s_nPrime1 + s_nPrime4;
+
+		pInput += sizeof(uint64_t);
+	}
+
+	if(pInput + sizeof(uint32_t) <= pInputEnd)
+	{
+		nResult ^= static_cast<uint64_t>(Read32(pInput)) * s_nPrime1;
+		nResult = RotateLeft(nResult, 23) * s_nPrime2 + s_nPrime3;
+
+		pInput += sizeof(uint32_t);
+	}
+
+	while(pInput < pInputEnd)
+	{
+		nResult ^= *pInput * s_nPrime5;
+		nResult = RotateLeft(nResult, 11) * s_nPrime1;
+
+		pInput++;
+	}
+
+	nResult ^= nResult >> 33;
+	nResult *= s_nPrime2;
+	nResult ^= nResult >> 29;
+	nResult *= s_nPrime3;
+	nResult ^= nResult >> 32;
+
+	return nResult;
+}
+
+uint64_t GameData::Hash64::Compute(const void *pData, size_t nLength, uint64_t nSeed)
+{
+	Hash64 aHash(nSeed);
+
+	aHash.Update(pData, nLength);
+
+	return aHash.Digest();
+}
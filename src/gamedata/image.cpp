@@ -0,0 +1,589 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/image.hpp>
+
+#include "formats.hpp"
+
+#include <dynlibutils/module.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+
+using namespace GameData::Formats;
+
+static std::mutex s_mtxModuleImages;
+static std::unordered_map<uintptr_t, std::unique_ptr<GameData::ModuleImage>> s_mapModuleImages;
+
+GameData::ModuleImage::ModuleImage()
+ :  m_eFormat(IMAGE_FORMAT_UNKNOWN),
+    m_bLive(false),
+    m_pBase(nullptr),
+    m_nLimit(0),
+    m_nRuntimeBase(0),
+    m_nVirtualBase(0),
+    m_nSize(0),
+    m_aBuildId {},
+    m_nBuildIdLength(0)
+{
+}
+
+GameData::ModuleImage::~ModuleImage()
+{
+}
+
+bool GameData::ModuleImage::Init(const void *pBase, size_t nLimit, bool bLive)
+{
+	m_pBase = reinterpret_cast<const uint8_t *>(pBase);
+	m_nLimit = nLimit;
+	m_bLive = bLive;
+
+	m_nRuntimeBase = reinterpret_cast<uintptr_t>(pBase);
+	m_nVirtualBase = 0;
+	m_nSize = 0;
+
+	m_vecSegments.clear();
+	m_nBuildIdLength = 0;
+
+	if(!m_pBase || !IsReadable(0, sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	if(!memcmp(m_pBase, ELF::s_aMagic, sizeof(ELF::s_aMagic)))
+	{
+		m_eFormat = IMAGE_FORMAT_ELF;
+
+		return InitELF();
+	}
+
+	if(Read<uint16_t>(m_pBase) == PE::DOS_MAGIC)
+	{
+		m_eFormat = IMAGE_FORMAT_PE;
+
+		return InitPE();
+	}
+
+	if(Read<uint32_t>(m_pBase) == MachO::MAGIC_64)
+	{
+		m_eFormat = IMAGE_FORMAT_MACHO;
+
+		return InitMachO();
+	}
+
+	m_eFormat = IMAGE_FORMAT_UNKNOWN;
+
+	return false;
+}
+
+GameData::ImageFormat GameData::ModuleImage::GetFormat() const
+{
+	return m_eFormat;
+}
+
+bool GameData::ModuleImage::IsLive() const
+{
+	return m_bLive;
+}
+
+const uint8_t *GameData::ModuleImage::GetBase() const
+{
+	return m_pBase;
+}
+
+uintptr_t GameData::ModuleImage::GetRuntimeBase() const
+{
+	return m_nRuntimeBase;
+}
+
+uintptr_t GameData::ModuleImage::GetVirtualBase() const
+{
+	return m_nVirtualBase;
+}
+
+size_t GameData::ModuleImage::GetSize() const
+{
+	return m_nSize;
+}
+
+const std::vector<GameData::ModuleImage::Segment_t> &GameData::ModuleImage::GetSegments() const
+{
+	return m_vecSegments;
+}
+
+const GameData::ModuleImage::Segment_t *GameData::ModuleImage::FindSegment(uintptr_t nRVA) const
+{
+	for(const auto &it : m_vecSegments)
+	{
+		if(it.Contains(nRVA))
+		{
+			return &it;
+		}
+	}
+
+	return nullptr;
+}
+
+const GameData::ModuleImage::Segment_t *GameData::ModuleImage::FindSegment(const char *pszName) const
+{
+	for(const auto &it : m_vecSegments)
+	{
+		if(!strncmp(it.m_szName, pszName, sizeof(it.m_szName)))
+		{
+			return &it;
+		}
+	}
+
+	return nullptr;
+}
+
+const uint8_t *GameData::ModuleImage::GetBuildId(size_t &nLength) const
+{
+	nLength = m_nBuildIdLength;
+
+	return m_nBuildIdLength ? m_aBuildId : nullptr;
+}
+
+bool GameData::ModuleImage::Contains(uintptr_t pAddress) const
+{
+	return pAddress - reinterpret_cast<uintptr_t>(m_pBase) < m_nSize;
+}
+
+bool GameData::ModuleImage::ContainsRVA(uintptr_t nRVA, size_t nLength) const
+{
+	return nRVA <= m_nSize && nLength <= m_nSize - nRVA;
+}
+
+uintptr_t GameData::ModuleImage::ToRVA(uintptr_t pAddress) const
+{
+	return pAddress - reinterpret_cast<uintptr_t>(m_pBase);
+}
+
+uintptr_t GameData::ModuleImage::FromRVA(uintptr_t nRVA) const
+{
+	return reinterpret_cast<uintptr_t>(m_pBase) + nRVA;
+}
+
+bool GameData::ModuleImage::InitELF()
+{
+	if(!IsReadable(0, sizeof(ELF::Ehdr_t)))
+	{
+		return false;
+	}
+
+	const auto aHeader = Read<ELF::Ehdr_t>(m_pBase);
+
+	if(aHeader.e_ident[4] != ELF::CLASS_64 || aHeader.e_phentsize != sizeof(ELF::Phdr_t))
+	{
+		return false;
+	}
+
+	if(!IsReadable(aHeader.e_phoff, aHeader.e_phnum * sizeof(ELF::Phdr_t)))
+	{
+		return false;
+	}
+
+	const uint8_t *pProgramHeaders = m_pBase + aHeader.e_phoff;
+
+	uintptr_t nMinAddress = UINTPTR_MAX,
+	          nMaxAddress = 0;
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(pProgramHeaders + n * sizeof(ELF::Phdr_t));
+
+		if(aProgram.p_type == ELF::PT_LOAD)
+		{
+			nMinAddress = std::min<uintptr_t>(nMinAddress, aProgram.p_vaddr & ~static_cast<uint64_t>(0xFFF));
+			nMaxAddress = std::max<uintptr_t>(nMaxAddress, aProgram.p_vaddr + aProgram.p_memsz);
+		}
+	}
+
+	if(nMaxAddress <= nMinAddress)
+	{
+		return false;
+	}
+
+	m_nVirtualBase = nMinAddress;
+	m_nSize = nMaxAddress - nMinAddress;
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(pProgramHeaders + n * sizeof(ELF::Phdr_t));
+
+		uintptr_t nRVA = aProgram.p_vaddr - m_nVirtualBase;
+
+		switch(aProgram.p_type)
+		{
+			case ELF::PT_LOAD:
+			{
+				int nFlags = IMAGE_SEGMENT_NONE;
+
+				if(aProgram.p_flags & ELF::PF_R)
+				{
+					nFlags |= IMAGE_SEGMENT_READ;
+				}
+
+				if(aProgram.p_flags & ELF::PF_W)
+				{
+					nFlags |= IMAGE_SEGMENT_WRITE;
+				}
+
+				if(aProgram.p_flags & ELF::PF_X)
+				{
+					nFlags |= IMAGE_SEGMENT_EXECUTE;
+				}
+
+				AddSegment("", nRVA, aProgram.p_memsz, nFlags);
+
+				break;
+			}
+
+			case ELF::PT_NOTE:
+			{
+				if(!IsReadable(nRVA, aProgram.p_memsz))
+				{
+					break;
+				}
+
+				const uint8_t *pNote = m_pBase + nRVA,
+				              *pNoteEnd = pNote + aProgram.p_memsz;
+
+				while(pNote + sizeof(ELF::Nhdr_t) <= pNoteEnd)
+				{
+					const auto aNote = Read<ELF::Nhdr_t>(pNote);
+
+					const uint8_t *pName = pNote + sizeof(ELF::Nhdr_t),
+					              *pDesc = pName + ((aNote.n_namesz + 3) & ~3u);
+
+					if(pDesc + aNote.n_descsz > pNoteEnd)
+					{
+						break;
+					}
+
+					if(aNote.n_type == ELF::NT_GNU_BUILD_ID && aNote.n_namesz == 4 && !memcmp(pName, "GNU", 4))
+					{
+						SetBuildId(pDesc, aNote.n_descsz);
+					}
+
+					pNote = pDesc + ((aNote.n_descsz + 3) & ~3u);
+				}
+
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool GameData::ModuleImage::InitPE()
+{
+	if(!IsReadable(PE::DOS_LFANEW_OFFSET, sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	uint32_t nNTOffset = Read<uint32_t>(m_pBase + PE::DOS_LFANEW_OFFSET);
+
+	if(!IsReadable(nNTOffset, sizeof(uint32_t) + sizeof(PE::FileHeader_t) + PE::OPTIONAL_DATA_DIRECTORY))
+	{
+		return false;
+	}
+
+	if(Read<uint32_t>(m_pBase + nNTOffset) != PE::NT_SIGNATURE)
+	{
+		return false;
+	}
+
+	const auto aFileHeader = Read<PE::FileHeader_t>(m_pBase + nNTOffset + sizeof(uint32_t));
+
+	const uint8_t *pOptionalHeader = m_pBase + nNTOffset + sizeof(uint32_t) + sizeof(PE::FileHeader_t);
+
+	if(Read<uint16_t>(pOptionalHeader) != PE::OPTIONAL_MAGIC_64)
+	{
+		return false;
+	}
+
+	m_nVirtualBase = Read<uint64_t>(pOptionalHeader + PE::OPTIONAL_IMAGE_BASE);
+	m_nSize = Read<uint32_t>(pOptionalHeader + PE::OPTIONAL_SIZE_OF_IMAGE);
+
+	AddSegment("", 0, Read<uint32_t>(pOptionalHeader + PE::OPTIONAL_SIZE_OF_HEADERS), IMAGE_SEGMENT_READ);
+
+	uintptr_t nSectionsOffset = nNTOffset + sizeof(uint32_t) + sizeof(PE::FileHeader_t) + aFileHeader.SizeOfOptionalHeader;
+
+	if(!IsReadable(nSectionsOffset, aFileHeader.NumberOfSections * sizeof(PE::SectionHeader_t)))
+	{
+		return false;
+	}
+
+	for(uint16_t n = 0; n < aFileHeader.NumberOfSections; n++)
+	{
+		const auto aSection = Read<PE::SectionHeader_t>(m_pBase + nSectionsOffset + n * sizeof(PE::SectionHeader_t));
+
+		char szName[sizeof(aSection.Name) + 1] {};
+
+		memcpy(szName, aSection.Name, sizeof(aSection.Name));
+
+		int nFlags = IMAGE_SEGMENT_NONE;
+
+		if(aSection.Characteristics & PE::SCN_MEM_READ)
+		{
+			nFlags |= IMAGE_SEGMENT_READ;
+		}
+
+		if(aSection.Characteristics & PE::SCN_MEM_WRITE)
+		{
+			nFlags |= IMAGE_SEGMENT_WRITE;
+		}
+
+		if(aSection.Characteristics & PE::SCN_MEM_EXECUTE)
+		{
+			nFlags |= IMAGE_SEGMENT_EXECUTE;
+		}
+
+		AddSegment(szName, aSection.VirtualAddress, std::max(aSection.VirtualSize, aSection.SizeOfRawData), nFlags);
+	}
+
+	uint32_t nDirectoryCount = Read<uint32_t>(pOptionalHeader + PE::OPTIONAL_NUMBER_OF_RVA_AND_SIZES);
+
+	if(PE::DIRECTORY_DEBUG < nDirectoryCount)
+	{
+		const auto aDebug = Read<PE::DataDirectory_t>(pOptionalHeader + PE::OPTIONAL_DATA_DIRECTORY + PE::DIRECTORY_DEBUG * sizeof(PE::DataDirectory_t));
+
+		for(uint32_t nOffset = 0; nOffset + sizeof(PE::DebugDirectory_t) <= aDebug.Size; nOffset += sizeof(PE::DebugDirectory_t))
+		{
+			if(!IsReadable(aDebug.VirtualAddress + nOffset, sizeof(PE::DebugDirectory_t)))
+			{
+				break;
+			}
+
+			const auto aEntry = Read<PE::DebugDirectory_t>(m_pBase + aDebug.VirtualAddress + nOffset);
+
+			// "RSDS" + GUID + age.
+			if(aEntry.Type != PE::DEBUG_TYPE_CODEVIEW || aEntry.SizeOfData < 24 || !IsReadable(aEntry.AddressOfRawData, 24))
+			{
+				continue;
+			}
+
+			const uint8_t *pCodeView = m_pBase + aEntry.AddressOfRawData;
+
+			if(Read<uint32_t>(pCodeView) == PE::CODEVIEW_RSDS)
+			{
+				SetBuildId(pCodeView + sizeof(uint32_t), 20);
+
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool GameData::ModuleImage::InitMachO()
+{
+	if(!IsReadable(0, sizeof(MachO::Header_t)))
+	{
+		return false;
+	}
+
+	const auto aHeader = Read<MachO::Header_t>(m_pBase);
+
+	if(!IsReadable(sizeof(MachO::Header_t), aHeader.sizeofcmds))
+	{
+		return false;
+	}
+
+	const uint8_t *pCommands = m_pBase + sizeof(MachO::Header_t),
+	              *pCommandsEnd = pCommands + aHeader.sizeofcmds;
+
+	bool bHasBase = false;
+
+	for(const uint8_t *pCommand = pCommands; pCommand + sizeof(MachO::LoadCommand_t) <= pCommandsEnd; )
+	{
+		const auto aCommand = Read<MachO::LoadCommand_t>(pCommand);
+
+		if(aCommand.cmdsize < sizeof(MachO::LoadCommand_t) || pCommand + aCommand.cmdsize > pCommandsEnd)
+		{
+			break;
+		}
+
+		if(aCommand.cmd == MachO::LC_SEGMENT_64 && aCommand.cmdsize >= sizeof(MachO::SegmentCommand_t))
+		{
+			const auto aSegment = Read<MachO::SegmentCommand_t>(pCommand);
+
+			// The headers live at the start of the first mapped segment (__TEXT).
+			if(aSegment.initprot && aSegment.fileoff == 0 && aSegment.filesize)
+			{
+				m_nVirtualBase = aSegment.vmaddr;
+				bHasBase = true;
+			}
+		}
+		else if(aCommand.cmd == MachO::LC_UUID && aCommand.cmdsize >= sizeof(MachO::UUIDCommand_t))
+		{
+			const auto aUUID = Read<MachO::UUIDCommand_t>(pCommand);
+
+			SetBuildId(aUUID.uuid, sizeof(aUUID.uuid));
+		}
+
+		pCommand += aCommand.cmdsize;
+	}
+
+	if(!bHasBase)
+	{
+		return false;
+	}
+
+	for(const uint8_t *pCommand = pCommands; pCommand + sizeof(MachO::LoadCommand_t) <= pCommandsEnd; )
+	{
+		const auto aCommand = Read<MachO::LoadCommand_t>(pCommand);
+
+		if(aCommand.cmdsize < sizeof(MachO::LoadCommand_t) || pCommand + aCommand.cmdsize > pCommandsEnd)
+		{
+			break;
+		}
+
+		if(aCommand.cmd == MachO::LC_SEGMENT_64 && aCommand.cmdsize >= sizeof(MachO::SegmentCommand_t))
+		{
+			const auto aSegment = Read<MachO::SegmentCommand_t>(pCommand);
+
+			if(aSegment.initprot && aSegment.vmaddr >= m_nVirtualBase)
+			{
+				char szName[sizeof(aSegment.segname) + 1] {};
+
+				memcpy(szName, aSegment.segname, sizeof(aSegment.segname));
+
+				int nFlags = IMAGE_SEGMENT_NONE;
+
+				if(aSegment.initprot & MachO::VM_PROT_READ)
+				{
+					nFlags |= IMAGE_SEGMENT_READ;
+				}
+
+				if(aSegment.initprot & MachO::VM_PROT_WRITE)
+				{
+					nFlags |= IMAGE_SEGMENT_WRITE;
+				}
+
+				if(aSegment.initprot & MachO::VM_PROT_EXECUTE)
+				{
+					nFlags |= IMAGE_SEGMENT_EXECUTE;
+				}
+
+				uintptr_t nRVA = aSegment.vmaddr - m_nVirtualBase;
+
+				AddSegment(szName, nRVA, aSegment.vmsize, nFlags);
+
+				m_nSize = std::max<size_t>(m_nSize, nRVA + aSegment.vmsize);
+			}
+		}
+
+		pCommand += aCommand.cmdsize;
+	}
+
+	return m_nSize != 0;
+}
+
+void GameData::ModuleImage::AddSegment(const char *pszName, uintptr_t nRVA, size_t nSize, int nFlags)
+{
+	if(!nSize)
+	{
+		return;
+	}
+
+	Segment_t aSegment {};
+
+	strncpy(aSegment.m_szName, pszName, sizeof(aSegment.m_szName) - 1);
+
+	aSegment.m_nRVA = nRVA;
+	aSegment.m_nSize = nSize;
+	aSegment.m_nFlags = nFlags;
+
+	m_vecSegments.push_back(aSegment);
+}
+
+void GameData::ModuleImage::SetBuildId(const void *pData, size_t nLength)
+{
+	m_nBuildIdLength = std::min(nLength, sizeof(m_aBuildId));
+
+	memcpy(m_aBuildId, pData, m_nBuildIdLength);
+}
+
+bool GameData::ModuleImage::IsReadable(uintptr_t nRVA, size_t nLength) const
+{
+	return !m_nLimit || (nRVA <= m_nLimit && nLength <= m_nLimit - nRVA);
+}
+
+const GameData::ModuleImage *GameData::GetModuleImage(const DynLibUtils::CModule *pModule)
+{
+	if(!pModule)
+	{
+		return nullptr;
+	}
+
+	uintptr_t pBase = pModule->GetModuleBase().GetPtr();
+
+	if(!pBase)
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> aLock(s_mtxModuleImages);
+
+	auto &pImage = s_mapModuleImages[pBase];
+
+	if(!pImage)
+	{
+		auto pNewImage = std::make_unique<ModuleImage>();
+
+		if(!pNewImage->Init(reinterpret_cast<const void *>(pBase)))
+		{
+			s_mapModuleImages.erase(pBase);
+
+			return nullptr;
+		}
+
+		pImage = std::move(pNewImage);
+	}
+
+	return pImage.get();
+}
+
+void GameData::ForgetModuleImage(uintptr_t pBase)
+{
+	std::unique_ptr<ModuleImage> pImage; // Destroyed out of the lock.
+
+	std::lock_guard<std::mutex> aLock(s_mtxModuleImages);
+
+	auto itFound = s_mapModuleImages.find(pBase);
+
+	if(itFound != s_mapModuleImages.end())
+	{
+		pImage = std::move(itFound->second);
+		s_mapModuleImages.erase(itFound);
+	}
+}
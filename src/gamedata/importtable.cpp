@@ -0,0 +1,193 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/importtable.hpp>
+#include <gamedata/symboltable.hpp>
+
+#include "formats.hpp"
+
+#include <string.h>
+
+using namespace GameData::Formats;
+
+GameData::ImportTable::ImportTable(const ModuleImage &aImage)
+{
+	if(aImage.GetSize() > UINT32_MAX)
+	{
+		return;
+	}
+
+	switch(aImage.GetFormat())
+	{
+		case IMAGE_FORMAT_ELF:
+		{
+			InitELF(aImage);
+
+			break;
+		}
+
+		case IMAGE_FORMAT_PE:
+		{
+			InitPE(aImage);
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+size_t GameData::ImportTable::GetCount() const
+{
+	return m_mapSlots.size();
+}
+
+bool GameData::ImportTable::Find(const char *pszName, uintptr_t &nRVA) const
+{
+	auto itFound = m_mapSlots.find(pszName);
+
+	if(itFound == m_mapSlots.end())
+	{
+		return false;
+	}
+
+	nRVA = itFound->second;
+
+	return true;
+}
+
+void GameData::ImportTable::InitELF(const ModuleImage &aImage)
+{
+	// Shares the located dynamic symbol table.
+	const auto &aSymbols = aImage.GetIndex<SymbolTable>();
+
+	struct
+	{
+		int64_t m_nTableTag;
+		int64_t m_nSizeTag;
+		uint32_t m_nType;
+	} aTables[] =
+	{
+		{ELF::DT_JMPREL, ELF::DT_PLTRELSZ, ELF::R_X86_64_JUMP_SLOT},
+		{ELF::DT_RELA, ELF::DT_RELASZ, ELF::R_X86_64_GLOB_DAT},
+	};
+
+	for(const auto &aTable : aTables)
+	{
+		uint64_t nTable, nTableSize;
+
+		if(!aSymbols.FindDynamic(aTable.m_nTableTag, nTable) || !aSymbols.FindDynamic(aTable.m_nSizeTag, nTableSize))
+		{
+			continue;
+		}
+
+		uintptr_t nTableRVA = aSymbols.ToRVA(nTable);
+
+		if(!aImage.ContainsRVA(nTableRVA, nTableSize))
+		{
+			continue;
+		}
+
+		for(uint64_t nOffset = 0; nOffset + sizeof(ELF::Rela_t) <= nTableSize; nOffset += sizeof(ELF::Rela_t))
+		{
+			const auto aRela = Read<ELF::Rela_t>(aImage.GetPointer(nTableRVA + nOffset));
+
+			if(aRela.GetType() != aTable.m_nType || !aRela.GetSymbol())
+			{
+				continue;
+			}
+
+			const char *pszName = aSymbols.GetName(aRela.GetSymbol());
+
+			uintptr_t nSlot = aSymbols.ToRVA(aRela.r_offset);
+
+			if(pszName && *pszName && aImage.ContainsRVA(nSlot, sizeof(uint64_t)))
+			{
+				m_mapSlots.emplace(pszName, static_cast<uint32_t>(nSlot));
+			}
+		}
+	}
+}
+
+void GameData::ImportTable::InitPE(const ModuleImage &aImage)
+{
+	if(!aImage.ContainsRVA(PE::DOS_LFANEW_OFFSET, sizeof(uint32_t)))
+	{
+		return;
+	}
+
+	uint32_t nNTOffset = Read<uint32_t>(aImage.GetPointer(PE::DOS_LFANEW_OFFSET));
+
+	uintptr_t nOptionalHeader = nNTOffset + sizeof(uint32_t) + sizeof(PE::FileHeader_t);
+
+	if(!aImage.ContainsRVA(nOptionalHeader, PE::OPTIONAL_DATA_DIRECTORY + (PE::DIRECTORY_IMPORT + 1) * sizeof(PE::DataDirectory_t)))
+	{
+		return;
+	}
+
+	if(Read<uint32_t>(aImage.GetPointer(nOptionalHeader + PE::OPTIONAL_NUMBER_OF_RVA_AND_SIZES)) <= PE::DIRECTORY_IMPORT)
+	{
+		return;
+	}
+
+	const auto aImports = Read<PE::DataDirectory_t>(aImage.GetPointer(nOptionalHeader + PE::OPTIONAL_DATA_DIRECTORY + PE::DIRECTORY_IMPORT * sizeof(PE::DataDirectory_t)));
+
+	for(uintptr_t nDescriptor = aImports.VirtualAddress; aImage.ContainsRVA(nDescriptor, sizeof(PE::ImportDescriptor_t)); nDescriptor += sizeof(PE::ImportDescriptor_t))
+	{
+		const auto aDescriptor = Read<PE::ImportDescriptor_t>(aImage.GetPointer(nDescriptor));
+
+		// A zeroed descriptor terminates the directory.
+		if(!aDescriptor.FirstThunk)
+		{
+			break;
+		}
+
+		// Without the lookup table (old linkers), the address table holds the names until bound.
+		uintptr_t nLookup = aDescriptor.OriginalFirstThunk ? aDescriptor.OriginalFirstThunk : aDescriptor.FirstThunk;
+
+		for(uint32_t n = 0; aImage.ContainsRVA(nLookup + n * sizeof(uint64_t), sizeof(uint64_t)); n++)
+		{
+			uint64_t nEntry = Read<uint64_t>(aImage.GetPointer(nLookup + n * sizeof(uint64_t)));
+
+			if(!nEntry)
+			{
+				break;
+			}
+
+			uintptr_t nName = static_cast<uintptr_t>(nEntry) + sizeof(uint16_t);
+
+			if(nEntry & PE::IMPORT_ORDINAL_FLAG || !aImage.ContainsRVA(nName, 1))
+			{
+				continue;
+			}
+
+			const char *pszName = aImage.GetPointer<char>(nName);
+
+			if(strnlen(pszName, aImage.GetSize() - nName) < aImage.GetSize() - nName)
+			{
+				m_mapSlots.emplace(pszName, static_cast<uint32_t>(aDescriptor.FirstThunk + n * sizeof(uint64_t)));
+			}
+		}
+	}
+}
@@ -0,0 +1,502 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/instruction.hpp>
+
+#include <string.h>
+
+#define MAX_INSTRUCTION_LENGTH 15
+
+enum ImmediateKind : int
+{
+	IMMEDIATE_INVALID = -1,
+
+	IMMEDIATE_NONE = 0,
+	IMMEDIATE_BYTE, // ib
+	IMMEDIATE_WORD, // iw
+	IMMEDIATE_ZWORD, // iz: 16 or 32 bits by the operand size
+	IMMEDIATE_VWORD, // iv: 16, 32 or 64 bits by the operand size
+	IMMEDIATE_ENTER, // iw, ib
+	IMMEDIATE_OFFSET, // moffs: 64 or 32 bits by the address size
+	IMMEDIATE_RELATIVE8,
+	IMMEDIATE_RELATIVE32,
+}; // ImmediateKind
+
+struct Form_t
+{
+	bool m_bModRM;
+	ImmediateKind m_eImmediate;
+	int m_nFlags;
+};
+
+static Form_t GetOneByteForm(uint8_t nOpcode)
+{
+	if(nOpcode < 0x40)
+	{
+		switch(nOpcode)
+		{
+			case 0x06: case 0x07: case 0x0E: case 0x16: case 0x17: case 0x1E: case 0x1F:
+			case 0x27: case 0x2F: case 0x37: case 0x3F:
+				return {false, IMMEDIATE_INVALID, 0};
+		}
+
+		switch(nOpcode & 7)
+		{
+			case 4: return {false, IMMEDIATE_BYTE, 0};
+			case 5: return {false, IMMEDIATE_ZWORD, 0};
+			default: return {true, IMMEDIATE_NONE, 0};
+		}
+	}
+
+	if(nOpcode >= 0x70 && nOpcode <= 0x7F)
+	{
+		return {false, IMMEDIATE_RELATIVE8, GameData::INSTRUCTION_JUMP | GameData::INSTRUCTION_CONDITIONAL};
+	}
+
+	if(nOpcode >= 0x84 && nOpcode <= 0x8F)
+	{
+		return {true, IMMEDIATE_NONE, 0};
+	}
+
+	if(nOpcode >= 0xB0 && nOpcode <= 0xB7)
+	{
+		return {false, IMMEDIATE_BYTE, 0};
+	}
+
+	if(nOpcode >= 0xB8 && nOpcode <= 0xBF)
+	{
+		return {false, IMMEDIATE_VWORD, 0};
+	}
+
+	if(nOpcode >= 0xD8 && nOpcode <= 0xDF)
+	{
+		return {true, IMMEDIATE_NONE, 0}; // x87
+	}
+
+	switch(nOpcode)
+	{
+		case 0x60: case 0x61: case 0x82: case 0x9A: case 0xCE: case 0xD4: case 0xD5: case 0xD6: case 0xEA:
+			return {false, IMMEDIATE_INVALID, 0};
+
+		case 0x63: return {true, IMMEDIATE_NONE, 0};
+		case 0x68: return {false, IMMEDIATE_ZWORD, 0};
+		case 0x69: return {true, IMMEDIATE_ZWORD, 0};
+		case 0x6A: return {false, IMMEDIATE_BYTE, 0};
+		case 0x6B: return {true, IMMEDIATE_BYTE, 0};
+
+		case 0x80: return {true, IMMEDIATE_BYTE, 0};
+		case 0x81: return {true, IMMEDIATE_ZWORD, 0};
+		case 0x83: return {true, IMMEDIATE_BYTE, 0};
+
+		case 0xA0: case 0xA1: case 0xA2: case 0xA3:
+			return {false, IMMEDIATE_OFFSET, 0};
+
+		case 0xA8: return {false, IMMEDIATE_BYTE, 0};
+		case 0xA9: return {false, IMMEDIATE_ZWORD, 0};
+
+		case 0xC0: case 0xC1: case 0xC6:
+			return {true, IMMEDIATE_BYTE, 0};
+
+		case 0xC2: case 0xCA:
+			return {false, IMMEDIATE_WORD, GameData::INSTRUCTION_RETURN};
+
+		case 0xC3: case 0xCB:
+			return {false, IMMEDIATE_NONE, GameData::INSTRUCTION_RETURN};
+
+		case 0xC7: return {true, IMMEDIATE_ZWORD, 0};
+		case 0xC8: return {false, IMMEDIATE_ENTER, 0};
+		case 0xCD: return {false, IMMEDIATE_BYTE, 0};
+
+		case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+			return {true, IMMEDIATE_NONE, 0};
+
+		case 0xE0: case 0xE1: case 0xE2: case 0xE3:
+			return {false, IMMEDIATE_RELATIVE8, GameData::INSTRUCTION_JUMP | GameData::INSTRUCTION_CONDITIONAL};
+
+		case 0xE4: case 0xE5: case 0xE6: case 0xE7:
+			return {false, IMMEDIATE_BYTE, 0};
+
+		case 0xE8: return {false, IMMEDIATE_RELATIVE32, GameData::INSTRUCTION_CALL};
+		case 0xE9: return {false, IMMEDIATE_RELATIVE32, GameData::INSTRUCTION_JUMP};
+		case 0xEB: return {false, IMMEDIATE_RELATIVE8, GameData::INSTRUCTION_JUMP};
+
+		case 0xF6: case 0xF7: case 0xFE: case 0xFF:
+			return {true, IMMEDIATE_NONE, 0}; // Refined by the ModRM reg field.
+	}
+
+	return {false, IMMEDIATE_NONE, 0};
+}
+
+static Form_t GetTwoByteForm(uint8_t nOpcode)
+{
+	if(nOpcode >= 0x80 && nOpcode <= 0x8F)
+	{
+		return {false, IMMEDIATE_RELATIVE32, GameData::INSTRUCTION_JUMP | GameData::INSTRUCTION_CONDITIONAL};
+	}
+
+	if(nOpcode >= 0xC8 && nOpcode <= 0xCF)
+	{
+		return {false, IMMEDIATE_NONE, 0}; // bswap
+	}
+
+	switch(nOpcode)
+	{
+		case 0x04: case 0x0A: case 0x0C: case 0x24: case 0x25: case 0x26: case 0x27:
+		case 0x39: case 0x3B: case 0x3C: case 0x3D: case 0x3E: case 0x3F: case 0xA6: case 0xA7:
+			return {false, IMMEDIATE_INVALID, 0};
+
+		case 0x05: case 0x06: case 0x07: case 0x08: case 0x09: case 0x0B: case 0x0E:
+		case 0x30: case 0x31: case 0x32: case 0x33: case 0x34: case 0x35: case 0x36: case 0x37:
+		case 0x77: case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xA9: case 0xAA:
+			return {false, IMMEDIATE_NONE, 0};
+
+		case 0x0F: // 3DNow! suffix
+		case 0x70: case 0x71: case 0x72: case 0x73:
+		case 0xA4: case 0xAC: case 0xBA: case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+			return {true, IMMEDIATE_BYTE, 0};
+	}
+
+	return {true, IMMEDIATE_NONE, 0};
+}
+
+// VEX and EVEX encoded forms always have ModRM, except vzeroupper/vzeroall.
+static Form_t GetVectorForm(uint8_t nMap, uint8_t nOpcode)
+{
+	switch(nMap)
+	{
+		case 1:
+		{
+			if(nOpcode == 0x77)
+			{
+				return {false, IMMEDIATE_NONE, 0};
+			}
+
+			switch(nOpcode)
+			{
+				case 0x70: case 0x71: case 0x72: case 0x73: case 0xC2: case 0xC4: case 0xC5: case 0xC6:
+					return {true, IMMEDIATE_BYTE, 0};
+			}
+
+			return {true, IMMEDIATE_NONE, 0};
+		}
+
+		case 3:
+			return {true, IMMEDIATE_BYTE, 0};
+
+		case 2: case 5: case 6:
+			return {true, IMMEDIATE_NONE, 0};
+	}
+
+	return {false, IMMEDIATE_INVALID, 0};
+}
+
+static int64_t ReadSigned(const uint8_t *pData, size_t nSize)
+{
+	switch(nSize)
+	{
+		case 1: return static_cast<int8_t>(pData[0]);
+		case 2: { int16_t n; memcpy(&n, pData, sizeof(n)); return n; }
+		case 4: { int32_t n; memcpy(&n, pData, sizeof(n)); return n; }
+		case 8: { int64_t n; memcpy(&n, pData, sizeof(n)); return n; }
+	}
+
+	return 0;
+}
+
+bool GameData::DecodeInstruction(const uint8_t *pData, size_t nAvailable, Instruction_t &aResult)
+{
+	memset(&aResult, 0, sizeof(aResult));
+
+	if(nAvailable > MAX_INSTRUCTION_LENGTH)
+	{
+		nAvailable = MAX_INSTRUCTION_LENGTH;
+	}
+
+	size_t n = 0;
+
+	bool bOperandSize16 = false,
+	     bAddressSize32 = false,
+	     bWide = false;
+
+	// Legacy prefixes, then at most one REX which must directly precede the opcode.
+	for(; n < nAvailable; n++)
+	{
+		uint8_t nByte = pData[n];
+
+		if(nByte == 0x66)
+		{
+			bOperandSize16 = true;
+		}
+		else if(nByte == 0x67)
+		{
+			bAddressSize32 = true;
+		}
+		else if(nByte != 0xF0 && nByte != 0xF2 && nByte != 0xF3 && nByte != 0x2E && nByte != 0x36 &&
+		        nByte != 0x3E && nByte != 0x26 && nByte != 0x64 && nByte != 0x65)
+		{
+			break;
+		}
+	}
+
+	if(n < nAvailable && (pData[n] & 0xF0) == 0x40)
+	{
+		bWide = pData[n] & 0x08;
+		n++;
+	}
+
+	if(n >= nAvailable)
+	{
+		return false;
+	}
+
+	Form_t aForm;
+
+	uint8_t nLead = pData[n];
+
+	if(nLead == 0xC5 || nLead == 0xC4 || nLead == 0x62)
+	{
+		size_t nPrefixLength = nLead == 0xC5 ? 2 : nLead == 0xC4 ? 3 : 4;
+
+		if(n + nPrefixLength >= nAvailable)
+		{
+			return false;
+		}
+
+		if(nLead == 0xC5)
+		{
+			aResult.m_nMap = 1;
+		}
+		else if(nLead == 0xC4)
+		{
+			aResult.m_nMap = pData[n + 1] & 0x1F;
+			bWide = pData[n + 2] & 0x80;
+		}
+		else
+		{
+			aResult.m_nMap = pData[n + 1] & 0x07;
+			bWide = pData[n + 2] & 0x80;
+		}
+
+		n += nPrefixLength;
+
+		aResult.m_nOpcodeOffset = static_cast<uint8_t>(n);
+		aResult.m_nOpcode = pData[n++];
+
+		aForm = GetVectorForm(aResult.m_nMap, aResult.m_nOpcode);
+	}
+	else if(nLead == 0x0F)
+	{
+		aResult.m_nOpcodeOffset = static_cast<uint8_t>(n);
+
+		if(++n >= nAvailable)
+		{
+			return false;
+		}
+
+		uint8_t nSecond = pData[n++];
+
+		if(nSecond == 0x38 || nSecond == 0x3A)
+		{
+			if(n >= nAvailable)
+			{
+				return false;
+			}
+
+			aResult.m_nMap = nSecond == 0x38 ? 2 : 3;
+			aResult.m_nOpcode = pData[n++];
+
+			aForm = {true, nSecond == 0x3A ? IMMEDIATE_BYTE : IMMEDIATE_NONE, 0};
+		}
+		else
+		{
+			aResult.m_nMap = 1;
+			aResult.m_nOpcode = nSecond;
+
+			aForm = GetTwoByteForm(nSecond);
+		}
+	}
+	else
+	{
+		aResult.m_nOpcodeOffset = static_cast<uint8_t>(n);
+		aResult.m_nOpcode = pData[n++];
+
+		aForm = GetOneByteForm(aResult.m_nOpcode);
+	}
+
+	if(aForm.m_eImmediate == IMMEDIATE_INVALID)
+	{
+		return false;
+	}
+
+	aResult.m_nFlags = aForm.m_nFlags;
+
+	if(aForm.m_bModRM)
+	{
+		if(n >= nAvailable)
+		{
+			return false;
+		}
+
+		uint8_t nModRM = pData[n++],
+		        nMod = nModRM >> 6,
+		        nReg = (nModRM >> 3) & 7,
+		        nRM = nModRM & 7;
+
+		aResult.m_nModRM = nModRM;
+		aResult.m_nFlags |= INSTRUCTION_MODRM;
+
+		if(nMod != 3)
+		{
+			size_t nDisplacementSize = nMod == 1 ? 1 : nMod == 2 ? 4 : 0;
+
+			if(nRM == 4)
+			{
+				if(n >= nAvailable)
+				{
+					return false;
+				}
+
+				// SIB without a base register.
+				if(nMod == 0 && (pData[n] & 7) == 5)
+				{
+					nDisplacementSize = 4;
+				}
+
+				n++;
+			}
+			else if(nMod == 0 && nRM == 5)
+			{
+				nDisplacementSize = 4;
+				aResult.m_nFlags |= INSTRUCTION_RIP_RELATIVE;
+			}
+
+			aResult.m_nDisplacementOffset = static_cast<uint8_t>(n);
+			aResult.m_nDisplacementSize = static_cast<uint8_t>(nDisplacementSize);
+			n += nDisplacementSize;
+		}
+
+		if(!aResult.m_nMap)
+		{
+			switch(aResult.m_nOpcode)
+			{
+				case 0xF6:
+				{
+					if(nReg < 2)
+					{
+						aForm.m_eImmediate = IMMEDIATE_BYTE;
+					}
+
+					break;
+				}
+
+				case 0xF7:
+				{
+					if(nReg < 2)
+					{
+						aForm.m_eImmediate = IMMEDIATE_ZWORD;
+					}
+
+					break;
+				}
+
+				case 0xFF:
+				{
+					if(nReg == 2 || nReg == 3)
+					{
+						aResult.m_nFlags |= INSTRUCTION_CALL | INSTRUCTION_INDIRECT;
+					}
+					else if(nReg == 4 || nReg == 5)
+					{
+						aResult.m_nFlags |= INSTRUCTION_JUMP | INSTRUCTION_INDIRECT;
+					}
+
+					break;
+				}
+			}
+		}
+	}
+
+	size_t nImmediateSize = 0;
+
+	switch(aForm.m_eImmediate)
+	{
+		case IMMEDIATE_BYTE:
+		case IMMEDIATE_RELATIVE8:
+			nImmediateSize = 1;
+			break;
+
+		case IMMEDIATE_WORD:
+			nImmediateSize = 2;
+			break;
+
+		case IMMEDIATE_ZWORD:
+			nImmediateSize = bOperandSize16 ? 2 : 4;
+			break;
+
+		case IMMEDIATE_VWORD:
+			nImmediateSize = bWide ? 8 : bOperandSize16 ? 2 : 4;
+			break;
+
+		case IMMEDIATE_ENTER:
+			nImmediateSize = 3;
+			break;
+
+		case IMMEDIATE_OFFSET:
+			nImmediateSize = bAddressSize32 ? 4 : 8;
+			break;
+
+		case IMMEDIATE_RELATIVE32:
+			nImmediateSize = 4;
+			break;
+
+		default:
+			break;
+	}
+
+	if(aForm.m_eImmediate == IMMEDIATE_RELATIVE8 || aForm.m_eImmediate == IMMEDIATE_RELATIVE32)
+	{
+		aResult.m_nFlags |= INSTRUCTION_RELATIVE;
+	}
+
+	aResult.m_nImmediateOffset = static_cast<uint8_t>(n);
+	aResult.m_nImmediateSize = static_cast<uint8_t>(nImmediateSize);
+	n += nImmediateSize;
+
+	if(n > nAvailable)
+	{
+		return false;
+	}
+
+	if(aResult.m_nDisplacementSize)
+	{
+		aResult.m_nDisplacement = ReadSigned(pData + aResult.m_nDisplacementOffset, aResult.m_nDisplacementSize);
+	}
+
+	if(nImmediateSize)
+	{
+		// ENTER reads as its 16-bit frame size.
+		aResult.m_nImmediate = ReadSigned(pData + aResult.m_nImmediateOffset, nImmediateSize == 3 ? 2 : nImmediateSize);
+	}
+
+	aResult.m_nLength = static_cast<uint8_t>(n);
+
+	return true;
+}
@@ -0,0 +1,236 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/interfaceindex.hpp>
+#include <gamedata/instruction.hpp>
+#include <gamedata/symboltable.hpp>
+
+#include <string.h>
+
+#include <unordered_set>
+
+// Far enough for a prologue and a stack protector ahead of the load.
+#define MAX_GAMEDATA_INTERFACE_SEARCH_INSTRUCTIONS 32
+
+// InterfaceReg objects are static, and a module registers a few hundred at most.
+#define MAX_GAMEDATA_INTERFACE_REGS 4096
+
+static bool DecodeAt(const GameData::ModuleImage &aImage, uintptr_t nRVA, GameData::Instruction_t &aInstruction)
+{
+	const auto *pSegment = aImage.FindSegment(nRVA);
+
+	if(!pSegment || !pSegment->IsCode() || !aImage.ContainsRVA(pSegment->m_nRVA, pSegment->m_nSize))
+	{
+		return false;
+	}
+
+	return GameData::DecodeInstruction(aImage.GetPointer(nRVA), pSegment->m_nRVA + pSegment->m_nSize - nRVA, aInstruction);
+}
+
+// Jumps of import thunks and of functions which tail-call another are followed.
+static uintptr_t SkipJumps(const GameData::ModuleImage &aImage, uintptr_t nRVA)
+{
+	for(int n = 0; n < 4; n++)
+	{
+		GameData::Instruction_t aInstruction;
+
+		uintptr_t nTarget;
+
+		if(!DecodeAt(aImage, nRVA, aInstruction) || (aInstruction.m_nFlags & (GameData::INSTRUCTION_JUMP | GameData::INSTRUCTION_CONDITIONAL | GameData::INSTRUCTION_INDIRECT)) != GameData::INSTRUCTION_JUMP ||
+		   !aInstruction.GetTarget(nRVA, nTarget))
+		{
+			break;
+		}
+
+		nRVA = nTarget;
+	}
+
+	return nRVA;
+}
+
+GameData::InterfaceIndex::InterfaceIndex(const ModuleImage &aImage)
+{
+	uintptr_t nFunction;
+
+	if(aImage.GetSize() > UINT32_MAX || !aImage.GetIndex<SymbolTable>().Find("CreateInterface", nFunction))
+	{
+		return;
+	}
+
+	nFunction = SkipJumps(aImage, nFunction);
+
+	for(int n = 0; n < MAX_GAMEDATA_INTERFACE_SEARCH_INSTRUCTIONS; n++)
+	{
+		Instruction_t aInstruction;
+
+		// Straight-line code only; conditional jumps fall through to the walk.
+		if(!DecodeAt(aImage, nFunction, aInstruction) || aInstruction.m_nFlags & INSTRUCTION_RETURN ||
+		   (aInstruction.m_nFlags & (INSTRUCTION_JUMP | INSTRUCTION_CONDITIONAL)) == INSTRUCTION_JUMP)
+		{
+			break;
+		}
+
+		uintptr_t nHead;
+
+		// mov r64, [rip + s_pInterfaceRegs]: the first global CreateInterface loads which walks as a list.
+		if(!aInstruction.m_nMap && aInstruction.m_nOpcode == 0x8B && aInstruction.GetTarget(nFunction, nHead) && Walk(aImage, nHead))
+		{
+			break;
+		}
+
+		nFunction += aInstruction.m_nLength;
+	}
+}
+
+size_t GameData::InterfaceIndex::GetCount() const
+{
+	return m_mapInterfaces.size();
+}
+
+const GameData::InterfaceIndex::Interface_t *GameData::InterfaceIndex::Find(const char *pszVersion) const
+{
+	auto itFound = m_mapInterfaces.find(pszVersion);
+
+	return itFound != m_mapInterfaces.end() ? &itFound->second : nullptr;
+}
+
+void *GameData::InterfaceIndex::Instantiate(const ModuleImage &aImage, const Interface_t &aInterface) const
+{
+	if(!aImage.IsLive())
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> aLock(m_mtxInstances);
+
+	auto &pInstance = m_mapInstances[aInterface.m_nCreate];
+
+	if(!pInstance)
+	{
+		using InstantiateInterfaceFn = void *(*)();
+
+		// Constructs the object, as CreateInterface would.
+		pInstance = reinterpret_cast<InstantiateInterfaceFn>(aImage.FromRVA(aInterface.m_nCreate))();
+	}
+
+	return pInstance;
+}
+
+uint32_t GameData::InterfaceIndex::FindStaticInstance(const ModuleImage &aImage, uintptr_t nFunction)
+{
+	nFunction = SkipJumps(aImage, nFunction);
+
+	Instruction_t aLoad, aReturn;
+
+	uintptr_t nInstance;
+
+	if(!DecodeAt(aImage, nFunction, aLoad) || aLoad.m_nMap || aLoad.m_nOpcode != 0x8D || !aLoad.GetTarget(nFunction, nInstance))
+	{
+		return 0;
+	}
+
+	const uint8_t *pLoad = aImage.GetPointer(nFunction);
+
+	// The destination has to be rax: ModRM.reg = 0 without REX.R.
+	bool bREXR = aLoad.m_nOpcodeOffset && (pLoad[aLoad.m_nOpcodeOffset - 1] & 0xF4) == 0x44;
+
+	if((aLoad.m_nModRM & 0x38) || bREXR)
+	{
+		return 0;
+	}
+
+	if(!DecodeAt(aImage, nFunction + aLoad.m_nLength, aReturn) || !(aReturn.m_nFlags & INSTRUCTION_RETURN) || !aImage.ContainsRVA(nInstance))
+	{
+		return 0;
+	}
+
+	return static_cast<uint32_t>(nInstance);
+}
+
+bool GameData::InterfaceIndex::Walk(const ModuleImage &aImage, uintptr_t nHead)
+{
+	if(!aImage.ContainsRVA(nHead, sizeof(uint64_t)))
+	{
+		return false;
+	}
+
+	uint64_t pCur;
+
+	memcpy(&pCur, aImage.GetPointer(nHead), sizeof(pCur));
+
+	std::unordered_map<std::string, Interface_t> mapInterfaces;
+
+	std::unordered_set<uint64_t> setVisited;
+
+	// Links are runtime addresses, of the registrations of this very module.
+	while(pCur && aImage.Contains(static_cast<uintptr_t>(pCur)) && setVisited.size() < MAX_GAMEDATA_INTERFACE_REGS && setVisited.insert(pCur).second)
+	{
+		uintptr_t nReg = aImage.ToRVA(static_cast<uintptr_t>(pCur));
+
+		if(!aImage.ContainsRVA(nReg, sizeof(InterfaceReg_t)))
+		{
+			return false;
+		}
+
+		InterfaceReg_t aReg;
+
+		memcpy(&aReg, aImage.GetPointer(nReg), sizeof(aReg));
+
+		if(!aImage.Contains(static_cast<uintptr_t>(aReg.m_pCreateFn)) || !aImage.Contains(static_cast<uintptr_t>(aReg.m_pName)))
+		{
+			return false;
+		}
+
+		uintptr_t nCreate = aImage.ToRVA(static_cast<uintptr_t>(aReg.m_pCreateFn)),
+		          nName = aImage.ToRVA(static_cast<uintptr_t>(aReg.m_pName));
+
+		const auto *pSegment = aImage.FindSegment(nName);
+
+		if(!pSegment || !aImage.ContainsRVA(pSegment->m_nRVA, pSegment->m_nSize))
+		{
+			return false;
+		}
+
+		const char *pszName = aImage.GetPointer<char>(nName);
+
+		size_t nLimit = pSegment->m_nRVA + pSegment->m_nSize - nName;
+
+		if(strnlen(pszName, nLimit) == nLimit)
+		{
+			return false;
+		}
+
+		// Registered at the head: of duplicate versions, the last constructed one is what
+		// CreateInterface returns, and that is the first one met.
+		mapInterfaces.emplace(pszName, Interface_t {static_cast<uint32_t>(nCreate), FindStaticInstance(aImage, nCreate)});
+
+		pCur = aReg.m_pNext;
+	}
+
+	if(mapInterfaces.empty())
+	{
+		return false;
+	}
+
+	m_mapInterfaces = std::move(mapInterfaces);
+
+	return true;
+}
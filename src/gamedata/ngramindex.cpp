@@ -0,0 +1,440 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/ngramindex.hpp>
+#include <gamedata/fingerprint.hpp>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+
+#define GAMEDATA_NGRAM_CACHE_VERSION 1
+#define GAMEDATA_NGRAM_MIN_BUCKET_BITS 10
+#define GAMEDATA_NGRAM_MAX_BUCKET_BITS 24
+#define GAMEDATA_NGRAM_MAX_INTERSECTED 4
+
+struct NGramCacheHeader_t
+{
+	char m_szMagic[8];
+	uint32_t m_nVersion;
+	uint32_t m_nBucketBits;
+	uint64_t m_nPositions;
+	uint64_t m_nImageSize;
+	char m_szFingerprint[MAX_GAMEDATA_FINGERPRINT_STRING_LENGTH];
+};
+
+static const char s_szCacheMagic[8] = "GDNGRAM";
+
+static std::mutex s_mtxCacheDirectory;
+static std::string s_sCacheDirectory;
+
+static std::string GetCachePath(const GameData::ModuleImage &aImage)
+{
+	std::string sDirectory = GameData::NGramIndex::GetCacheDirectory();
+
+	if(sDirectory.empty())
+	{
+		return {};
+	}
+
+	const auto &aFingerprint = GameData::GetModuleFingerprint(&aImage);
+
+	if(!aFingerprint.IsValid())
+	{
+		return {};
+	}
+
+	char szFingerprint[MAX_GAMEDATA_FINGERPRINT_STRING_LENGTH];
+
+	aFingerprint.ToString(szFingerprint, sizeof(szFingerprint));
+
+	// "id:8f3c..." is not a valid file name everywhere.
+	std::replace(szFingerprint, szFingerprint + strlen(szFingerprint), ':', '-');
+
+	char cLast = sDirectory.back();
+
+	if(cLast != '/' && cLast != '\\')
+	{
+		sDirectory += '/';
+	}
+
+	return sDirectory + szFingerprint + ".ngram";
+}
+
+GameData::NGramIndex::NGramIndex(const ModuleImage &aImage)
+ :  m_aImage(aImage),
+    m_nBucketBits(0),
+    m_bCached(false)
+{
+	std::string sPath = GetCachePath(aImage);
+
+	if(!sPath.empty() && Load(sPath))
+	{
+		m_bCached = true;
+
+		return;
+	}
+
+	Build();
+
+	if(!sPath.empty() && IsValid())
+	{
+		Save(sPath);
+	}
+}
+
+void GameData::NGramIndex::SetCacheDirectory(const char *pszPath)
+{
+	std::lock_guard<std::mutex> aLock(s_mtxCacheDirectory);
+
+	s_sCacheDirectory = pszPath ? pszPath : "";
+}
+
+std::string GameData::NGramIndex::GetCacheDirectory()
+{
+	std::lock_guard<std::mutex> aLock(s_mtxCacheDirectory);
+
+	return s_sCacheDirectory;
+}
+
+bool GameData::NGramIndex::IsValid() const
+{
+	return !m_vecOffsets.empty();
+}
+
+bool GameData::NGramIndex::IsCached() const
+{
+	return m_bCached;
+}
+
+size_t GameData::NGramIndex::GetPositionCount() const
+{
+	return m_vecPositions.size();
+}
+
+bool GameData::NGramIndex::CanFind(const Pattern &aPattern) const
+{
+	if(!IsValid())
+	{
+		return false;
+	}
+
+	const uint8_t *pMask = aPattern.GetMask();
+
+	size_t nRun = 0;
+
+	for(size_t n = 0, nLength = aPattern.GetLength(); n < nLength; n++)
+	{
+		nRun = pMask[n] ? nRun + 1 : 0;
+
+		if(nRun == GAMEDATA_NGRAM_LENGTH)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool GameData::NGramIndex::Find(const Pattern &aPattern, uintptr_t &nRVA) const
+{
+	struct Gram_t
+	{
+		size_t m_nOffset;
+		uint32_t m_nBucket;
+
+		const uint32_t *m_pBegin;
+		const uint32_t *m_pEnd;
+
+		size_t GetCount() const
+		{
+			return static_cast<size_t>(m_pEnd - m_pBegin);
+		}
+	};
+
+	const uint8_t *pBytes = aPattern.GetBytes(),
+	              *pMask = aPattern.GetMask();
+
+	size_t nLength = aPattern.GetLength();
+
+	std::vector<Gram_t> vecGrams;
+
+	for(size_t n = 0, nRun = 0; n < nLength; n++)
+	{
+		nRun = pMask[n] ? nRun + 1 : 0;
+
+		if(nRun >= GAMEDATA_NGRAM_LENGTH)
+		{
+			Gram_t aGram {n + 1 - GAMEDATA_NGRAM_LENGTH, GetBucket(pBytes + n + 1 - GAMEDATA_NGRAM_LENGTH)};
+
+			GetPostings(aGram.m_nBucket, aGram.m_pBegin, aGram.m_pEnd);
+			vecGrams.push_back(aGram);
+		}
+	}
+
+	if(vecGrams.empty())
+	{
+		return false;
+	}
+
+	std::sort(vecGrams.begin(), vecGrams.end(), [](const Gram_t &aLeft, const Gram_t &aRight)
+	{
+		return aLeft.GetCount() < aRight.GetCount();
+	});
+
+	// The rarest gram drives, a few more filter; verification catches the rest.
+	std::vector<Gram_t> vecFilters;
+
+	for(size_t n = 1; n < vecGrams.size() && vecFilters.size() < GAMEDATA_NGRAM_MAX_INTERSECTED - 1; n++)
+	{
+		if(vecGrams[n].m_nBucket != vecGrams[0].m_nBucket)
+		{
+			vecFilters.push_back(vecGrams[n]);
+		}
+	}
+
+	const Gram_t &aDriver = vecGrams[0];
+
+	for(const uint32_t *pPosition = aDriver.m_pBegin; pPosition != aDriver.m_pEnd; pPosition++)
+	{
+		if(*pPosition < aDriver.m_nOffset)
+		{
+			continue;
+		}
+
+		uintptr_t nStart = *pPosition - aDriver.m_nOffset;
+
+		bool bCandidate = true;
+
+		for(const auto &aFilter : vecFilters)
+		{
+			if(!std::binary_search(aFilter.m_pBegin, aFilter.m_pEnd, static_cast<uint32_t>(nStart + aFilter.m_nOffset)))
+			{
+				bCandidate = false;
+
+				break;
+			}
+		}
+
+		if(!bCandidate)
+		{
+			continue;
+		}
+
+		const auto *pSegment = m_aImage.FindSegment(nStart);
+
+		if(!pSegment || !pSegment->IsCode() || nStart + nLength > pSegment->m_nRVA + pSegment->m_nSize)
+		{
+			continue;
+		}
+
+		if(aPattern.Match(m_aImage.GetPointer(nStart)))
+		{
+			nRVA = nStart;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void GameData::NGramIndex::Build()
+{
+	if(m_aImage.GetSize() > UINT32_MAX)
+	{
+		return;
+	}
+
+	// In RVA order, so that every posting list comes out sorted.
+	std::vector<const ModuleImage::Segment_t *> vecSegments;
+
+	size_t nTotal = 0;
+
+	for(const auto &it : m_aImage.GetSegments())
+	{
+		if(it.IsCode() && it.m_nSize >= GAMEDATA_NGRAM_LENGTH && m_aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			vecSegments.push_back(&it);
+			nTotal += it.m_nSize - GAMEDATA_NGRAM_LENGTH + 1;
+		}
+	}
+
+	if(!nTotal)
+	{
+		return;
+	}
+
+	std::sort(vecSegments.begin(), vecSegments.end(), [](const ModuleImage::Segment_t *pLeft, const ModuleImage::Segment_t *pRight)
+	{
+		return pLeft->m_nRVA < pRight->m_nRVA;
+	});
+
+	// About four positions per bucket.
+	m_nBucketBits = GAMEDATA_NGRAM_MIN_BUCKET_BITS;
+
+	while(m_nBucketBits < GAMEDATA_NGRAM_MAX_BUCKET_BITS && (static_cast<size_t>(1) << (m_nBucketBits + 2)) < nTotal)
+	{
+		m_nBucketBits++;
+	}
+
+	size_t nBuckets = static_cast<size_t>(1) << m_nBucketBits;
+
+	m_vecOffsets.assign(nBuckets + 1, 0);
+	m_vecPositions.resize(nTotal);
+
+	for(const auto *pSegment : vecSegments)
+	{
+		const uint8_t *pData = m_aImage.GetPointer(pSegment->m_nRVA);
+
+		for(size_t n = 0, nCount = pSegment->m_nSize - GAMEDATA_NGRAM_LENGTH + 1; n < nCount; n++)
+		{
+			m_vecOffsets[GetBucket(pData + n) + 1]++;
+		}
+	}
+
+	for(size_t n = 0; n < nBuckets; n++)
+	{
+		m_vecOffsets[n + 1] += m_vecOffsets[n];
+	}
+
+	std::vector<uint32_t> vecCursors(m_vecOffsets.begin(), m_vecOffsets.end() - 1);
+
+	for(const auto *pSegment : vecSegments)
+	{
+		const uint8_t *pData = m_aImage.GetPointer(pSegment->m_nRVA);
+
+		for(size_t n = 0, nCount = pSegment->m_nSize - GAMEDATA_NGRAM_LENGTH + 1; n < nCount; n++)
+		{
+			m_vecPositions[vecCursors[GetBucket(pData + n)]++] = static_cast<uint32_t>(pSegment->m_nRVA + n);
+		}
+	}
+}
+
+bool GameData::NGramIndex::Load(const std::string &sPath)
+{
+	FILE *pFile = fopen(sPath.c_str(), "rb");
+
+	if(!pFile)
+	{
+		return false;
+	}
+
+	NGramCacheHeader_t aHeader;
+
+	char szFingerprint[MAX_GAMEDATA_FINGERPRINT_STRING_LENGTH];
+
+	GetModuleFingerprint(&m_aImage).ToString(szFingerprint, sizeof(szFingerprint));
+
+	bool bResult = fread(&aHeader, sizeof(aHeader), 1, pFile) == 1 &&
+	               !memcmp(aHeader.m_szMagic, s_szCacheMagic, sizeof(s_szCacheMagic)) &&
+	               aHeader.m_nVersion == GAMEDATA_NGRAM_CACHE_VERSION &&
+	               aHeader.m_nBucketBits >= GAMEDATA_NGRAM_MIN_BUCKET_BITS && aHeader.m_nBucketBits <= GAMEDATA_NGRAM_MAX_BUCKET_BITS &&
+	               aHeader.m_nImageSize == m_aImage.GetSize() && aHeader.m_nPositions <= m_aImage.GetSize() &&
+	               !strncmp(aHeader.m_szFingerprint, szFingerprint, sizeof(szFingerprint));
+
+	if(bResult)
+	{
+		m_nBucketBits = aHeader.m_nBucketBits;
+		m_vecOffsets.resize((static_cast<size_t>(1) << m_nBucketBits) + 1);
+		m_vecPositions.resize(static_cast<size_t>(aHeader.m_nPositions));
+
+		bResult = fread(m_vecOffsets.data(), sizeof(uint32_t), m_vecOffsets.size(), pFile) == m_vecOffsets.size() &&
+		          fread(m_vecPositions.data(), sizeof(uint32_t), m_vecPositions.size(), pFile) == m_vecPositions.size();
+	}
+
+	fclose(pFile);
+
+	// A truncated or foreign file must not index out of bounds later.
+	if(bResult)
+	{
+		bResult = !m_vecOffsets.front() && m_vecOffsets.back() == m_vecPositions.size() &&
+		          std::is_sorted(m_vecOffsets.begin(), m_vecOffsets.end());
+	}
+
+	if(!bResult)
+	{
+		m_nBucketBits = 0;
+		m_vecOffsets.clear();
+		m_vecPositions.clear();
+	}
+
+	return bResult;
+}
+
+bool GameData::NGramIndex::Save(const std::string &sPath) const
+{
+	NGramCacheHeader_t aHeader {};
+
+	memcpy(aHeader.m_szMagic, s_szCacheMagic, sizeof(s_szCacheMagic));
+	aHeader.m_nVersion = GAMEDATA_NGRAM_CACHE_VERSION;
+	aHeader.m_nBucketBits = m_nBucketBits;
+	aHeader.m_nPositions = m_vecPositions.size();
+	aHeader.m_nImageSize = m_aImage.GetSize();
+	GetModuleFingerprint(&m_aImage).ToString(aHeader.m_szFingerprint, sizeof(aHeader.m_szFingerprint));
+
+	// Written aside and renamed, so that a concurrent reader never sees half a file.
+	std::string sTemporary = sPath + ".tmp";
+
+	FILE *pFile = fopen(sTemporary.c_str(), "wb");
+
+	if(!pFile)
+	{
+		return false;
+	}
+
+	bool bResult = fwrite(&aHeader, sizeof(aHeader), 1, pFile) == 1 &&
+	               fwrite(m_vecOffsets.data(), sizeof(uint32_t), m_vecOffsets.size(), pFile) == m_vecOffsets.size() &&
+	               fwrite(m_vecPositions.data(), sizeof(uint32_t), m_vecPositions.size(), pFile) == m_vecPositions.size();
+
+	bResult &= !fclose(pFile);
+
+	if(bResult)
+	{
+		remove(sPath.c_str());
+
+		bResult = !rename(sTemporary.c_str(), sPath.c_str());
+	}
+
+	if(!bResult)
+	{
+		remove(sTemporary.c_str());
+	}
+
+	return bResult;
+}
+
+uint32_t GameData::NGramIndex::GetBucket(const uint8_t *pGram) const
+{
+	uint32_t nGram;
+
+	memcpy(&nGram, pGram, sizeof(nGram));
+
+	return (nGram * 0x9E3779B1u) >> (32 - m_nBucketBits);
+}
+
+void GameData::NGramIndex::GetPostings(uint32_t nBucket, const uint32_t *&pBegin, const uint32_t *&pEnd) const
+{
+	pBegin = m_vecPositions.data() + m_vecOffsets[nBucket];
+	pEnd = m_vecPositions.data() + m_vecOffsets[nBucket + 1];
+}
@@ -0,0 +1,342 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/patcher.hpp>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#	include <windows.h>
+#else
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+struct Region_t
+{
+	uintptr_t m_pStart;
+	uintptr_t m_pEnd;
+	unsigned long m_nProtection;
+};
+
+static size_t GetPageSize()
+{
+#if defined(_WIN32)
+	SYSTEM_INFO aInfo;
+
+	GetSystemInfo(&aInfo);
+
+	return aInfo.dwPageSize;
+#else
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// The protection of every page in the ranges (sorted, disjoint), as runs of equal protection.
+// Fails if a page is not mapped.
+static bool QueryProtection(const std::vector<Region_t> &vecRanges, std::vector<Region_t> &vecRegions, std::string &sError)
+{
+#if defined(_WIN32)
+	for(const auto &it : vecRanges)
+	{
+		for(uintptr_t pCur = it.m_pStart; pCur < it.m_pEnd; )
+		{
+			MEMORY_BASIC_INFORMATION aInfo;
+
+			if(!VirtualQuery(reinterpret_cast<LPCVOID>(pCur), &aInfo, sizeof(aInfo)) || aInfo.State != MEM_COMMIT)
+			{
+				sError = "Failed to query the protection of a patched page";
+
+				return false;
+			}
+
+			uintptr_t pEnd = std::min(reinterpret_cast<uintptr_t>(aInfo.BaseAddress) + aInfo.RegionSize, it.m_pEnd);
+
+			vecRegions.push_back({pCur, pEnd, aInfo.Protect});
+			pCur = pEnd;
+		}
+	}
+
+	return true;
+#elif defined(__linux__)
+	FILE *pFile = fopen("/proc/self/maps", "r");
+
+	if(!pFile)
+	{
+		sError = "Failed to open \"/proc/self/maps\"";
+
+		return false;
+	}
+
+	std::vector<Region_t> vecMappings;
+
+	char szLine[512];
+
+	while(fgets(szLine, sizeof(szLine), pFile))
+	{
+		unsigned long long nStart, nEnd;
+
+		char szPerms[5];
+
+		if(sscanf(szLine, "%llx-%llx %4s", &nStart, &nEnd, szPerms) == 3)
+		{
+			unsigned long nProtection = (szPerms[0] == 'r' ? PROT_READ : 0) | (szPerms[1] == 'w' ? PROT_WRITE : 0) | (szPerms[2] == 'x' ? PROT_EXEC : 0);
+
+			vecMappings.push_back({static_cast<uintptr_t>(nStart), static_cast<uintptr_t>(nEnd), nProtection});
+		}
+
+		// Lines longer than the buffer: skip the rest of the path.
+		while(!strchr(szLine, '\n') && fgets(szLine, sizeof(szLine), pFile))
+		{
+		}
+	}
+
+	fclose(pFile);
+
+	auto itMapping = vecMappings.begin();
+
+	for(const auto &it : vecRanges)
+	{
+		for(uintptr_t pCur = it.m_pStart; pCur < it.m_pEnd; )
+		{
+			while(itMapping != vecMappings.end() && itMapping->m_pEnd <= pCur)
+			{
+				++itMapping;
+			}
+
+			if(itMapping == vecMappings.end() || itMapping->m_pStart > pCur)
+			{
+				sError = "A patched page is not mapped";
+
+				return false;
+			}
+
+			uintptr_t pEnd = std::min(itMapping->m_pEnd, it.m_pEnd);
+
+			vecRegions.push_back({pCur, pEnd, itMapping->m_nProtection});
+			pCur = pEnd;
+		}
+	}
+
+	return true;
+#else
+	sError = "Patching is not supported on this platform";
+
+	return false;
+#endif
+}
+
+static bool IsWritable(unsigned long nProtection)
+{
+#if defined(_WIN32)
+	return nProtection & (PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY);
+#else
+	return nProtection & PROT_WRITE;
+#endif
+}
+
+// Execution stays allowed: other threads may be running the code being patched.
+static bool SetProtection(const Region_t &aRegion, bool bWritable)
+{
+#if defined(_WIN32)
+	unsigned long nProtection = aRegion.m_nProtection;
+
+	if(bWritable)
+	{
+		nProtection = nProtection & (PAGE_EXECUTE | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY) ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+	}
+
+	DWORD nOldProtection;
+
+	return VirtualProtect(reinterpret_cast<LPVOID>(aRegion.m_pStart), aRegion.m_pEnd - aRegion.m_pStart, nProtection, &nOldProtection);
+#else
+	int iProtection = static_cast<int>(aRegion.m_nProtection) | (bWritable ? PROT_READ | PROT_WRITE : 0);
+
+	return !mprotect(reinterpret_cast<void *>(aRegion.m_pStart), aRegion.m_pEnd - aRegion.m_pStart, iProtection);
+#endif
+}
+
+void GameData::Patcher::Add(uintptr_t pAddress, const uint8_t *pBytes, size_t nLength)
+{
+	m_vecPending.push_back({pAddress, std::vector<uint8_t>(pBytes, pBytes + nLength)});
+}
+
+bool GameData::Patcher::Apply(std::string &sError)
+{
+	if(m_vecPending.empty())
+	{
+		return true;
+	}
+
+	std::vector<Write_t> vecOriginals;
+
+	vecOriginals.reserve(m_vecPending.size());
+
+	for(const auto &it : m_vecPending)
+	{
+		const auto *pCurrent = reinterpret_cast<const uint8_t *>(it.m_pAddress);
+
+		vecOriginals.push_back({it.m_pAddress, std::vector<uint8_t>(pCurrent, pCurrent + it.m_vecBytes.size())});
+	}
+
+	bool bWritten;
+
+	bool bResult = Write(m_vecPending, bWritten, sError);
+
+	if(bWritten)
+	{
+		m_vecJournal.insert(m_vecJournal.end(), std::make_move_iterator(vecOriginals.begin()), std::make_move_iterator(vecOriginals.end()));
+	}
+
+	m_vecPending.clear();
+
+	return bResult;
+}
+
+bool GameData::Patcher::Revert(std::string &sError)
+{
+	if(m_vecJournal.empty())
+	{
+		return true;
+	}
+
+	std::reverse(m_vecJournal.begin(), m_vecJournal.end());
+
+	bool bWritten;
+
+	bool bResult = Write(m_vecJournal, bWritten, sError);
+
+	if(bWritten)
+	{
+		m_vecJournal.clear();
+	}
+	else
+	{
+		std::reverse(m_vecJournal.begin(), m_vecJournal.end());
+	}
+
+	return bResult;
+}
+
+size_t GameData::Patcher::GetPendingCount() const
+{
+	return m_vecPending.size();
+}
+
+size_t GameData::Patcher::GetAppliedCount() const
+{
+	return m_vecJournal.size();
+}
+
+bool GameData::Patcher::Write(const std::vector<Write_t> &vecWrites, bool &bWritten, std::string &sError)
+{
+	bWritten = false;
+
+	const uintptr_t nPageMask = GetPageSize() - 1;
+
+	std::vector<Region_t> vecRanges;
+
+	vecRanges.reserve(vecWrites.size());
+
+	for(const auto &it : vecWrites)
+	{
+		if(!it.m_vecBytes.empty())
+		{
+			vecRanges.push_back({it.m_pAddress & ~nPageMask, (it.m_pAddress + it.m_vecBytes.size() + nPageMask) & ~nPageMask, 0});
+		}
+	}
+
+	std::sort(vecRanges.begin(), vecRanges.end(), [](const Region_t &aLeft, const Region_t &aRight) { return aLeft.m_pStart < aRight.m_pStart; });
+
+	// Adjacent pages are one range, so a run of them changes protection at once.
+	size_t nMerged = 0;
+
+	for(const auto &it : vecRanges)
+	{
+		if(nMerged && vecRanges[nMerged - 1].m_pEnd >= it.m_pStart)
+		{
+			vecRanges[nMerged - 1].m_pEnd = std::max(vecRanges[nMerged - 1].m_pEnd, it.m_pEnd);
+		}
+		else
+		{
+			vecRanges[nMerged++] = it;
+		}
+	}
+
+	vecRanges.resize(nMerged);
+
+	std::vector<Region_t> vecRegions, vecChanged;
+
+	if(!QueryProtection(vecRanges, vecRegions, sError))
+	{
+		return false;
+	}
+
+	for(const auto &it : vecRegions)
+	{
+		if(IsWritable(it.m_nProtection))
+		{
+			continue;
+		}
+
+		if(!SetProtection(it, true))
+		{
+			for(const auto &itChanged : vecChanged)
+			{
+				SetProtection(itChanged, false);
+			}
+
+			sError = "Failed to make a patched page writable";
+
+			return false;
+		}
+
+		vecChanged.push_back(it);
+	}
+
+	for(const auto &it : vecWrites)
+	{
+		memcpy(reinterpret_cast<void *>(it.m_pAddress), it.m_vecBytes.data(), it.m_vecBytes.size());
+	}
+
+	bWritten = true;
+
+	bool bResult = true;
+
+	for(const auto &it : vecChanged)
+	{
+		bResult &= SetProtection(it, false);
+
+#if defined(_WIN32)
+		FlushInstructionCache(GetCurrentProcess(), reinterpret_cast<LPCVOID>(it.m_pStart), it.m_pEnd - it.m_pStart);
+#endif
+	}
+
+	if(!bResult)
+	{
+		sError = "Failed to restore the protection of a patched page";
+	}
+
+	return bResult;
+}
@@ -0,0 +1,485 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/pattern.hpp>
+#include <gamedata/hash.hpp>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#	include <emmintrin.h>
+#	define GAMEDATA_PATTERN_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+static inline int CountBits(uint32_t nValue)
+{
+#if defined(_MSC_VER)
+	return static_cast<int>(__popcnt(nValue));
+#else
+	return __builtin_popcount(nValue);
+#endif
+}
+
+static inline int HexDigit(char c)
+{
+	if(c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+
+	if(c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+
+	if(c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+GameData::Pattern::Pattern()
+ :  m_nAnchor(0),
+    m_nCompanion(0),
+    m_nHash(0)
+{
+}
+
+GameData::Pattern::Pattern(const char *pszPattern)
+ :  Pattern()
+{
+	Compile(pszPattern);
+}
+
+bool GameData::Pattern::Compile(const char *pszPattern)
+{
+	std::vector<uint8_t> vecBytes, vecMask;
+
+	const char *psz = pszPattern;
+
+	while(*psz)
+	{
+		if(isspace(static_cast<unsigned char>(*psz)))
+		{
+			psz++;
+
+			continue;
+		}
+
+		if(*psz == '?')
+		{
+			psz += psz[1] == '?' ? 2 : 1;
+
+			vecBytes.push_back(0);
+			vecMask.push_back(0x00);
+
+			continue;
+		}
+
+		int nHigh = HexDigit(psz[0]),
+		    nLow = nHigh < 0 ? -1 : HexDigit(psz[1]);
+
+		if(nLow < 0)
+		{
+			m_vecBytes.clear();
+			m_vecMask.clear();
+
+			return false;
+		}
+
+		psz += 2;
+
+		vecBytes.push_back(static_cast<uint8_t>((nHigh << 4) | nLow));
+		vecMask.push_back(0xFF);
+	}
+
+	return Assign(vecBytes.data(), vecMask.data(), vecBytes.size());
+}
+
+bool GameData::Pattern::Assign(const uint8_t *pBytes, const uint8_t *pMask, size_t nLength)
+{
+	m_vecMask.assign(pMask, pMask + nLength);
+	m_vecBytes.resize(nLength);
+
+	for(size_t n = 0; n < nLength; n++)
+	{
+		m_vecBytes[n] = pBytes[n] & pMask[n];
+	}
+
+	m_nAnchor = 0;
+
+	while(m_nAnchor < m_vecMask.size() && !m_vecMask[m_nAnchor])
+	{
+		m_nAnchor++;
+	}
+
+	// Wildcards only would match everywhere.
+	if(m_nAnchor == m_vecMask.size())
+	{
+		m_vecBytes.clear();
+		m_vecMask.clear();
+
+		return false;
+	}
+
+	m_nCompanion = m_nAnchor;
+
+	UpdateHash();
+
+	return true;
+}
+
+bool GameData::Pattern::IsValid() const
+{
+	return !m_vecBytes.empty();
+}
+
+const uint8_t *GameData::Pattern::GetBytes() const
+{
+	return m_vecBytes.data();
+}
+
+const uint8_t *GameData::Pattern::GetMask() const
+{
+	return m_vecMask.data();
+}
+
+size_t GameData::Pattern::GetLength() const
+{
+	return m_vecBytes.size();
+}
+
+uint64_t GameData::Pattern::GetHash() const
+{
+	return m_nHash;
+}
+
+bool GameData::Pattern::SetAnchor(size_t nOffset, size_t nCompanion)
+{
+	size_t nLength = m_vecMask.size();
+
+	if(nOffset >= nLength || nCompanion >= nLength || !m_vecMask[nOffset] || !m_vecMask[nCompanion])
+	{
+		return false;
+	}
+
+	m_nAnchor = nOffset;
+	m_nCompanion = nCompanion;
+
+	return true;
+}
+
+size_t GameData::Pattern::GetAnchor() const
+{
+	return m_nAnchor;
+}
+
+size_t GameData::Pattern::GetCompanion() const
+{
+	return m_nCompanion;
+}
+
+bool GameData::Pattern::operator==(const Pattern &aOther) const
+{
+	return m_nHash == aOther.m_nHash && m_vecBytes == aOther.m_vecBytes && m_vecMask == aOther.m_vecMask;
+}
+
+bool GameData::Pattern::operator!=(const Pattern &aOther) const
+{
+	return !(*this == aOther);
+}
+
+std::string GameData::Pattern::ToString() const
+{
+	std::string sResult;
+
+	sResult.reserve(m_vecBytes.size() * 3);
+
+	for(size_t n = 0, nLength = m_vecBytes.size(); n < nLength; n++)
+	{
+		if(n)
+		{
+			sResult += ' ';
+		}
+
+		if(m_vecMask[n])
+		{
+			char szByte[3];
+
+			snprintf(szByte, sizeof(szByte), "%02X", m_vecBytes[n]);
+			sResult += szByte;
+		}
+		else
+		{
+			sResult += '?';
+		}
+	}
+
+	return sResult;
+}
+
+bool GameData::Pattern::Match(const uint8_t *pData) const
+{
+	const uint8_t *pBytes = m_vecBytes.data(),
+	              *pMask = m_vecMask.data();
+
+	for(size_t n = 0, nLength = m_vecBytes.size(); n < nLength; n++)
+	{
+		if((pData[n] & pMask[n]) != pBytes[n])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const uint8_t *GameData::Pattern::Find(const uint8_t *pBegin, const uint8_t *pEnd) const
+{
+	size_t nLength = m_vecBytes.size();
+
+	if(!nLength || pEnd < pBegin || static_cast<size_t>(pEnd - pBegin) < nLength)
+	{
+		return nullptr;
+	}
+
+	const uint8_t nAnchorByte = m_vecBytes[m_nAnchor],
+	              nCompanionByte = m_vecBytes[m_nCompanion];
+
+	// Relative to the anchor; 0 checks the anchor twice when there is no companion.
+	const ptrdiff_t nCompanionDelta = static_cast<ptrdiff_t>(m_nCompanion) - static_cast<ptrdiff_t>(m_nAnchor);
+
+	// Anchor positions, shifted so that a hit is a pattern start.
+	const uint8_t *pCur = pBegin + m_nAnchor,
+	              *pLast = pEnd - nLength + m_nAnchor;
+
+	while(pCur <= pLast)
+	{
+		pCur = reinterpret_cast<const uint8_t *>(memchr(pCur, nAnchorByte, pLast - pCur + 1));
+
+		if(!pCur)
+		{
+			break;
+		}
+
+		if(pCur[nCompanionDelta] == nCompanionByte && Match(pCur - m_nAnchor))
+		{
+			return pCur - m_nAnchor;
+		}
+
+		pCur++;
+	}
+
+	return nullptr;
+}
+
+const uint8_t *GameData::Pattern::FindBackward(const uint8_t *pBegin, const uint8_t *pEnd) const
+{
+	size_t nLength = m_vecBytes.size();
+
+	if(!nLength || pEnd < pBegin || static_cast<size_t>(pEnd - pBegin) < nLength)
+	{
+		return nullptr;
+	}
+
+	const uint8_t nAnchorByte = m_vecBytes[m_nAnchor],
+	              nCompanionByte = m_vecBytes[m_nCompanion];
+
+	for(const uint8_t *pCur = pEnd - nLength; ; pCur--)
+	{
+		if(pCur[m_nAnchor] == nAnchorByte && pCur[m_nCompanion] == nCompanionByte && Match(pCur))
+		{
+			return pCur;
+		}
+
+		if(pCur == pBegin)
+		{
+			break;
+		}
+	}
+
+	return nullptr;
+}
+
+bool GameData::Pattern::Find(const ModuleImage &aImage, uintptr_t &nRVA) const
+{
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(!it.IsCode() || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			continue;
+		}
+
+		const uint8_t *pBegin = aImage.GetPointer(it.m_nRVA);
+
+		const uint8_t *pFound = Find(pBegin, pBegin + it.m_nSize);
+
+		if(pFound)
+		{
+			nRVA = it.m_nRVA + (pFound - pBegin);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t GameData::Pattern::GetLiteralCount() const
+{
+	return static_cast<size_t>(std::count(m_vecMask.begin(), m_vecMask.end(), 0xFF));
+}
+
+size_t GameData::Pattern::Distance(const uint8_t *pData, size_t nLimit) const
+{
+	size_t nDistance = 0;
+
+	for(size_t n = 0, nLength = m_vecBytes.size(); n < nLength && nDistance <= nLimit; n++)
+	{
+		nDistance += (pData[n] & m_vecMask[n]) != m_vecBytes[n];
+	}
+
+	return nDistance;
+}
+
+bool GameData::Pattern::FindApproximate(const ModuleImage &aImage, size_t nMaxDistance, Approximate_t &aResult) const
+{
+	aResult = {};
+
+	size_t nLength = m_vecBytes.size(),
+	       nLiterals = GetLiteralCount();
+
+	if(!nLiterals)
+	{
+		return false;
+	}
+
+	size_t nBest = std::min(nMaxDistance, (nLiterals - 1) / 2);
+
+	// 16-byte blocks, padded with wildcards.
+	size_t nBlocks = (nLength + 15) / 16;
+
+	std::vector<uint8_t> vecBytes(nBlocks * 16), vecMask(nBlocks * 16);
+
+	memcpy(vecBytes.data(), m_vecBytes.data(), nLength);
+	memcpy(vecMask.data(), m_vecMask.data(), nLength);
+
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(!it.IsCode() || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize) || it.m_nSize < nLength)
+		{
+			continue;
+		}
+
+		const uint8_t *pBegin = aImage.GetPointer(it.m_nRVA),
+		              *pLast = pBegin + it.m_nSize - nLength,
+		              *pCur = pBegin;
+
+		auto Consider = [&](const uint8_t *pData, size_t nDistance)
+		{
+			if(nDistance > nBest)
+			{
+				return;
+			}
+
+			if(aResult.m_bFound && nDistance == aResult.m_nDistance)
+			{
+				aResult.m_nCandidates++;
+
+				return;
+			}
+
+			aResult.m_bFound = true;
+			aResult.m_nRVA = it.m_nRVA + (pData - pBegin);
+			aResult.m_nDistance = nBest = nDistance;
+			aResult.m_nCandidates = 1;
+		};
+
+#if defined(GAMEDATA_PATTERN_SSE2)
+		// Whole blocks may read past the pattern, so the tail is left to the scalar loop.
+		const uint8_t *pVectorLast = pBegin + it.m_nSize - nBlocks * 16;
+
+		for(; pCur <= pVectorLast && pCur <= pLast; pCur++)
+		{
+			size_t nDistance = 0;
+
+			for(size_t nBlock = 0; nBlock < nBlocks && nDistance <= nBest; nBlock++)
+			{
+				__m128i aData = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pCur + nBlock * 16)),
+				        aBytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vecBytes.data() + nBlock * 16)),
+				        aMask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(vecMask.data() + nBlock * 16));
+
+				__m128i aEqual = _mm_cmpeq_epi8(_mm_and_si128(aData, aMask), aBytes);
+
+				nDistance += 16 - CountBits(static_cast<uint32_t>(_mm_movemask_epi8(aEqual)));
+			}
+
+			Consider(pCur, nDistance);
+		}
+#endif
+
+		for(; pCur <= pLast; pCur++)
+		{
+			Consider(pCur, Distance(pCur, nBest));
+		}
+	}
+
+	return aResult.m_bFound;
+}
+
+GameData::Pattern GameData::Pattern::WithBytes(const uint8_t *pData) const
+{
+	Pattern aResult;
+
+	aResult.m_vecMask = m_vecMask;
+	aResult.m_vecBytes.resize(m_vecBytes.size());
+
+	for(size_t n = 0, nLength = m_vecBytes.size(); n < nLength; n++)
+	{
+		aResult.m_vecBytes[n] = pData[n] & m_vecMask[n];
+	}
+
+	aResult.m_nAnchor = m_nAnchor;
+	aResult.m_nCompanion = m_nCompanion;
+	aResult.UpdateHash();
+
+	return aResult;
+}
+
+void GameData::Pattern::UpdateHash()
+{
+	Hash64 aHash;
+
+	aHash.Update(m_vecBytes.data(), m_vecBytes.size());
+	aHash.Update(m_vecMask.data(), m_vecMask.size());
+
+	m_nHash = aHash.Digest();
+}
@@ -0,0 +1,308 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/processgamedata.hpp>
+
+#include <limits.h>
+#include <link.h>
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+struct LoadedLibrary_t
+{
+	std::string m_sPath;
+	std::string m_sSOName;
+	uintptr_t m_pBase;
+};
+
+struct IterateContext_t
+{
+	unsigned long long m_nKnownAdds;
+	unsigned long long m_nKnownSubs;
+
+	unsigned long long m_nAdds;
+	unsigned long long m_nSubs;
+
+	bool m_bFirst;
+	bool m_bUnchanged;
+
+	std::vector<LoadedLibrary_t> m_vecLibraries;
+};
+
+static const char *GetSOName(const struct dl_phdr_info *pInfo)
+{
+	for(ElfW(Half) n = 0; n < pInfo->dlpi_phnum; n++)
+	{
+		const auto &aProgram = pInfo->dlpi_phdr[n];
+
+		if(aProgram.p_type != PT_DYNAMIC)
+		{
+			continue;
+		}
+
+		const auto *pDynamic = reinterpret_cast<const ElfW(Dyn) *>(pInfo->dlpi_addr + aProgram.p_vaddr);
+
+		uintptr_t pStrTab = 0;
+		uintptr_t nSOName = UINTPTR_MAX;
+
+		for(; pDynamic->d_tag != DT_NULL; pDynamic++)
+		{
+			if(pDynamic->d_tag == DT_STRTAB)
+			{
+				pStrTab = pDynamic->d_un.d_ptr;
+			}
+			else if(pDynamic->d_tag == DT_SONAME)
+			{
+				nSOName = pDynamic->d_un.d_val;
+			}
+		}
+
+		if(!pStrTab || nSOName == UINTPTR_MAX)
+		{
+			return nullptr;
+		}
+
+		// The loader relocates DT_STRTAB in place for regular objects, but not for the vDSO.
+		if(pStrTab < pInfo->dlpi_addr)
+		{
+			pStrTab += pInfo->dlpi_addr;
+		}
+
+		return reinterpret_cast<const char *>(pStrTab + nSOName);
+	}
+
+	return nullptr;
+}
+
+static int OnIteratePhdr(struct dl_phdr_info *pInfo, size_t nSize, void *pData)
+{
+	auto *pContext = reinterpret_cast<IterateContext_t *>(pData);
+
+	if(pContext->m_bFirst)
+	{
+		pContext->m_bFirst = false;
+
+		if(nSize >= offsetof(struct dl_phdr_info, dlpi_subs) + sizeof(pInfo->dlpi_subs))
+		{
+			pContext->m_nAdds = pInfo->dlpi_adds;
+			pContext->m_nSubs = pInfo->dlpi_subs;
+
+			if(pContext->m_nAdds == pContext->m_nKnownAdds && pContext->m_nSubs == pContext->m_nKnownSubs)
+			{
+				pContext->m_bUnchanged = true;
+
+				return 1;
+			}
+		}
+	}
+
+	// The main program has no name here.
+	if(!pInfo->dlpi_name || !pInfo->dlpi_name[0])
+	{
+		return 0;
+	}
+
+	const char *pszSOName = GetSOName(pInfo);
+
+	pContext->m_vecLibraries.push_back({pInfo->dlpi_name, pszSOName ? pszSOName : "", static_cast<uintptr_t>(pInfo->dlpi_addr)});
+
+	return 0;
+}
+
+GameData::ProcessGameData::ProcessGameData()
+ :  m_nLoaderAdds(ULLONG_MAX),
+    m_nLoaderSubs(ULLONG_MAX)
+{
+	Refresh();
+}
+
+const DynLibUtils::CModule *GameData::ProcessGameData::FindLibrary(const char *pszName) const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	auto itFound = m_mapNames.find(pszName);
+
+	if(itFound == m_mapNames.end())
+	{
+		if(!RefreshLocked())
+		{
+			return nullptr;
+		}
+
+		itFound = m_mapNames.find(pszName);
+
+		if(itFound == m_mapNames.end())
+		{
+			return nullptr;
+		}
+	}
+
+	Library_t *pLibrary = itFound->second;
+
+	if(!pLibrary->m_pModule)
+	{
+		auto pModule = std::make_unique<DynLibUtils::CModule>();
+
+		if(!pModule->InitFromMemory(DynLibUtils::CMemory(pLibrary->m_pBase)))
+		{
+			return nullptr;
+		}
+
+		pLibrary->m_pModule = std::move(pModule);
+	}
+
+	return pLibrary->m_pModule.get();
+}
+
+bool GameData::ProcessGameData::Refresh() const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	return RefreshLocked();
+}
+
+size_t GameData::ProcessGameData::GetLibraryCount() const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	return m_vecLibraries.size();
+}
+
+bool GameData::ProcessGameData::RefreshLocked() const
+{
+	IterateContext_t aContext {};
+
+	aContext.m_nKnownAdds = m_nLoaderAdds;
+	aContext.m_nKnownSubs = m_nLoaderSubs;
+	aContext.m_nAdds = ULLONG_MAX - 1;
+	aContext.m_nSubs = ULLONG_MAX - 1;
+	aContext.m_bFirst = true;
+
+	dl_iterate_phdr(OnIteratePhdr, &aContext);
+
+	if(aContext.m_bUnchanged)
+	{
+		return false;
+	}
+
+	// Something was unloaded: keep the survivors (and their CModule pointers), drop the rest.
+	if(aContext.m_nSubs != m_nLoaderSubs && !m_vecLibraries.empty())
+	{
+		std::unordered_map<uintptr_t, const std::string *> mapLoaded;
+
+		for(const auto &it : aContext.m_vecLibraries)
+		{
+			mapLoaded[it.m_pBase] = &it.m_sPath;
+		}
+
+		// A base may be reused by another library since the last refresh: match on the path too.
+		std::unordered_set<const Library_t *> setRemoved;
+
+		for(const auto &pLibrary : m_vecLibraries)
+		{
+			auto itLoaded = mapLoaded.find(pLibrary->m_pBase);
+
+			if(itLoaded == mapLoaded.end() || *itLoaded->second != pLibrary->m_sPath)
+			{
+				setRemoved.insert(pLibrary.get());
+			}
+		}
+
+		// Unlink the names and bases first, the libraries own what they point to.
+		for(auto it = m_mapNames.begin(); it != m_mapNames.end(); )
+		{
+			it = setRemoved.count(it->second) ? m_mapNames.erase(it) : std::next(it);
+		}
+
+		for(auto it = m_mapBases.begin(); it != m_mapBases.end(); )
+		{
+			it = setRemoved.count(it->second) ? m_mapBases.erase(it) : std::next(it);
+		}
+
+		for(const auto *pLibrary : setRemoved)
+		{
+			ForgetModuleImage(pLibrary->m_pBase);
+		}
+
+		m_vecLibraries.erase(std::remove_if(m_vecLibraries.begin(), m_vecLibraries.end(), [&setRemoved](const std::unique_ptr<Library_t> &pLibrary)
+		{
+			return setRemoved.count(pLibrary.get()) != 0;
+		}), m_vecLibraries.end());
+	}
+
+	for(const auto &it : aContext.m_vecLibraries)
+	{
+		auto itBase = m_mapBases.find(it.m_pBase);
+
+		if(itBase == m_mapBases.end() || itBase->second->m_sPath != it.m_sPath)
+		{
+			AddLibrary(it.m_sPath.c_str(), it.m_sSOName.c_str(), it.m_pBase);
+		}
+	}
+
+	m_nLoaderAdds = aContext.m_nAdds;
+	m_nLoaderSubs = aContext.m_nSubs;
+
+	return true;
+}
+
+void GameData::ProcessGameData::AddLibrary(const char *pszPath, const char *pszSOName, uintptr_t pBase) const
+{
+	auto pNewLibrary = std::make_unique<Library_t>();
+
+	pNewLibrary->m_sPath = pszPath;
+	pNewLibrary->m_pBase = pBase;
+
+	Library_t *pLibrary = pNewLibrary.get();
+
+	m_vecLibraries.push_back(std::move(pNewLibrary));
+	m_mapBases[pBase] = pLibrary;
+
+	const char *pszFileName = strrchr(pszPath, '/');
+
+	std::string sFileName = pszFileName ? pszFileName + 1 : pszPath;
+
+	AddName(pszPath, pLibrary);
+	AddName(sFileName, pLibrary);
+
+	if(pszSOName[0])
+	{
+		AddName(pszSOName, pLibrary);
+	}
+
+	// "libserver.so" -> "libserver" -> "server".
+	std::string sShortName = sFileName.substr(0, sFileName.find(".so"));
+
+	AddName(sShortName, pLibrary);
+
+	if(!sShortName.compare(0, 3, "lib") && sShortName.size() > 3)
+	{
+		AddName(sShortName.substr(3), pLibrary);
+	}
+}
+
+void GameData::ProcessGameData::AddName(const std::string &sName, Library_t *pLibrary) const
+{
+	// The first module loaded under a name keeps it, as the dynamic loader resolves it.
+	m_mapNames.emplace(sName, pLibrary);
+}
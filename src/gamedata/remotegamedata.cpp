@@ -0,0 +1,489 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/remotegamedata.hpp>
+
+#include "formats.hpp"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
+
+using namespace GameData::Formats;
+
+static char GetProcessState(pid_t iPID)
+{
+	char szPath[64];
+
+	snprintf(szPath, sizeof(szPath), "/proc/%d/stat", static_cast<int>(iPID));
+
+	FILE *pFile = fopen(szPath, "r");
+
+	if(!pFile)
+	{
+		return 0;
+	}
+
+	char szStat[512];
+
+	size_t nRead = fread(szStat, 1, sizeof(szStat) - 1, pFile);
+
+	fclose(pFile);
+
+	szStat[nRead] = '\0';
+
+	// "<pid> (<comm>) <state> ...", where comm may contain anything.
+	const char *pszState = strrchr(szStat, ')');
+
+	return pszState && pszState[1] == ' ' ? pszState[2] : 0;
+}
+
+class CTargetPause
+{
+public:
+	CTargetPause(pid_t iPID, bool bEnabled)
+	 :  m_iPID(iPID),
+	    m_bPaused(false)
+	{
+		// A target stopped by someone else stays as it is.
+		if(!bEnabled || GetProcessState(iPID) == 'T' || kill(iPID, SIGSTOP))
+		{
+			return;
+		}
+
+		m_bPaused = true;
+
+		auto tDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+
+		while(GetProcessState(iPID) != 'T' && std::chrono::steady_clock::now() < tDeadline)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	~CTargetPause()
+	{
+		if(m_bPaused)
+		{
+			kill(m_iPID, SIGCONT);
+		}
+	}
+
+private:
+	pid_t m_iPID;
+	bool m_bPaused;
+};
+
+bool GameData::RemoteModuleImage::Load(pid_t iPID, uintptr_t pRemoteBase, const std::vector<Region_t> &vecRegions, bool bPause, std::string &sError)
+{
+	Release();
+
+	// The headers first, to learn the extent of the module.
+	uint8_t aHeaders[4096];
+
+	if(!ReadRemote(iPID, aHeaders, {{0, pRemoteBase, sizeof(aHeaders)}}))
+	{
+		sError = "Failed to read the headers";
+
+		return false;
+	}
+
+	if(memcmp(aHeaders, ELF::s_aMagic, sizeof(ELF::s_aMagic)))
+	{
+		sError = "Not an ELF module";
+
+		return false;
+	}
+
+	const auto aHeader = Read<ELF::Ehdr_t>(aHeaders);
+
+	if(aHeader.e_ident[4] != ELF::CLASS_64 || aHeader.e_phentsize != sizeof(ELF::Phdr_t) ||
+	   aHeader.e_phoff + aHeader.e_phnum * sizeof(ELF::Phdr_t) > sizeof(aHeaders))
+	{
+		sError = "Unsupported ELF layout";
+
+		return false;
+	}
+
+	uintptr_t nMinAddress = UINTPTR_MAX,
+	          nMaxAddress = 0;
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(aHeaders + aHeader.e_phoff + n * sizeof(ELF::Phdr_t));
+
+		if(aProgram.p_type == ELF::PT_LOAD)
+		{
+			nMinAddress = std::min<uintptr_t>(nMinAddress, aProgram.p_vaddr & ~static_cast<uint64_t>(0xFFF));
+			nMaxAddress = std::max<uintptr_t>(nMaxAddress, aProgram.p_vaddr + aProgram.p_memsz);
+		}
+	}
+
+	if(nMaxAddress <= nMinAddress || !Allocate(nMaxAddress - nMinAddress))
+	{
+		sError = "Failed to allocate the image";
+
+		return false;
+	}
+
+	uintptr_t pRemoteEnd = pRemoteBase + m_nMemorySize;
+
+	std::vector<Read_t> vecReads;
+
+	for(const auto &it : vecRegions)
+	{
+		uintptr_t pStart = std::max(it.m_pStart, pRemoteBase),
+		          pEnd = std::min(it.m_pEnd, pRemoteEnd);
+
+		if(pStart < pEnd)
+		{
+			vecReads.push_back({pStart - pRemoteBase, pStart, pEnd - pStart});
+		}
+	}
+
+	bool bRead;
+
+	{
+		CTargetPause aPause(iPID, bPause);
+
+		bRead = ReadRemote(iPID, m_pMemory, vecReads);
+	}
+
+	if(!bRead)
+	{
+		sError = "Failed to read the module";
+		Release();
+
+		return false;
+	}
+
+	RelocateELF(pRemoteBase - nMinAddress);
+
+	if(!Init(m_pMemory, m_nMemorySize, false))
+	{
+		sError = "Failed to parse the copy";
+		Release();
+
+		return false;
+	}
+
+	m_nRuntimeBase = pRemoteBase;
+
+	return true;
+}
+
+bool GameData::RemoteModuleImage::ReadRemote(pid_t iPID, uint8_t *pLocal, const std::vector<Read_t> &vecReads)
+{
+	std::vector<struct iovec> vecLocal, vecRemote;
+
+	bool bComplete = true;
+
+	for(size_t nFirst = 0; nFirst < vecReads.size() && bComplete; nFirst += IOV_MAX)
+	{
+		size_t nLast = std::min<size_t>(nFirst + IOV_MAX, vecReads.size()),
+		       nExpected = 0;
+
+		vecLocal.clear();
+		vecRemote.clear();
+
+		for(size_t n = nFirst; n < nLast; n++)
+		{
+			const auto &it = vecReads[n];
+
+			vecLocal.push_back({pLocal + it.m_nOffset, it.m_nLength});
+			vecRemote.push_back({reinterpret_cast<void *>(it.m_pRemote), it.m_nLength});
+
+			nExpected += it.m_nLength;
+		}
+
+		ssize_t nRead = process_vm_readv(iPID, vecLocal.data(), vecLocal.size(), vecRemote.data(), vecRemote.size(), 0);
+
+		bComplete = nRead >= 0 && static_cast<size_t>(nRead) == nExpected;
+	}
+
+	if(bComplete)
+	{
+		return true;
+	}
+
+	// Seccomp or an old kernel may refuse the syscall; the mem file reads the same pages.
+	char szPath[64];
+
+	snprintf(szPath, sizeof(szPath), "/proc/%d/mem", static_cast<int>(iPID));
+
+	int iFile = open(szPath, O_RDONLY | O_CLOEXEC);
+
+	if(iFile < 0)
+	{
+		return false;
+	}
+
+	bComplete = true;
+
+	for(const auto &it : vecReads)
+	{
+		size_t nDone = 0;
+
+		while(nDone < it.m_nLength)
+		{
+			ssize_t nRead = pread(iFile, pLocal + it.m_nOffset + nDone, it.m_nLength - nDone, static_cast<off_t>(it.m_pRemote + nDone));
+
+			if(nRead <= 0)
+			{
+				bComplete = false;
+
+				break;
+			}
+
+			nDone += static_cast<size_t>(nRead);
+		}
+	}
+
+	close(iFile);
+
+	return bComplete;
+}
+
+GameData::RemoteGameData::RemoteGameData(pid_t iPID)
+ :  m_iPID(iPID),
+    m_bPauseTarget(false)
+{
+	Refresh();
+}
+
+const DynLibUtils::CModule *GameData::RemoteGameData::FindLibrary(const char *pszName) const
+{
+	return nullptr;
+}
+
+const GameData::ModuleImage *GameData::RemoteGameData::FindLibraryImage(const char *pszName) const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	auto itFound = m_mapNames.find(pszName);
+
+	if(itFound == m_mapNames.end())
+	{
+		RefreshLocked();
+
+		itFound = m_mapNames.find(pszName);
+
+		if(itFound == m_mapNames.end())
+		{
+			return nullptr;
+		}
+	}
+
+	Library_t *pLibrary = itFound->second;
+
+	if(!pLibrary->m_bLoaded)
+	{
+		pLibrary->m_bLoaded = true;
+
+		auto pImage = std::make_unique<RemoteModuleImage>();
+
+		std::string sError;
+
+		if(pImage->Load(m_iPID, pLibrary->m_pBase, m_vecRegions, m_bPauseTarget, sError))
+		{
+			pLibrary->m_pImage = std::move(pImage);
+		}
+		else
+		{
+			m_sLastError = sError + " of \"" + pLibrary->m_sPath + "\"";
+		}
+	}
+
+	return pLibrary->m_pImage.get();
+}
+
+void GameData::RemoteGameData::SetPauseTarget(bool bValue)
+{
+	m_bPauseTarget = bValue;
+}
+
+pid_t GameData::RemoteGameData::GetPID() const
+{
+	return m_iPID;
+}
+
+bool GameData::RemoteGameData::Refresh() const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	return RefreshLocked();
+}
+
+std::string GameData::RemoteGameData::GetLastError() const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxLibraries);
+
+	return m_sLastError;
+}
+
+bool GameData::RemoteGameData::RefreshLocked() const
+{
+	char szPath[64];
+
+	snprintf(szPath, sizeof(szPath), "/proc/%d/maps", static_cast<int>(m_iPID));
+
+	FILE *pFile = fopen(szPath, "r");
+
+	if(!pFile)
+	{
+		m_sLastError = std::string("Failed to open \"") + szPath + "\"";
+
+		return false;
+	}
+
+	// Every file mapped by the target, in order of the maps, with its lowest offset 0 mapping.
+	std::vector<std::pair<std::string, uintptr_t>> vecMapped;
+	std::unordered_map<std::string, size_t> mapMappedByPath;
+
+	m_vecRegions.clear();
+
+	char szLine[PATH_MAX + 128];
+
+	while(fgets(szLine, sizeof(szLine), pFile))
+	{
+		unsigned long long nStart, nEnd, nOffset;
+
+		char szPerms[5];
+
+		int iPathStart = 0;
+
+		// "<start>-<end> <perms> <offset> <dev> <inode> <path>".
+		if(sscanf(szLine, "%llx-%llx %4s %llx %*s %*s %n", &nStart, &nEnd, szPerms, &nOffset, &iPathStart) < 4 || !iPathStart)
+		{
+			continue;
+		}
+
+		char *pszPath = szLine + iPathStart;
+
+		pszPath[strcspn(pszPath, "\n")] = '\0';
+
+		if(szPerms[0] == 'r')
+		{
+			m_vecRegions.push_back({static_cast<uintptr_t>(nStart), static_cast<uintptr_t>(nEnd)});
+		}
+
+		if(pszPath[0] != '/')
+		{
+			continue;
+		}
+
+		auto itMapped = mapMappedByPath.emplace(pszPath, vecMapped.size()).first;
+
+		if(itMapped->second == vecMapped.size())
+		{
+			vecMapped.emplace_back(pszPath, UINTPTR_MAX);
+		}
+
+		if(!nOffset)
+		{
+			auto &pBase = vecMapped[itMapped->second].second;
+
+			pBase = std::min<uintptr_t>(pBase, nStart);
+		}
+	}
+
+	fclose(pFile);
+
+	// Unloaded (or reloaded elsewhere) since the last refresh: the copy is of what is gone.
+	std::unordered_set<const Library_t *> setRemoved;
+
+	for(const auto &pLibrary : m_vecLibraries)
+	{
+		auto itMapped = mapMappedByPath.find(pLibrary->m_sPath);
+
+		if(itMapped == mapMappedByPath.end() || vecMapped[itMapped->second].second != pLibrary->m_pBase)
+		{
+			setRemoved.insert(pLibrary.get());
+		}
+		else
+		{
+			vecMapped[itMapped->second].second = UINTPTR_MAX; // Known.
+		}
+	}
+
+	if(!setRemoved.empty())
+	{
+		// Unlink the names first, the libraries own what they point to.
+		for(auto it = m_mapNames.begin(); it != m_mapNames.end(); )
+		{
+			it = setRemoved.count(it->second) ? m_mapNames.erase(it) : std::next(it);
+		}
+
+		m_vecLibraries.erase(std::remove_if(m_vecLibraries.begin(), m_vecLibraries.end(), [&setRemoved](const std::unique_ptr<Library_t> &pLibrary)
+		{
+			return setRemoved.count(pLibrary.get()) != 0;
+		}), m_vecLibraries.end());
+	}
+
+	for(const auto &it : vecMapped)
+	{
+		// Data files mapped by the target have no offset 0 mapping to be a base.
+		if(it.second == UINTPTR_MAX)
+		{
+			continue;
+		}
+
+		m_vecLibraries.push_back(std::make_unique<Library_t>());
+
+		Library_t *pLibrary = m_vecLibraries.back().get();
+
+		pLibrary->m_sPath = it.first;
+		pLibrary->m_pBase = it.second;
+
+		const std::string &sPath = pLibrary->m_sPath;
+
+		std::string sFileName = sPath.substr(sPath.rfind('/') + 1);
+
+		AddName(sPath, pLibrary);
+		AddName(sFileName, pLibrary);
+
+		// "libserver.so" -> "libserver" -> "server".
+		std::string sShortName = sFileName.substr(0, sFileName.find(".so"));
+
+		AddName(sShortName, pLibrary);
+
+		if(!sShortName.compare(0, 3, "lib") && sShortName.size() > 3)
+		{
+			AddName(sShortName.substr(3), pLibrary);
+		}
+	}
+
+	return true;
+}
+
+void GameData::RemoteGameData::AddName(const std::string &sName, Library_t *pLibrary) const
+{
+	m_mapNames.emplace(sName, pLibrary);
+}
@@ -0,0 +1,140 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/scanbroker.hpp>
+#include <gamedata/ngramindex.hpp>
+
+#include <atomic>
+
+static GameData::ScanBroker s_aScanBroker;
+static std::atomic<GameData::ScanBroker *> s_pScanBroker {&s_aScanBroker};
+
+GameData::ScanBroker::Result_t GameData::ScanBroker::Scan(const ModuleImage *pImage, const Pattern &aPattern)
+{
+	if(!pImage || !aPattern.IsValid())
+	{
+		return {};
+	}
+
+	const Fingerprint &aModule = GetModuleFingerprint(pImage);
+
+	// Nothing to tell the module apart by: scanned every time.
+	if(!aModule.IsValid())
+	{
+		Result_t aResult;
+
+		aResult.m_bFound = aPattern.Find(*pImage, aResult.m_nRVA);
+
+		std::lock_guard<std::mutex> aLock(m_mtxResults);
+
+		m_aStatistics.m_nRequests++;
+		m_aStatistics.m_nScans++;
+
+		return aResult;
+	}
+
+	std::promise<Result_t> aPromise;
+	std::shared_future<Result_t> aFuture;
+
+	bool bOwner = false;
+
+	{
+		std::lock_guard<std::mutex> aLock(m_mtxResults);
+
+		m_aStatistics.m_nRequests++;
+
+		Key_t aKey {aModule, pImage->GetSize(), aPattern};
+
+		auto itFound = m_mapResults.find(aKey);
+
+		if(itFound != m_mapResults.end())
+		{
+			aFuture = itFound->second;
+		}
+		else
+		{
+			aFuture = aPromise.get_future().share();
+			m_mapResults.emplace(std::move(aKey), aFuture);
+			m_aStatistics.m_nScans++;
+
+			bOwner = true;
+		}
+	}
+
+	// Scan outside the lock; identical requests block on the future meanwhile.
+	if(bOwner)
+	{
+		Result_t aResult;
+
+		const NGramIndex *pIndex = m_bIndexed ? &pImage->GetIndex<NGramIndex>() : nullptr;
+
+		if(pIndex && pIndex->CanFind(aPattern))
+		{
+			aResult.m_bFound = pIndex->Find(aPattern, aResult.m_nRVA);
+
+			std::lock_guard<std::mutex> aLock(m_mtxResults);
+
+			m_aStatistics.m_nIndexed++;
+		}
+		else
+		{
+			aResult.m_bFound = aPattern.Find(*pImage, aResult.m_nRVA);
+		}
+
+		aPromise.set_value(aResult);
+	}
+
+	return aFuture.get();
+}
+
+void GameData::ScanBroker::Purge()
+{
+	std::lock_guard<std::mutex> aLock(m_mtxResults);
+
+	m_mapResults.clear();
+}
+
+GameData::ScanBroker::Statistics_t GameData::ScanBroker::GetStatistics() const
+{
+	std::lock_guard<std::mutex> aLock(m_mtxResults);
+
+	return m_aStatistics;
+}
+
+void GameData::ScanBroker::SetIndexed(bool bValue)
+{
+	m_bIndexed = bValue;
+}
+
+bool GameData::ScanBroker::IsIndexed() const
+{
+	return m_bIndexed;
+}
+
+GameData::ScanBroker *GameData::GetScanBroker()
+{
+	return s_pScanBroker.load();
+}
+
+void GameData::SetScanBroker(ScanBroker *pBroker)
+{
+	s_pScanBroker.store(pBroker ? pBroker : &s_aScanBroker);
+}
@@ -0,0 +1,104 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/schemaindex.hpp>
+
+#include <string.h>
+
+#define MAX_SCHEMA_INHERITANCE_DEPTH 64
+
+void GameData::SchemaIndex::AddClass(const char *pszName, const char *pszParent)
+{
+	if(pszParent && *pszParent)
+	{
+		m_mapParents[pszName] = pszParent;
+	}
+}
+
+void GameData::SchemaIndex::AddField(const char *pszClass, const char *pszField, ptrdiff_t nOffset)
+{
+	std::string sName(pszClass);
+
+	sName.append("::").append(pszField);
+	m_mapFields[std::move(sName)] = nOffset;
+}
+
+void GameData::SchemaIndex::Clear()
+{
+	m_mapFields.clear();
+	m_mapParents.clear();
+}
+
+size_t GameData::SchemaIndex::GetCount() const
+{
+	return m_mapFields.size();
+}
+
+bool GameData::SchemaIndex::Find(const char *pszName, ptrdiff_t &nOffset) const
+{
+	auto it = m_mapFields.find(pszName);
+
+	if(it != m_mapFields.end())
+	{
+		nOffset = it->second;
+
+		return true;
+	}
+
+	// Nested class names have "::" of their own: the field is after the last one.
+	const char *pszSeparator = nullptr;
+
+	for(const char *psz = strstr(pszName, "::"); psz; psz = strstr(psz + 2, "::"))
+	{
+		pszSeparator = psz;
+	}
+
+	if(!pszSeparator)
+	{
+		return false;
+	}
+
+	std::string sClass(pszName, pszSeparator - pszName),
+	            sName;
+
+	for(int iDepth = 0; iDepth < MAX_SCHEMA_INHERITANCE_DEPTH; iDepth++)
+	{
+		auto itParent = m_mapParents.find(sClass);
+
+		if(itParent == m_mapParents.end())
+		{
+			break;
+		}
+
+		sClass = itParent->second;
+		sName.assign(sClass).append(pszSeparator);
+		it = m_mapFields.find(sName);
+
+		if(it != m_mapFields.end())
+		{
+			nOffset = it->second;
+
+			return true;
+		}
+	}
+
+	return false;
+}
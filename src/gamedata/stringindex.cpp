@@ -0,0 +1,144 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/stringindex.hpp>
+#include <gamedata/hash.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+static bool IsTextByte(uint8_t nByte)
+{
+	return nByte >= 0x20 || nByte == '\t' || nByte == '\n' || nByte == '\r';
+}
+
+static bool IsStringSegment(const GameData::ModuleImage &aImage, const GameData::ModuleImage::Segment_t &aSegment)
+{
+	return !aSegment.IsCode() && aSegment.IsReadOnly() && aSegment.m_nSize && aImage.ContainsRVA(aSegment.m_nRVA, aSegment.m_nSize);
+}
+
+GameData::StringIndex::StringIndex(const ModuleImage &aImage)
+ :  m_aImage(aImage)
+{
+	if(aImage.GetSize() > UINT32_MAX)
+	{
+		return;
+	}
+
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(!IsStringSegment(aImage, it))
+		{
+			continue;
+		}
+
+		const uint8_t *pBegin = aImage.GetPointer(it.m_nRVA),
+		              *pEnd = pBegin + it.m_nSize;
+
+		for(const uint8_t *pCur = pBegin; pCur < pEnd; )
+		{
+			const uint8_t *pNull = reinterpret_cast<const uint8_t *>(memchr(pCur, 0, pEnd - pCur));
+
+			if(!pNull)
+			{
+				break;
+			}
+
+			// Binary data between strings is skipped, so the index holds text only.
+			if(pNull != pCur && std::all_of(pCur, pNull, IsTextByte))
+			{
+				m_vecEntries.push_back({Hash64::Compute(pCur, pNull - pCur), static_cast<uint32_t>(it.m_nRVA + (pCur - pBegin))});
+			}
+
+			pCur = pNull + 1;
+		}
+	}
+
+	std::sort(m_vecEntries.begin(), m_vecEntries.end());
+}
+
+size_t GameData::StringIndex::GetCount() const
+{
+	return m_vecEntries.size();
+}
+
+void GameData::StringIndex::Find(const char *pszText, std::vector<uintptr_t> &vecRVAs) const
+{
+	vecRVAs.clear();
+
+	size_t nLength = strlen(pszText);
+
+	if(!nLength)
+	{
+		return;
+	}
+
+	uint64_t nHash = Hash64::Compute(pszText, nLength);
+
+	auto it = std::lower_bound(m_vecEntries.begin(), m_vecEntries.end(), Entry_t {nHash, 0});
+
+	for(; it != m_vecEntries.end() && it->m_nHash == nHash; ++it)
+	{
+		if(m_aImage.ContainsRVA(it->m_nRVA, nLength + 1) && !memcmp(m_aImage.GetPointer(it->m_nRVA), pszText, nLength + 1))
+		{
+			vecRVAs.push_back(it->m_nRVA);
+		}
+	}
+
+	if(vecRVAs.empty())
+	{
+		FindMerged(pszText, nLength, vecRVAs);
+	}
+}
+
+void GameData::StringIndex::FindMerged(const char *pszText, size_t nLength, std::vector<uintptr_t> &vecRVAs) const
+{
+	// The terminator is part of the needle: a merged string is the tail of a longer one.
+	std::string sNeedle(pszText, nLength + 1);
+
+	std::boyer_moore_horspool_searcher<std::string::const_iterator> aSearcher(sNeedle.begin(), sNeedle.end());
+
+	for(const auto &it : m_aImage.GetSegments())
+	{
+		if(!IsStringSegment(m_aImage, it))
+		{
+			continue;
+		}
+
+		const char *pBegin = m_aImage.GetPointer<char>(it.m_nRVA),
+		           *pEnd = pBegin + it.m_nSize;
+
+		for(const char *pCur = pBegin; ; pCur++)
+		{
+			pCur = std::search(pCur, pEnd, aSearcher);
+
+			if(pCur == pEnd)
+			{
+				break;
+			}
+
+			vecRVAs.push_back(it.m_nRVA + (pCur - pBegin));
+		}
+	}
+}
@@ -0,0 +1,442 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/suffixindex.hpp>
+#include <gamedata/instruction.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+
+// SA-IS (Nong, Zhang & Chan): sorts the LMS substrings by induction, names them,
+// recurses on the names when they are not unique, then induces the full order.
+template<typename T>
+static void BuildSuffixArray(const T *pText, int32_t nLength, int32_t nUpper, int32_t *pSuffixes)
+{
+	if(nLength <= 2)
+	{
+		for(int32_t n = 0; n < nLength; n++)
+		{
+			pSuffixes[n] = n;
+		}
+
+		if(nLength == 2 && pText[1] < pText[0])
+		{
+			std::swap(pSuffixes[0], pSuffixes[1]);
+		}
+
+		return;
+	}
+
+	std::vector<bool> vecSType(nLength);
+
+	for(int32_t n = nLength - 2; n >= 0; n--)
+	{
+		vecSType[n] = pText[n] == pText[n + 1] ? vecSType[n + 1] : pText[n] < pText[n + 1];
+	}
+
+	// Bucket starts: L-type suffixes fill a bucket from its start, S-type ones follow them.
+	std::vector<int32_t> vecSumL(nUpper + 2), vecSumS(nUpper + 2);
+
+	for(int32_t n = 0; n < nLength; n++)
+	{
+		if(!vecSType[n])
+		{
+			vecSumS[pText[n]]++;
+		}
+		else
+		{
+			vecSumL[pText[n] + 1]++;
+		}
+	}
+
+	for(int32_t n = 0; n <= nUpper; n++)
+	{
+		vecSumS[n] += vecSumL[n];
+		vecSumL[n + 1] += vecSumS[n];
+	}
+
+	std::vector<int32_t> vecBuckets(nUpper + 2);
+
+	auto Induce = [&](const std::vector<int32_t> &vecLMS)
+	{
+		std::fill(pSuffixes, pSuffixes + nLength, -1);
+		std::copy(vecSumS.begin(), vecSumS.end(), vecBuckets.begin());
+
+		for(int32_t nLMS : vecLMS)
+		{
+			pSuffixes[vecBuckets[pText[nLMS]]++] = nLMS;
+		}
+
+		std::copy(vecSumL.begin(), vecSumL.end(), vecBuckets.begin());
+		pSuffixes[vecBuckets[pText[nLength - 1]]++] = nLength - 1;
+
+		for(int32_t n = 0; n < nLength; n++)
+		{
+			int32_t nSuffix = pSuffixes[n];
+
+			if(nSuffix >= 1 && !vecSType[nSuffix - 1])
+			{
+				pSuffixes[vecBuckets[pText[nSuffix - 1]]++] = nSuffix - 1;
+			}
+		}
+
+		std::copy(vecSumL.begin(), vecSumL.end(), vecBuckets.begin());
+
+		for(int32_t n = nLength - 1; n >= 0; n--)
+		{
+			int32_t nSuffix = pSuffixes[n];
+
+			if(nSuffix >= 1 && vecSType[nSuffix - 1])
+			{
+				pSuffixes[--vecBuckets[pText[nSuffix - 1] + 1]] = nSuffix - 1;
+			}
+		}
+	};
+
+	std::vector<int32_t> vecLMSIndex(nLength + 1, -1), vecLMS;
+
+	for(int32_t n = 1; n < nLength; n++)
+	{
+		if(!vecSType[n - 1] && vecSType[n])
+		{
+			vecLMSIndex[n] = static_cast<int32_t>(vecLMS.size());
+			vecLMS.push_back(n);
+		}
+	}
+
+	Induce(vecLMS);
+
+	int32_t nLMSCount = static_cast<int32_t>(vecLMS.size());
+
+	if(!nLMSCount)
+	{
+		return;
+	}
+
+	std::vector<int32_t> vecSortedLMS;
+
+	vecSortedLMS.reserve(nLMSCount);
+
+	for(int32_t n = 0; n < nLength; n++)
+	{
+		if(vecLMSIndex[pSuffixes[n]] != -1)
+		{
+			vecSortedLMS.push_back(pSuffixes[n]);
+		}
+	}
+
+	std::vector<int32_t> vecNames(nLMSCount);
+
+	int32_t nNameUpper = 0;
+
+	vecNames[vecLMSIndex[vecSortedLMS[0]]] = 0;
+
+	for(int32_t n = 1; n < nLMSCount; n++)
+	{
+		int32_t nLeft = vecSortedLMS[n - 1],
+		        nRight = vecSortedLMS[n];
+
+		int32_t nLeftEnd = vecLMSIndex[nLeft] + 1 < nLMSCount ? vecLMS[vecLMSIndex[nLeft] + 1] : nLength,
+		        nRightEnd = vecLMSIndex[nRight] + 1 < nLMSCount ? vecLMS[vecLMSIndex[nRight] + 1] : nLength;
+
+		bool bSame = nLeftEnd - nLeft == nRightEnd - nRight;
+
+		if(bSame)
+		{
+			while(nLeft < nLeftEnd && pText[nLeft] == pText[nRight])
+			{
+				nLeft++;
+				nRight++;
+			}
+
+			bSame = nLeft != nLength && pText[nLeft] == pText[nRight];
+		}
+
+		if(!bSame)
+		{
+			nNameUpper++;
+		}
+
+		vecNames[vecLMSIndex[vecSortedLMS[n]]] = nNameUpper;
+	}
+
+	std::vector<int32_t> vecNameSuffixes(nLMSCount);
+
+	BuildSuffixArray(vecNames.data(), nLMSCount, nNameUpper, vecNameSuffixes.data());
+
+	for(int32_t n = 0; n < nLMSCount; n++)
+	{
+		vecSortedLMS[n] = vecLMS[vecNameSuffixes[n]];
+	}
+
+	Induce(vecSortedLMS);
+}
+
+// Operand bytes which move between builds: displacements of branches, RIP-relative and
+// absolute memory operands, and immediates wide enough to be addresses.
+static void MaskInstruction(const GameData::Instruction_t &aInstruction, uint8_t *pMask)
+{
+	bool bAbsolute = aInstruction.m_nDisplacementSize == 4 && !(aInstruction.m_nModRM >> 6);
+
+	if(bAbsolute || (aInstruction.m_nFlags & GameData::INSTRUCTION_RIP_RELATIVE))
+	{
+		memset(pMask + aInstruction.m_nDisplacementOffset, 0x00, aInstruction.m_nDisplacementSize);
+	}
+
+	if((aInstruction.m_nFlags & GameData::INSTRUCTION_RELATIVE) || aInstruction.m_nImmediateSize >= 4)
+	{
+		memset(pMask + aInstruction.m_nImmediateOffset, 0x00, aInstruction.m_nImmediateSize);
+	}
+}
+
+GameData::SuffixIndex::SuffixIndex(const ModuleImage &aImage)
+{
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(!it.IsCode() || !it.m_nSize || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			continue;
+		}
+
+		m_vecRanges.push_back({it.m_nRVA, m_vecText.size(), it.m_nSize});
+
+		const uint8_t *pBegin = aImage.GetPointer(it.m_nRVA);
+
+		m_vecText.insert(m_vecText.end(), pBegin, pBegin + it.m_nSize);
+	}
+
+	if(m_vecText.size() >= static_cast<size_t>(INT32_MAX))
+	{
+		m_vecRanges.clear();
+		m_vecText.clear();
+
+		return;
+	}
+
+	m_vecSuffixes.resize(m_vecText.size());
+
+	BuildSuffixArray(m_vecText.data(), static_cast<int32_t>(m_vecText.size()), 0xFF, m_vecSuffixes.data());
+}
+
+size_t GameData::SuffixIndex::GetSize() const
+{
+	return m_vecText.size();
+}
+
+size_t GameData::SuffixIndex::Count(const Pattern &aPattern, size_t nLimit) const
+{
+	const uint8_t *pBytes = aPattern.GetBytes(),
+	              *pMask = aPattern.GetMask();
+
+	size_t nLength = aPattern.GetLength();
+
+	// The longest literal run is the most selective key.
+	size_t nKeyOffset = 0, nKeyLength = 0;
+
+	for(size_t n = 0; n < nLength; )
+	{
+		if(!pMask[n])
+		{
+			n++;
+
+			continue;
+		}
+
+		size_t nStart = n;
+
+		while(n < nLength && pMask[n])
+		{
+			n++;
+		}
+
+		if(n - nStart > nKeyLength)
+		{
+			nKeyOffset = nStart;
+			nKeyLength = n - nStart;
+		}
+	}
+
+	if(!nKeyLength)
+	{
+		return 0;
+	}
+
+	size_t nLower, nUpper;
+
+	Lookup(pBytes + nKeyOffset, nKeyLength, nLower, nUpper);
+
+	size_t nFound = 0;
+
+	for(size_t n = nLower; n < nUpper && nFound < nLimit; n++)
+	{
+		size_t nKey = static_cast<size_t>(m_vecSuffixes[n]);
+
+		if(nKey < nKeyOffset)
+		{
+			continue;
+		}
+
+		size_t nStart = nKey - nKeyOffset;
+
+		const Range_t *pRange = FindRange(nStart);
+
+		if(!pRange || nStart + nLength > pRange->m_nOffset + pRange->m_nSize)
+		{
+			continue;
+		}
+
+		nFound += aPattern.Match(m_vecText.data() + nStart);
+	}
+
+	return nFound;
+}
+
+bool GameData::SuffixIndex::Generate(uintptr_t nRVA, size_t nMaxLength, Pattern &aResult) const
+{
+	const Range_t *pRange = nullptr;
+
+	for(const auto &it : m_vecRanges)
+	{
+		if(nRVA - it.m_nRVA < it.m_nSize)
+		{
+			pRange = &it;
+
+			break;
+		}
+	}
+
+	if(!pRange)
+	{
+		return false;
+	}
+
+	size_t nOffset = pRange->m_nOffset + (nRVA - pRange->m_nRVA),
+	       nAvailable = std::min(nMaxLength, pRange->m_nOffset + pRange->m_nSize - nOffset);
+
+	const uint8_t *pData = m_vecText.data() + nOffset;
+
+	std::vector<uint8_t> vecMask;
+
+	vecMask.reserve(nAvailable);
+
+	Pattern aCandidate;
+
+	bool bUnique = false;
+
+	// Whole instructions first: the first unique prefix bounds the search below.
+	while(!bUnique && vecMask.size() < nAvailable)
+	{
+		size_t nPosition = vecMask.size();
+
+		Instruction_t aInstruction;
+
+		if(DecodeInstruction(pData + nPosition, nAvailable - nPosition, aInstruction))
+		{
+			vecMask.resize(nPosition + aInstruction.m_nLength, 0xFF);
+			MaskInstruction(aInstruction, vecMask.data() + nPosition);
+		}
+		else
+		{
+			vecMask.push_back(0xFF);
+		}
+
+		bUnique = aCandidate.Assign(pData, vecMask.data(), vecMask.size()) && Count(aCandidate, 2) == 1;
+	}
+
+	if(!bUnique)
+	{
+		return false;
+	}
+
+	// Uniqueness only improves with length, so the shortest unique prefix is a binary search away.
+	size_t nShortest = vecMask.size(),
+	       nLow = 1;
+
+	while(nLow < nShortest)
+	{
+		size_t nMiddle = nLow + (nShortest - nLow) / 2;
+
+		if(aCandidate.Assign(pData, vecMask.data(), nMiddle) && Count(aCandidate, 2) == 1)
+		{
+			nShortest = nMiddle;
+		}
+		else
+		{
+			nLow = nMiddle + 1;
+		}
+	}
+
+	while(nShortest > 1 && !vecMask[nShortest - 1])
+	{
+		nShortest--;
+	}
+
+	return aResult.Assign(pData, vecMask.data(), nShortest);
+}
+
+const GameData::SuffixIndex::Range_t *GameData::SuffixIndex::FindRange(size_t nOffset) const
+{
+	auto it = std::upper_bound(m_vecRanges.begin(), m_vecRanges.end(), nOffset, [](size_t nValue, const Range_t &aRange)
+	{
+		return nValue < aRange.m_nOffset;
+	});
+
+	if(it == m_vecRanges.begin())
+	{
+		return nullptr;
+	}
+
+	--it;
+
+	return nOffset - it->m_nOffset < it->m_nSize ? &*it : nullptr;
+}
+
+void GameData::SuffixIndex::Lookup(const uint8_t *pBytes, size_t nLength, size_t &nLower, size_t &nUpper) const
+{
+	const uint8_t *pText = m_vecText.data();
+
+	size_t nTextLength = m_vecText.size();
+
+	// <0, 0 or >0 as the suffix orders before, starts with or after the key.
+	auto Compare = [&](int32_t nSuffix) -> int
+	{
+		size_t nRemaining = nTextLength - static_cast<size_t>(nSuffix);
+
+		int iResult = memcmp(pText + nSuffix, pBytes, std::min(nRemaining, nLength));
+
+		if(!iResult && nRemaining < nLength)
+		{
+			return -1;
+		}
+
+		return iResult;
+	};
+
+	auto itBegin = m_vecSuffixes.begin(),
+	     itEnd = m_vecSuffixes.end();
+
+	auto itLower = std::partition_point(itBegin, itEnd, [&](int32_t nSuffix) { return Compare(nSuffix) < 0; });
+	auto itUpper = std::partition_point(itLower, itEnd, [&](int32_t nSuffix) { return Compare(nSuffix) <= 0; });
+
+	nLower = static_cast<size_t>(itLower - itBegin);
+	nUpper = static_cast<size_t>(itUpper - itBegin);
+}
@@ -0,0 +1,465 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/symboltable.hpp>
+
+#include "formats.hpp"
+
+#include <string.h>
+
+using namespace GameData::Formats;
+
+GameData::SymbolTable::SymbolTable(const ModuleImage &aImage)
+ :  m_aImage(aImage),
+    m_nDynamic(0),
+    m_nDynamicSize(0),
+    m_nGNUHash(0),
+    m_nSysVHash(0),
+    m_nSymbols(0),
+    m_nStrings(0),
+    m_nStringsSize(0),
+    m_nVersions(0),
+    m_nExports(0),
+    m_nExportsSize(0)
+{
+	switch(aImage.GetFormat())
+	{
+		case IMAGE_FORMAT_ELF:
+		{
+			InitELF();
+
+			break;
+		}
+
+		case IMAGE_FORMAT_PE:
+		{
+			InitPE();
+
+			break;
+		}
+
+		default:
+		{
+			break;
+		}
+	}
+}
+
+bool GameData::SymbolTable::IsAvailable() const
+{
+	return (m_nSymbols && m_nStrings && (m_nGNUHash || m_nSysVHash)) || m_nExports;
+}
+
+bool GameData::SymbolTable::Find(const char *pszName, uintptr_t &nRVA) const
+{
+	if(m_nExports)
+	{
+		return FindExport(pszName, nRVA);
+	}
+
+	if(!m_nSymbols || !m_nStrings)
+	{
+		return false;
+	}
+
+	if(m_nGNUHash)
+	{
+		return FindGNU(pszName, nRVA);
+	}
+
+	return m_nSysVHash && FindSysV(pszName, nRVA);
+}
+
+void GameData::SymbolTable::InitELF()
+{
+	const auto &aImage = m_aImage;
+
+	if(!aImage.ContainsRVA(0, sizeof(ELF::Ehdr_t)))
+	{
+		return;
+	}
+
+	const auto aHeader = Read<ELF::Ehdr_t>(aImage.GetBase());
+
+	if(!aImage.ContainsRVA(aHeader.e_phoff, aHeader.e_phnum * sizeof(ELF::Phdr_t)))
+	{
+		return;
+	}
+
+	for(uint16_t n = 0; n < aHeader.e_phnum; n++)
+	{
+		const auto aProgram = Read<ELF::Phdr_t>(aImage.GetPointer(aHeader.e_phoff + n * sizeof(ELF::Phdr_t)));
+
+		if(aProgram.p_type == ELF::PT_DYNAMIC)
+		{
+			m_nDynamic = aProgram.p_vaddr - aImage.GetVirtualBase();
+			m_nDynamicSize = aProgram.p_memsz;
+		}
+	}
+
+	if(!m_nDynamicSize || !aImage.ContainsRVA(m_nDynamic, m_nDynamicSize))
+	{
+		m_nDynamicSize = 0;
+
+		return;
+	}
+
+	for(size_t nOffset = 0; nOffset + sizeof(ELF::Dyn_t) <= m_nDynamicSize; nOffset += sizeof(ELF::Dyn_t))
+	{
+		const auto aEntry = Read<ELF::Dyn_t>(aImage.GetPointer(m_nDynamic + nOffset));
+
+		if(aEntry.d_tag == ELF::DT_NULL)
+		{
+			break;
+		}
+
+		switch(aEntry.d_tag)
+		{
+			case ELF::DT_GNU_HASH:  m_nGNUHash = ToRVA(aEntry.d_val); break;
+			case ELF::DT_HASH:      m_nSysVHash = ToRVA(aEntry.d_val); break;
+			case ELF::DT_SYMTAB:    m_nSymbols = ToRVA(aEntry.d_val); break;
+			case ELF::DT_STRTAB:    m_nStrings = ToRVA(aEntry.d_val); break;
+			case ELF::DT_STRSZ:     m_nStringsSize = aEntry.d_val; break;
+			case ELF::DT_VERSYM:    m_nVersions = ToRVA(aEntry.d_val); break;
+			default:                break;
+		}
+	}
+
+	if(!aImage.ContainsRVA(m_nStrings, m_nStringsSize))
+	{
+		m_nStrings = 0;
+	}
+}
+
+void GameData::SymbolTable::InitPE()
+{
+	const auto &aImage = m_aImage;
+
+	if(!aImage.ContainsRVA(PE::DOS_LFANEW_OFFSET, sizeof(uint32_t)))
+	{
+		return;
+	}
+
+	uint32_t nNTOffset = Read<uint32_t>(aImage.GetPointer(PE::DOS_LFANEW_OFFSET));
+
+	uintptr_t nOptionalHeader = nNTOffset + sizeof(uint32_t) + sizeof(PE::FileHeader_t);
+
+	if(!aImage.ContainsRVA(nOptionalHeader, PE::OPTIONAL_DATA_DIRECTORY + sizeof(PE::DataDirectory_t)))
+	{
+		return;
+	}
+
+	if(!Read<uint32_t>(aImage.GetPointer(nOptionalHeader + PE::OPTIONAL_NUMBER_OF_RVA_AND_SIZES)))
+	{
+		return;
+	}
+
+	const auto aExports = Read<PE::DataDirectory_t>(aImage.GetPointer(nOptionalHeader + PE::OPTIONAL_DATA_DIRECTORY + PE::DIRECTORY_EXPORT * sizeof(PE::DataDirectory_t)));
+
+	if(aExports.Size >= sizeof(PE::ExportDirectory_t) && aImage.ContainsRVA(aExports.VirtualAddress, aExports.Size))
+	{
+		m_nExports = aExports.VirtualAddress;
+		m_nExportsSize = aExports.Size;
+	}
+}
+
+bool GameData::SymbolTable::FindDynamic(int64_t nTag, uint64_t &nValue) const
+{
+	for(size_t nOffset = 0; nOffset + sizeof(ELF::Dyn_t) <= m_nDynamicSize; nOffset += sizeof(ELF::Dyn_t))
+	{
+		const auto aEntry = Read<ELF::Dyn_t>(m_aImage.GetPointer(m_nDynamic + nOffset));
+
+		if(aEntry.d_tag == ELF::DT_NULL)
+		{
+			break;
+		}
+
+		if(aEntry.d_tag == nTag)
+		{
+			nValue = aEntry.d_val;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const char *GameData::SymbolTable::GetName(uint32_t nIndex) const
+{
+	const auto &aImage = m_aImage;
+
+	uintptr_t nSymbol = m_nSymbols + nIndex * sizeof(ELF::Sym_t);
+
+	if(!m_nSymbols || !m_nStrings || !aImage.ContainsRVA(nSymbol, sizeof(ELF::Sym_t)))
+	{
+		return nullptr;
+	}
+
+	uint32_t nName = Read<ELF::Sym_t>(aImage.GetPointer(nSymbol)).st_name;
+
+	if(nName >= m_nStringsSize)
+	{
+		return nullptr;
+	}
+
+	const char *pszName = aImage.GetPointer<char>(m_nStrings + nName);
+
+	return strnlen(pszName, m_nStringsSize - nName) < m_nStringsSize - nName ? pszName : nullptr;
+}
+
+bool GameData::SymbolTable::FindGNU(const char *pszName, uintptr_t &nRVA) const
+{
+	const auto &aImage = m_aImage;
+
+	// { nbuckets, symoffset, bloom_size, bloom_shift, uint64_t bloom[bloom_size], uint32_t buckets[nbuckets], uint32_t chain[] }
+	if(!aImage.ContainsRVA(m_nGNUHash, 4 * sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	const uint32_t *pHeader = aImage.GetPointer<uint32_t>(m_nGNUHash);
+
+	uint32_t nBuckets = pHeader[0],
+	         nSymbolOffset = pHeader[1],
+	         nBloomSize = pHeader[2],
+	         nBloomShift = pHeader[3];
+
+	uintptr_t nBloom = m_nGNUHash + 4 * sizeof(uint32_t),
+	          nBucketTable = nBloom + nBloomSize * sizeof(uint64_t),
+	          nChainTable = nBucketTable + nBuckets * sizeof(uint32_t);
+
+	if(!nBuckets || !nBloomSize || !aImage.ContainsRVA(nBloom, nChainTable - nBloom))
+	{
+		return false;
+	}
+
+	uint32_t nHash = 5381;
+
+	for(const char *psz = pszName; *psz; psz++)
+	{
+		nHash = nHash * 33 + static_cast<uint8_t>(*psz);
+	}
+
+	// Most absent names are turned away by the bloom filter alone.
+	uint64_t nWord = Read<uint64_t>(aImage.GetPointer(nBloom + ((nHash / 64) % nBloomSize) * sizeof(uint64_t))),
+	         nMask = (uint64_t(1) << (nHash % 64)) | (uint64_t(1) << ((nHash >> nBloomShift) % 64));
+
+	if((nWord & nMask) != nMask)
+	{
+		return false;
+	}
+
+	uint32_t nIndex = Read<uint32_t>(aImage.GetPointer(nBucketTable + (nHash % nBuckets) * sizeof(uint32_t)));
+
+	if(nIndex < nSymbolOffset)
+	{
+		return false;
+	}
+
+	for(; ; nIndex++)
+	{
+		uintptr_t nChain = nChainTable + (nIndex - nSymbolOffset) * sizeof(uint32_t);
+
+		if(!aImage.ContainsRVA(nChain, sizeof(uint32_t)))
+		{
+			return false;
+		}
+
+		uint32_t nChainHash = Read<uint32_t>(aImage.GetPointer(nChain));
+
+		if((nChainHash | 1) == (nHash | 1) && MatchSymbol(nIndex, pszName, nRVA))
+		{
+			return true;
+		}
+
+		// The lowest bit marks the end of the chain.
+		if(nChainHash & 1)
+		{
+			return false;
+		}
+	}
+}
+
+bool GameData::SymbolTable::FindSysV(const char *pszName, uintptr_t &nRVA) const
+{
+	const auto &aImage = m_aImage;
+
+	// { nbucket, nchain, uint32_t buckets[nbucket], uint32_t chain[nchain] }
+	if(!aImage.ContainsRVA(m_nSysVHash, 2 * sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	const uint32_t *pHeader = aImage.GetPointer<uint32_t>(m_nSysVHash);
+
+	uint32_t nBuckets = pHeader[0],
+	         nChains = pHeader[1];
+
+	if(!nBuckets || !aImage.ContainsRVA(m_nSysVHash, (2 + nBuckets + nChains) * sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	const uint32_t *pBuckets = pHeader + 2,
+	               *pChains = pBuckets + nBuckets;
+
+	uint32_t nHash = 0;
+
+	for(const char *psz = pszName; *psz; psz++)
+	{
+		nHash = (nHash << 4) + static_cast<uint8_t>(*psz);
+		nHash = (nHash ^ ((nHash & 0xF0000000) >> 24)) & 0x0FFFFFFF;
+	}
+
+	// The chain length bounds the walk, should the table be cyclic.
+	uint32_t nIndex = pBuckets[nHash % nBuckets];
+
+	for(uint32_t nSteps = 0; nIndex && nIndex < nChains && nSteps < nChains; nSteps++)
+	{
+		if(MatchSymbol(nIndex, pszName, nRVA))
+		{
+			return true;
+		}
+
+		nIndex = pChains[nIndex];
+	}
+
+	return false;
+}
+
+bool GameData::SymbolTable::FindExport(const char *pszName, uintptr_t &nRVA) const
+{
+	const auto &aImage = m_aImage;
+
+	const auto aDirectory = Read<PE::ExportDirectory_t>(aImage.GetPointer(m_nExports));
+
+	uint32_t nNames = aDirectory.NumberOfNames;
+
+	if(!aImage.ContainsRVA(aDirectory.AddressOfNames, nNames * sizeof(uint32_t)) ||
+	   !aImage.ContainsRVA(aDirectory.AddressOfNameOrdinals, nNames * sizeof(uint16_t)) ||
+	   !aImage.ContainsRVA(aDirectory.AddressOfFunctions, aDirectory.NumberOfFunctions * sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	const uint32_t *pNames = aImage.GetPointer<uint32_t>(aDirectory.AddressOfNames);
+
+	size_t nLength = strlen(pszName);
+
+	// The name table is sorted (by byte), which the loader relies on as well.
+	uint32_t nLow = 0,
+	         nHigh = nNames;
+
+	while(nLow < nHigh)
+	{
+		uint32_t nMiddle = nLow + (nHigh - nLow) / 2,
+		         nNameRVA = Read<uint32_t>(pNames + nMiddle);
+
+		if(!aImage.ContainsRVA(nNameRVA, 1))
+		{
+			return false;
+		}
+
+		const char *pszExport = aImage.GetPointer<char>(nNameRVA);
+
+		int iCompare = strncmp(pszExport, pszName, nLength + 1);
+
+		if(iCompare < 0)
+		{
+			nLow = nMiddle + 1;
+		}
+		else if(iCompare > 0)
+		{
+			nHigh = nMiddle;
+		}
+		else
+		{
+			uint16_t nOrdinal = Read<uint16_t>(aImage.GetPointer(aDirectory.AddressOfNameOrdinals + nMiddle * sizeof(uint16_t)));
+
+			if(nOrdinal >= aDirectory.NumberOfFunctions)
+			{
+				return false;
+			}
+
+			uint32_t nFunction = Read<uint32_t>(aImage.GetPointer(aDirectory.AddressOfFunctions + nOrdinal * sizeof(uint32_t)));
+
+			// Forwarders point back into the directory, at "module.name" of another module.
+			if(!nFunction || nFunction - m_nExports < m_nExportsSize)
+			{
+				return false;
+			}
+
+			nRVA = nFunction;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool GameData::SymbolTable::MatchSymbol(uint32_t nIndex, const char *pszName, uintptr_t &nRVA) const
+{
+	const auto &aImage = m_aImage;
+
+	uintptr_t nSymbol = m_nSymbols + nIndex * sizeof(ELF::Sym_t);
+
+	if(!aImage.ContainsRVA(nSymbol, sizeof(ELF::Sym_t)))
+	{
+		return false;
+	}
+
+	const auto aSymbol = Read<ELF::Sym_t>(aImage.GetPointer(nSymbol));
+
+	if(aSymbol.st_shndx == ELF::SHN_UNDEF || !aSymbol.st_value || aSymbol.st_name >= m_nStringsSize)
+	{
+		return false;
+	}
+
+	const char *pszSymbol = aImage.GetPointer<char>(m_nStrings + aSymbol.st_name);
+
+	size_t nLength = strlen(pszName);
+
+	if(nLength >= m_nStringsSize - aSymbol.st_name || memcmp(pszSymbol, pszName, nLength + 1))
+	{
+		return false;
+	}
+
+	// Older versions kept for compatibility are hidden; the default one is looked for.
+	if(m_nVersions && aImage.ContainsRVA(m_nVersions + nIndex * sizeof(uint16_t), sizeof(uint16_t)) &&
+	   Read<uint16_t>(aImage.GetPointer(m_nVersions + nIndex * sizeof(uint16_t))) & ELF::VERSYM_HIDDEN)
+	{
+		return false;
+	}
+
+	// Symbol values are link-time addresses, never relocated.
+	nRVA = aSymbol.st_value - aImage.GetVirtualBase();
+
+	return true;
+}
+
+uintptr_t GameData::SymbolTable::ToRVA(uint64_t nAddress) const
+{
+	const auto &aImage = m_aImage;
+
+	return aImage.Contains(static_cast<uintptr_t>(nAddress)) ? aImage.ToRVA(static_cast<uintptr_t>(nAddress)) : static_cast<uintptr_t>(nAddress - aImage.GetVirtualBase());
+}
@@ -0,0 +1,425 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/vtableindex.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+
+static bool IsIdentifierChar(char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_';
+}
+
+// <source-name> ::= <length> <identifier>, appended to sName.
+static bool DecodeSourceName(const char *&psz, std::string &sName)
+{
+	if(*psz < '1' || *psz > '9')
+	{
+		return false;
+	}
+
+	size_t nLength = 0;
+
+	for(; *psz >= '0' && *psz <= '9'; psz++)
+	{
+		nLength = nLength * 10 + (*psz - '0');
+
+		if(nLength > 1024)
+		{
+			return false;
+		}
+	}
+
+	if(strnlen(psz, nLength) != nLength || !std::all_of(psz, psz + nLength, IsIdentifierChar))
+	{
+		return false;
+	}
+
+	sName.append(psz, nLength);
+	psz += nLength;
+
+	return true;
+}
+
+// Itanium type names of classes: "11CBaseEntity", "N3Foo3BarE", "St9exception". Other
+// mangled names (templates, local classes) are kept as they are.
+static bool DecodeItaniumName(const char *pszMangled, std::string &sName)
+{
+	if(!*pszMangled || !std::all_of(pszMangled, pszMangled + strlen(pszMangled), IsIdentifierChar))
+	{
+		return false;
+	}
+
+	// The standard abbreviations which stand for a whole polymorphic class.
+	static const char *s_pszAbbreviations[][2] =
+	{
+		{"Si", "std::istream"},
+		{"So", "std::ostream"},
+		{"Sd", "std::iostream"},
+	};
+
+	for(const auto &it : s_pszAbbreviations)
+	{
+		if(!strcmp(pszMangled, it[0]))
+		{
+			sName = it[1];
+
+			return true;
+		}
+	}
+
+	const char *psz = pszMangled;
+
+	bool bNested = *psz == 'N';
+
+	if(bNested)
+	{
+		psz++;
+	}
+
+	if(psz[0] == 'S' && psz[1] == 't')
+	{
+		sName = "std::";
+		psz += 2;
+	}
+
+	bool bDecoded = DecodeSourceName(psz, sName);
+
+	while(bDecoded && bNested && *psz != 'E')
+	{
+		sName += "::";
+		bDecoded = DecodeSourceName(psz, sName);
+	}
+
+	if(bDecoded && bNested)
+	{
+		psz++;
+	}
+
+	if(!bDecoded || *psz)
+	{
+		size_t nLength = strlen(pszMangled);
+
+		// Still has to look like a type name (templates end with their argument list), or
+		// any string with a pointer to it would pass.
+		if(!strchr("123456789NSZ", pszMangled[0]) || pszMangled[nLength - 1] != 'E')
+		{
+			return false;
+		}
+
+		sName = pszMangled;
+	}
+
+	return true;
+}
+
+// MSVC type descriptor names of classes: ".?AVCBaseEntity@@", ".?AUBar@Foo@@" (innermost first).
+static bool DecodeMSVCName(const char *pszDecorated, std::string &sName)
+{
+	if(strncmp(pszDecorated, ".?AV", 4) && strncmp(pszDecorated, ".?AU", 4))
+	{
+		return false;
+	}
+
+	const char *psz = pszDecorated + 4;
+
+	size_t nLength = strlen(psz);
+
+	if(nLength < 3 || strcmp(psz + nLength - 2, "@@") || strpbrk(psz, "?$"))
+	{
+		sName = pszDecorated;
+
+		return true;
+	}
+
+	sName.clear();
+
+	for(const char *pszEnd = psz + nLength - 2; pszEnd > psz; )
+	{
+		const char *pszStart = pszEnd;
+
+		while(pszStart > psz && pszStart[-1] != '@')
+		{
+			pszStart--;
+		}
+
+		if(!sName.empty())
+		{
+			sName += "::";
+		}
+
+		sName.append(pszStart, pszEnd - pszStart);
+		pszEnd = pszStart > psz ? pszStart - 1 : pszStart;
+	}
+
+	return true;
+}
+
+static bool ReadPointer(const GameData::ModuleImage &aImage, uintptr_t nRVA, uint64_t &nValue)
+{
+	if(!aImage.ContainsRVA(nRVA, sizeof(nValue)))
+	{
+		return false;
+	}
+
+	memcpy(&nValue, aImage.GetPointer(nRVA), sizeof(nValue));
+
+	return true;
+}
+
+// A NUL-terminated string at nRVA, not running off its segment.
+static const char *GetString(const GameData::ModuleImage &aImage, uintptr_t nRVA)
+{
+	const auto *pSegment = aImage.FindSegment(nRVA);
+
+	if(!pSegment || !aImage.ContainsRVA(pSegment->m_nRVA, pSegment->m_nSize))
+	{
+		return nullptr;
+	}
+
+	const char *psz = aImage.GetPointer<char>(nRVA);
+
+	size_t nLimit = pSegment->m_nRVA + pSegment->m_nSize - nRVA;
+
+	return strnlen(psz, nLimit) < nLimit ? psz : nullptr;
+}
+
+GameData::VtableIndex::VtableIndex(const ModuleImage &aImage)
+{
+	if(aImage.GetSize() > UINT32_MAX)
+	{
+		return;
+	}
+
+	// Every aligned pointer into the module from its data, by target: RTTI is linked up by
+	// absolute pointers, which are relocated in every kind of image.
+	std::vector<Pointer_t> vecPointers;
+
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(it.IsCode() || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			continue;
+		}
+
+		uintptr_t nBegin = (it.m_nRVA + 7) & ~static_cast<uintptr_t>(7),
+		          nEnd = it.m_nRVA + it.m_nSize;
+
+		for(uintptr_t nRVA = nBegin; nRVA + sizeof(uint64_t) <= nEnd; nRVA += sizeof(uint64_t))
+		{
+			uint64_t nValue;
+
+			memcpy(&nValue, aImage.GetPointer(nRVA), sizeof(nValue));
+
+			if(aImage.Contains(static_cast<uintptr_t>(nValue)))
+			{
+				vecPointers.push_back({static_cast<uint32_t>(aImage.ToRVA(static_cast<uintptr_t>(nValue))), static_cast<uint32_t>(nRVA)});
+			}
+		}
+	}
+
+	std::sort(vecPointers.begin(), vecPointers.end());
+
+	if(aImage.GetFormat() == IMAGE_FORMAT_PE)
+	{
+		IndexMSVC(aImage, vecPointers);
+	}
+	else
+	{
+		IndexItanium(aImage, vecPointers);
+	}
+}
+
+size_t GameData::VtableIndex::GetCount() const
+{
+	return m_mapVtables.size();
+}
+
+bool GameData::VtableIndex::Find(const char *pszClassName, uintptr_t &nRVA) const
+{
+	auto itFound = m_mapVtables.find(pszClassName);
+
+	if(itFound == m_mapVtables.end())
+	{
+		return false;
+	}
+
+	nRVA = itFound->second;
+
+	return true;
+}
+
+void GameData::VtableIndex::IndexItanium(const ModuleImage &aImage, const std::vector<Pointer_t> &vecPointers)
+{
+	// typeinfo: { vptr, const char *name, ... }
+	// vtable:   { ptrdiff_t offset_to_top, const typeinfo *, <address point> virtual functions... }
+	for(const auto &it : vecPointers)
+	{
+		if(it.m_nSource < sizeof(uint64_t))
+		{
+			continue;
+		}
+
+		uint32_t nTypeInfo = it.m_nSource - sizeof(uint64_t);
+
+		const char *pszMangled = GetString(aImage, it.m_nTarget);
+
+		std::string sName;
+
+		if(!pszMangled || !DecodeItaniumName(pszMangled, sName))
+		{
+			continue;
+		}
+
+		auto itUser = std::lower_bound(vecPointers.begin(), vecPointers.end(), Pointer_t {nTypeInfo, 0});
+
+		std::vector<uint32_t> vecCandidates;
+
+		// Derived typeinfos point to it too, but only a vtable has a zero offset-to-top before.
+		for(; itUser != vecPointers.end() && itUser->m_nTarget == nTypeInfo; ++itUser)
+		{
+			uint64_t nOffsetToTop;
+
+			if(itUser->m_nSource < sizeof(uint64_t) || !ReadPointer(aImage, itUser->m_nSource - sizeof(uint64_t), nOffsetToTop) || nOffsetToTop)
+			{
+				continue;
+			}
+
+			uint32_t nAddressPoint = itUser->m_nSource + sizeof(uint64_t);
+
+			// Catch type tables hold typeinfo pointers with null entries between them; those
+			// go on with data, where a vtable goes on with code (or an imported function).
+			uint64_t nFunction;
+
+			if(!ReadPointer(aImage, nAddressPoint, nFunction))
+			{
+				continue;
+			}
+
+			if(nFunction && aImage.Contains(static_cast<uintptr_t>(nFunction)))
+			{
+				const auto *pSegment = aImage.FindSegment(aImage.ToRVA(static_cast<uintptr_t>(nFunction)));
+
+				if(!pSegment || !pSegment->IsCode())
+				{
+					continue;
+				}
+			}
+
+			vecCandidates.push_back(nAddressPoint);
+		}
+
+		if(vecCandidates.empty())
+		{
+			continue;
+		}
+
+		Add(std::move(sName), vecCandidates.size() == 1 ? vecCandidates[0] : SelectCompleteVtable(aImage, vecCandidates));
+	}
+}
+
+uint32_t GameData::VtableIndex::SelectCompleteVtable(const ModuleImage &aImage, const std::vector<uint32_t> &vecCandidates)
+{
+	// With virtual bases, a construction vtable of every derived class carries the typeinfo
+	// as well. Its virtual base offsets follow the layout of the derived class, which has the
+	// virtual bases further out than the complete object of the class itself does. Where it
+	// does not (a tie), the two are alike slot for slot.
+	uint32_t nResult = vecCandidates[0];
+
+	int64_t nResultOffset = INT64_MAX;
+
+	for(uint32_t nCandidate : vecCandidates)
+	{
+		uint64_t nOffset;
+
+		if(nCandidate >= 3 * sizeof(uint64_t) && ReadPointer(aImage, nCandidate - 3 * sizeof(uint64_t), nOffset) && static_cast<int64_t>(nOffset) < nResultOffset)
+		{
+			nResult = nCandidate;
+			nResultOffset = static_cast<int64_t>(nOffset);
+		}
+	}
+
+	return nResult;
+}
+
+void GameData::VtableIndex::IndexMSVC(const ModuleImage &aImage, const std::vector<Pointer_t> &vecPointers)
+{
+	// RTTICompleteObjectLocator: { signature = 1, offset, cdOffset, pTypeDescriptor, pClassDescriptor, pSelf },
+	// image-relative; vtable[-1] points to it. TypeDescriptor: { pVFTable, spare, char name[] }.
+	struct CompleteObjectLocator_t
+	{
+		uint32_t m_nSignature;
+		uint32_t m_nOffset;
+		uint32_t m_nConstructorOffset;
+		uint32_t m_nTypeDescriptor;
+		uint32_t m_nClassDescriptor;
+		uint32_t m_nSelf;
+	};
+
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(it.IsCode() || !it.IsReadOnly() || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			continue;
+		}
+
+		uintptr_t nBegin = (it.m_nRVA + 3) & ~static_cast<uintptr_t>(3),
+		          nEnd = it.m_nRVA + it.m_nSize;
+
+		for(uintptr_t nRVA = nBegin; nRVA + sizeof(CompleteObjectLocator_t) <= nEnd; nRVA += sizeof(uint32_t))
+		{
+			CompleteObjectLocator_t aLocator;
+
+			memcpy(&aLocator, aImage.GetPointer(nRVA), sizeof(aLocator));
+
+			// The self-reference makes a false match practically impossible. Sub-object
+			// locators (a non-zero offset) belong to secondary vtables.
+			if(aLocator.m_nSignature != 1 || aLocator.m_nSelf != nRVA || aLocator.m_nOffset)
+			{
+				continue;
+			}
+
+			const char *pszDecorated = GetString(aImage, aLocator.m_nTypeDescriptor + 2 * sizeof(uint64_t));
+
+			std::string sName;
+
+			if(!pszDecorated || !DecodeMSVCName(pszDecorated, sName))
+			{
+				continue;
+			}
+
+			auto itUser = std::lower_bound(vecPointers.begin(), vecPointers.end(), Pointer_t {static_cast<uint32_t>(nRVA), 0});
+
+			if(itUser != vecPointers.end() && itUser->m_nTarget == nRVA)
+			{
+				Add(std::move(sName), itUser->m_nSource + sizeof(uint64_t));
+			}
+		}
+	}
+}
+
+void GameData::VtableIndex::Add(std::string sName, uint32_t nRVA)
+{
+	// The first one found wins; a duplicate name is a local class of another translation unit.
+	m_mapVtables.emplace(std::move(sName), nRVA);
+}
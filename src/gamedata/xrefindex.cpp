@@ -0,0 +1,167 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gamedata/xrefindex.hpp>
+#include <gamedata/instruction.hpp>
+
+#include <algorithm>
+
+static bool CompareByTarget(const GameData::XrefIndex::Xref_t &aLeft, const GameData::XrefIndex::Xref_t &aRight)
+{
+	return aLeft.m_nTarget != aRight.m_nTarget ? aLeft.m_nTarget < aRight.m_nTarget : aLeft.m_nSource < aRight.m_nSource;
+}
+
+static bool CompareBySource(const GameData::XrefIndex::Xref_t &aLeft, const GameData::XrefIndex::Xref_t &aRight)
+{
+	return aLeft.m_nSource < aRight.m_nSource;
+}
+
+GameData::XrefIndex::XrefIndex(const ModuleImage &aImage)
+{
+	if(aImage.GetSize() > UINT32_MAX)
+	{
+		return;
+	}
+
+	for(const auto &it : aImage.GetSegments())
+	{
+		if(!it.IsCode() || !aImage.ContainsRVA(it.m_nRVA, it.m_nSize))
+		{
+			continue;
+		}
+
+		const uint8_t *pData = aImage.GetPointer(it.m_nRVA);
+
+		// Compiler output decodes linearly; a byte which does not decode (data, padding)
+		// is stepped over, and the sweep resynchronizes within a few instructions.
+		for(size_t n = 0; n < it.m_nSize; )
+		{
+			Instruction_t aInstruction;
+
+			if(!DecodeInstruction(pData + n, it.m_nSize - n, aInstruction))
+			{
+				n++;
+
+				continue;
+			}
+
+			uintptr_t nSource = it.m_nRVA + n,
+			          nTarget;
+
+			int nKind = XREF_NONE;
+
+			if(aInstruction.m_nFlags & INSTRUCTION_RIP_RELATIVE)
+			{
+				nKind = XREF_DATA;
+			}
+			else if((aInstruction.m_nFlags & INSTRUCTION_RELATIVE) && aInstruction.m_nImmediateSize == 4)
+			{
+				if(aInstruction.m_nFlags & INSTRUCTION_CALL)
+				{
+					nKind = XREF_CALL;
+				}
+				else if(!(aInstruction.m_nFlags & INSTRUCTION_CONDITIONAL))
+				{
+					nKind = XREF_JUMP;
+				}
+			}
+
+			if(nKind && aInstruction.GetTarget(nSource, nTarget) && nTarget < aImage.GetSize())
+			{
+				m_vecByTarget.push_back({static_cast<uint32_t>(nTarget), static_cast<uint32_t>(nSource), nKind});
+			}
+
+			n += aInstruction.m_nLength;
+		}
+	}
+
+	// The sweep runs in site order already.
+	for(const auto &it : m_vecByTarget)
+	{
+		if(it.m_nKind & XREF_BRANCH)
+		{
+			m_vecBranchesBySource.push_back(it);
+		}
+
+		if(it.m_nKind == XREF_CALL)
+		{
+			m_vecCallTargets.push_back(it.m_nTarget);
+		}
+	}
+
+	std::stable_sort(m_vecBranchesBySource.begin(), m_vecBranchesBySource.end(), CompareBySource);
+	std::sort(m_vecByTarget.begin(), m_vecByTarget.end(), CompareByTarget);
+	std::sort(m_vecCallTargets.begin(), m_vecCallTargets.end());
+
+	m_vecCallTargets.erase(std::unique(m_vecCallTargets.begin(), m_vecCallTargets.end()), m_vecCallTargets.end());
+}
+
+size_t GameData::XrefIndex::GetCount() const
+{
+	return m_vecByTarget.size();
+}
+
+void GameData::XrefIndex::FindReferences(uintptr_t nTarget, std::vector<uintptr_t> &vecSources, int nKinds) const
+{
+	vecSources.clear();
+
+	if(nTarget > UINT32_MAX)
+	{
+		return;
+	}
+
+	auto it = std::lower_bound(m_vecByTarget.begin(), m_vecByTarget.end(), Xref_t {static_cast<uint32_t>(nTarget), 0, XREF_NONE}, CompareByTarget);
+
+	for(; it != m_vecByTarget.end() && it->m_nTarget == nTarget; ++it)
+	{
+		if(it->m_nKind & nKinds)
+		{
+			vecSources.push_back(it->m_nSource);
+		}
+	}
+}
+
+void GameData::XrefIndex::FindCallsFrom(uintptr_t nRVA, std::vector<uintptr_t> &vecTargets, uintptr_t nEnd) const
+{
+	vecTargets.clear();
+
+	if(nRVA > UINT32_MAX)
+	{
+		return;
+	}
+
+	if(!nEnd)
+	{
+		auto itEnd = std::upper_bound(m_vecCallTargets.begin(), m_vecCallTargets.end(), static_cast<uint32_t>(nRVA));
+
+		nEnd = itEnd != m_vecCallTargets.end() ? *itEnd : UINT32_MAX;
+	}
+
+	auto it = std::lower_bound(m_vecBranchesBySource.begin(), m_vecBranchesBySource.end(), Xref_t {0, static_cast<uint32_t>(nRVA), XREF_NONE}, CompareBySource);
+
+	for(; it != m_vecBranchesBySource.end() && it->m_nSource < nEnd; ++it)
+	{
+		if(it->m_nKind == XREF_CALL)
+		{
+			vecTargets.push_back(it->m_nTarget);
+		}
+	}
+}
@@ -0,0 +1,144 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+// Generates the shortest signatures which match a module exactly once.
+//
+// gamedata-sigmaker [--max-length <bytes>] <module file> <rva>...
+//
+// RVAs are hexadecimal. The module is indexed once, then every RVA is a lookup.
+// Exits with 0 when every RVA got a signature, 1 otherwise, 2 on bad arguments.
+
+#include <gamedata/filegamedata.hpp>
+#include <gamedata/suffixindex.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+static void PrintUsage(const char *pszProgram)
+{
+	fprintf(stderr, "Usage: %s [--max-length <bytes>] <module file> <rva>...\n", pszProgram);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t nMaxLength = 128;
+
+	const char *pszModule = nullptr;
+
+	std::vector<uintptr_t> vecRVAs;
+
+	for(int i = 1; i < argc; i++)
+	{
+		const char *pszArg = argv[i];
+
+		if(!strcmp(pszArg, "--max-length") || !strcmp(pszArg, "-m"))
+		{
+			if(++i >= argc)
+			{
+				PrintUsage(argv[0]);
+
+				return 2;
+			}
+
+			nMaxLength = strtoul(argv[i], nullptr, 10);
+
+			continue;
+		}
+
+		if(!strcmp(pszArg, "--help") || !strcmp(pszArg, "-h"))
+		{
+			PrintUsage(argv[0]);
+
+			return 0;
+		}
+
+		if(!pszModule)
+		{
+			pszModule = pszArg;
+
+			continue;
+		}
+
+		char *pszEnd;
+
+		uintptr_t nRVA = strtoull(pszArg, &pszEnd, 16);
+
+		if(*pszEnd)
+		{
+			fprintf(stderr, "Bad RVA \"%s\"\n", pszArg);
+
+			return 2;
+		}
+
+		vecRVAs.push_back(nRVA);
+	}
+
+	if(!pszModule || vecRVAs.empty() || !nMaxLength)
+	{
+		PrintUsage(argv[0]);
+
+		return 2;
+	}
+
+	GameData::FileModuleImage aImage;
+
+	std::string sError;
+
+	if(!aImage.Load(pszModule, sError))
+	{
+		fprintf(stderr, "%s\n", sError.c_str());
+
+		return 1;
+	}
+
+	auto tStart = std::chrono::steady_clock::now();
+
+	const auto &aIndex = aImage.GetIndex<GameData::SuffixIndex>();
+
+	auto nElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tStart).count();
+
+	fprintf(stderr, "Indexed %zu bytes of code in %lld ms\n", aIndex.GetSize(), static_cast<long long>(nElapsed));
+
+	bool bFailed = false;
+
+	for(uintptr_t nRVA : vecRVAs)
+	{
+		GameData::Pattern aPattern;
+
+		if(!aIndex.Generate(nRVA, nMaxLength, aPattern))
+		{
+			printf("0x%llX: no unique signature within %zu bytes\n", static_cast<unsigned long long>(nRVA), nMaxLength);
+			bFailed = true;
+
+			continue;
+		}
+
+		printf("0x%llX: %s\n", static_cast<unsigned long long>(nRVA), aPattern.ToString().c_str());
+	}
+
+	return bFailed ? 1 : 0;
+}
@@ -0,0 +1,368 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Universal gamedata parser for Source2 games.
+ * Written by Wend4r (2024).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Resolves gamedata offline against the binaries of every platform at once.
+//
+// gamedata-validator --platform win64=<dir>[,<dir>...] --platform linuxsteamrt64=<dir> ... <gamedata.json>...
+//
+// With --recover <distance>, signatures which fail are also reported with their closest match
+// and a suggested replacement pattern. With --schema <file>, offsets of the "schema" form are
+// taken from that SchemaSystem dump.
+//
+// Exits with 0 when every entry resolved, 1 on problems, 2 on bad arguments.
+
+#include <gamedata.hpp>
+#include <gamedata/filegamedata.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tier1/keyvalues3.h>
+
+struct PlatformName_t
+{
+	const char *m_pszName;
+	GameData::Platform m_ePlatform;
+};
+
+static const PlatformName_t s_aPlatformNames[] =
+{
+	{"windows", GameData::PLAT_WINDOWS},
+	{"win64", GameData::PLAT_WINDOWS64},
+	{"linux", GameData::PLAT_LINUX},
+	{"linuxsteamrt64", GameData::PLAT_LINUX64},
+	{"mac", GameData::PLAT_MAC},
+	{"osx64", GameData::PLAT_MAC64},
+};
+
+struct GameDataFile_t
+{
+	std::string m_sPath;
+	std::string m_sText;
+};
+
+struct PlatformJob_t
+{
+	const PlatformName_t *m_pName;
+	std::vector<std::string> m_vecSearchPaths;
+
+	std::string m_sReport;
+	bool m_bFailed = false;
+};
+
+template<typename K, typename V>
+class CStorageCounter : public GameData::Config::Storage<K, V>::IListener
+{
+public:
+	void OnChanged(const K &aKey, const V &aValue) override
+	{
+		m_nCount++;
+	}
+
+	size_t m_nCount = 0;
+};
+
+static const PlatformName_t *FindPlatform(const char *pszName, size_t nLength)
+{
+	for(const auto &it : s_aPlatformNames)
+	{
+		if(strlen(it.m_pszName) == nLength && !strncmp(it.m_pszName, pszName, nLength))
+		{
+			return &it;
+		}
+	}
+
+	return nullptr;
+}
+
+static size_t GetMessageDepth(const char *pszMessage)
+{
+	return strspn(pszMessage, "\t");
+}
+
+// Config nests the messages of a section under an "In \"<section>\" section:" line; those headers are not problems.
+static size_t CountProblems(const GameData::CBufferStringVector &vecMessages)
+{
+	size_t nProblems = 0;
+
+	FOR_EACH_VEC(vecMessages, i)
+	{
+		bool bHeader = i + 1 < vecMessages.Count() && GetMessageDepth(vecMessages[i + 1].Get()) > GetMessageDepth(vecMessages[i].Get());
+
+		if(!bHeader)
+		{
+			nProblems++;
+		}
+	}
+
+	return nProblems;
+}
+
+static void ValidatePlatform(PlatformJob_t &aJob, const std::vector<GameDataFile_t> &vecFiles, size_t nRecoveryDistance, const std::string &sSchemaDump)
+{
+	auto tStart = std::chrono::steady_clock::now();
+
+	GameData::FileGameData aRoot;
+
+	for(const auto &sPath : aJob.m_vecSearchPaths)
+	{
+		aRoot.AddSearchPath(sPath.c_str());
+	}
+
+	std::ostringstream aDetails;
+
+	size_t nAddresses = 0,
+	       nKeys = 0,
+	       nOffsets = 0,
+	       nProblems = 0;
+
+	for(const auto &aFile : vecFiles)
+	{
+		// Loading consumes platform keys of the address actions, so every job parses its own copy.
+		KeyValues3 aGameConfig;
+
+		CUtlString sError;
+
+		if(!LoadKV3FromJSON(&aGameConfig, &sError, aFile.m_sText.c_str(), aFile.m_sPath.c_str()))
+		{
+			aDetails << "  " << aFile.m_sPath << ": Failed to parse: " << sError.Get() << '\n';
+			nProblems++;
+
+			continue;
+		}
+
+		GameData::Config aConfig;
+
+		CStorageCounter<CUtlSymbolLarge, DynLibUtils::CMemory> aAddressCounter;
+		CStorageCounter<CUtlSymbolLarge, CUtlString> aKeyCounter;
+		CStorageCounter<CUtlSymbolLarge, ptrdiff_t> aOffsetCounter;
+
+		aConfig.GetAddresses().AddListener(&aAddressCounter);
+		aConfig.GetKeys().AddListener(&aKeyCounter);
+		aConfig.GetOffsets().AddListener(&aOffsetCounter);
+		aConfig.SetPlatform(aJob.m_pName->m_ePlatform);
+		aConfig.SetSignatureRecovery(nRecoveryDistance);
+
+		if(!sSchemaDump.empty())
+		{
+			aConfig.SetSchemaDump(sSchemaDump.c_str());
+		}
+
+		GameData::CBufferStringVector vecMessages;
+
+		aConfig.Load(&aRoot, &aGameConfig, vecMessages);
+
+		FOR_EACH_VEC(vecMessages, i)
+		{
+			aDetails << "  " << aFile.m_sPath << ": " << vecMessages[i].Get() << '\n';
+		}
+
+		nAddresses += aAddressCounter.m_nCount;
+		nKeys += aKeyCounter.m_nCount;
+		nOffsets += aOffsetCounter.m_nCount;
+		nProblems += CountProblems(vecMessages);
+	}
+
+	std::string sLibraryError = aRoot.GetLastError();
+
+	if(!sLibraryError.empty())
+	{
+		aDetails << "  " << sLibraryError << '\n';
+	}
+
+	auto nElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tStart).count();
+
+	std::ostringstream aReport;
+
+	aReport << '[' << aJob.m_pName->m_pszName << "] " << nAddresses << " addresses, " << nKeys << " keys, " << nOffsets << " offsets, "
+	        << nProblems << " problem(s) in " << nElapsed << " ms\n" << aDetails.str();
+
+	aJob.m_sReport = aReport.str();
+	aJob.m_bFailed = nProblems != 0;
+}
+
+static void PrintUsage(const char *pszProgram)
+{
+	fprintf(stderr, "Usage: %s --platform <key>=<dir>[,<dir>...] [--platform ...] [--recover <distance>] [--schema <file>] <gamedata file>...\n", pszProgram);
+	fprintf(stderr, "Platform keys:");
+
+	for(const auto &it : s_aPlatformNames)
+	{
+		fprintf(stderr, " %s", it.m_pszName);
+	}
+
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	std::vector<PlatformJob_t> vecJobs;
+	std::vector<GameDataFile_t> vecFiles;
+
+	size_t nRecoveryDistance = 0;
+
+	std::string sSchemaDump;
+
+	for(int i = 1; i < argc; i++)
+	{
+		const char *pszArg = argv[i];
+
+		if(!strcmp(pszArg, "--platform") || !strcmp(pszArg, "-p"))
+		{
+			if(++i >= argc)
+			{
+				PrintUsage(argv[0]);
+
+				return 2;
+			}
+
+			const char *pszValue = argv[i],
+			           *pszEquals = strchr(pszValue, '=');
+
+			const PlatformName_t *pName = pszEquals ? FindPlatform(pszValue, pszEquals - pszValue) : nullptr;
+
+			if(!pName)
+			{
+				fprintf(stderr, "Unknown platform in \"%s\"\n", pszValue);
+				PrintUsage(argv[0]);
+
+				return 2;
+			}
+
+			PlatformJob_t *pJob = nullptr;
+
+			for(auto &it : vecJobs)
+			{
+				if(it.m_pName == pName)
+				{
+					pJob = &it;
+				}
+			}
+
+			if(!pJob)
+			{
+				vecJobs.emplace_back();
+
+				pJob = &vecJobs.back();
+				pJob->m_pName = pName;
+			}
+
+			std::istringstream aPaths(pszEquals + 1);
+
+			for(std::string sPath; std::getline(aPaths, sPath, ','); )
+			{
+				if(!sPath.empty())
+				{
+					pJob->m_vecSearchPaths.push_back(sPath);
+				}
+			}
+
+			continue;
+		}
+
+		if(!strcmp(pszArg, "--recover") || !strcmp(pszArg, "-r"))
+		{
+			if(++i >= argc)
+			{
+				PrintUsage(argv[0]);
+
+				return 2;
+			}
+
+			nRecoveryDistance = strtoul(argv[i], nullptr, 10);
+
+			continue;
+		}
+
+		if(!strcmp(pszArg, "--schema") || !strcmp(pszArg, "-s"))
+		{
+			if(++i >= argc)
+			{
+				PrintUsage(argv[0]);
+
+				return 2;
+			}
+
+			sSchemaDump = argv[i];
+
+			continue;
+		}
+
+		if(!strcmp(pszArg, "--help") || !strcmp(pszArg, "-h"))
+		{
+			PrintUsage(argv[0]);
+
+			return 0;
+		}
+
+		std::ifstream aStream(pszArg, std::ios::binary);
+
+		if(!aStream)
+		{
+			fprintf(stderr, "Failed to open \"%s\"\n", pszArg);
+
+			return 2;
+		}
+
+		std::ostringstream aText;
+
+		aText << aStream.rdbuf();
+		vecFiles.push_back({pszArg, aText.str()});
+	}
+
+	if(vecJobs.empty() || vecFiles.empty())
+	{
+		PrintUsage(argv[0]);
+
+		return 2;
+	}
+
+	std::vector<std::thread> vecThreads;
+
+	for(auto &aJob : vecJobs)
+	{
+		vecThreads.emplace_back(ValidatePlatform, std::ref(aJob), std::cref(vecFiles), nRecoveryDistance, std::cref(sSchemaDump));
+	}
+
+	for(auto &aThread : vecThreads)
+	{
+		aThread.join();
+	}
+
+	bool bFailed = false;
+
+	for(const auto &aJob : vecJobs)
+	{
+		fputs(aJob.m_sReport.c_str(), stdout);
+
+		bFailed |= aJob.m_bFailed;
+	}
+
+	return bFailed ? 1 : 0;
+}